@@ -143,6 +143,13 @@ static inline void cpu_wait_energy_save ()
     asm volatile( "wfi" ::);
 }
 
+static inline unsigned int cpu_clz (uint32_t val)
+{
+    unsigned int res;
+    asm ("clz %0, %1" : "=r"(res) : "r"(val));
+    return res;
+}
+
 static inline void *cpu_get_stack_pointer (void *stack, size_t stack_size)
 {
     return (stack + stack_size);
@@ -340,6 +347,19 @@ static inline void cpu_enable_smp ()
     asm volatile("mcr     p15, 0, %[tmp], c1, c0, 1" : : [tmp] "r" (tmp));
 }
 
+/* Запуск счетчика тактов PMU (PMCCNTR) и разрешение его чтения в режиме пользователя */
+static inline void cpu_pmu_user_enable ()
+{
+    uint32_t pmcr;
+    asm volatile("mrc p15, 0, %[pmcr], c9, c12, 0" : [pmcr] "=r" (pmcr));
+    pmcr |= 0x5;        // E - счетчики разрешены, C - сброс счетчика тактов
+    pmcr &= ~0x8;       // D - счет каждого такта без делителя 64
+    asm volatile("mcr p15, 0, %[pmcr], c9, c12, 0" : : [pmcr] "r" (pmcr));
+    asm volatile("mcr p15, 0, %[en], c9, c12, 1" : : [en] "r" (0x80000000));  // PMCNTENSET.C
+    asm volatile("mcr p15, 0, %[en], c9, c14, 0" : : [en] "r" (1));           // PMUSERENR.EN
+    isb();
+}
+
 static inline int cpu_enable_core (int core_id, void *entry) {
     return 0;
 }
@@ -59,17 +59,30 @@ int interrupt_get_max_prio() {
     return max_priority;
 }
 
+// Конвертация приоритета в шкале приоритетов ОС в приоритет контроллера прерываний,
+// выполняется через линейное отображение(преобразование) диапазонов
+static inline int prio_to_gic(int priority) {
+    return (priority * 4) & 0xff;
+}
+
 void interrupt_set_env_priority(int priority) {
-    env_priority = priority & 0xff;
+    if(priority >= PRIO_NUM) {
+        // поток простоя - разрешены все прерывания
+        env_priority = min_priority;
+    } else {
+        // прерывания с наивысшим приоритетом ядра (диспетчер, KPRIO_MAX = 0) не маскируются никогда
+        env_priority = prio_to_gic(priority);
+        if(env_priority <= GIC_PRIORITY_MAX) {
+            env_priority = prio_to_gic(1);
+        }
+    }
     GIC_ICC->ICCPMR = env_priority;
 }
 
 void interrupt_set_priority(int id, int priority) {
     if( (id < 0) || (id >= IRQ_NUM) ) return;
 
-    // здесь необходимо конвертировать приоритет в шкале приоритетов ОС в приоритет контроллера прерываний,
-    // это должно выполняться через линейное отображение(преобразование) диапазонов
-    priority = (priority * 4) & 0xff;
+    priority = prio_to_gic(priority);
     set_field_vuint32_t(&GIC_ICD->ICDIPR[id >> 2], (id & 3) << 3, 0xff, priority & 0xff);
 }
 
@@ -31,6 +31,13 @@ static inline void write_ttbr0 (uint32_t bar)
     flush_tlb();
 }
 
+/* Write Context ID Register */
+static inline void write_contextidr (uint32_t asid)
+{
+    asm volatile("mcr p15, 0, %[asid], c13, c0, 1" : : [asid] "r" (asid));
+    isb();
+}
+
 /* Reload Translation Table Base Register 0 */
 //static inline void reload_ttbr0 ()
 //{
@@ -100,6 +107,7 @@ static const size_t l1_pagetable_size = 0x00004000;
 static const size_t l2_pagetable_size = 0x00000400;
 
 static const size_t page_size = 0x1000; // 4 Kb
+static const size_t lpage_size = 0x10000; // 64 Kb
 static const size_t dir_size = 0x100000; // 1 Mb
 
 //! @brief Memory region attributes.
@@ -279,6 +287,20 @@ void mmu_switch (uint32_t *tbl)
     write_ttbr0((uint32_t)tbl);
 }
 
+/* Switch TTBR0 without TLB invalidation. TTBR0 and ASID can not be changed
+   atomically, so the reserved ASID 0 (never assigned to a map) is current
+   while the table is changed and no walk can tag entries with the new ASID
+   from the previous table */
+void mmu_switch_asid (uint32_t *tbl, uint32_t asid)
+{
+    write_contextidr(0);
+    barrier();
+    uint32_t bar = ((uint32_t)tbl & ARM_TTBR_ADDR_MASK) | ARM_TTBR_FLAGS_CACHED;
+    asm volatile("mcr p15, 0, %[bar], c2, c0, 0" : : [bar] "r" (bar));
+    isb();
+    write_contextidr(asid & ASID_MASK);
+}
+
 uint32_t* mmu_get_tbl ()
 {
     return (uint32_t*)read_ttbr0();
@@ -308,7 +330,15 @@ void mmu_set_fault (uint32_t *entry)
     dcache_flush_line(entry);
 }
 
-void mmu_set_dir (uint32_t *entry, uint32_t va, mem_attributes_t attr)
+/* Clear n consecutive entries, cleaning them to memory with one range operation */
+void mmu_set_faults (uint32_t *entry, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        entry[i] = 0;
+    dcache_flush_seg(entry, n * sizeof(*entry));
+}
+
+void mmu_set_dir (uint32_t *entry, uint32_t va, mem_attributes_t attr, bool ng)
 {
     union l1_pte *p = (union l1_pte*)entry;
     p->section.is_section = 1;
@@ -321,6 +351,7 @@ void mmu_set_dir (uint32_t *entry, uint32_t va, mem_attributes_t attr)
     p->section.access_permission_x = ap.apx;
 
     p->section.shareable = attr.shared;
+    p->section.non_global = ng;
 
     struct memory_type m = get_mem_type(attr);
     p->section.bufferable = m.b;
@@ -343,13 +374,15 @@ void mmu_set_pgt (uint32_t *entry, uint32_t *pgt)
     dcache_flush_line(entry);
 }
 
-void mmu_set_pgte (uint32_t *entry, uint32_t va, mem_attributes_t attr)
+static void set_pgte (uint32_t *entry, uint32_t va, mem_attributes_t attr, bool ng)
 {
     union l2_pte *p = (union l2_pte*)entry;
+    *entry = 0; // entry could hold a large page descriptor with other bit layout
     p->small_page.small = 1;
 
     p->small_page.execute_never = attr.exec;
     p->small_page.shareable = attr.shared;
+    p->small_page.non_global = ng;
 
     union ap_bits ap;
     ap.access = get_access(attr);
@@ -362,10 +395,86 @@ void mmu_set_pgte (uint32_t *entry, uint32_t va, mem_attributes_t attr)
     p->small_page.tex = m.tex;
 
     p->small_page.base_address = va >> 12;
+}
 
+void mmu_set_pgte (uint32_t *entry, uint32_t va, mem_attributes_t attr, bool ng)
+{
+    set_pgte(entry, va, attr, ng);
     dcache_flush_line(entry);
 }
 
+static void set_lpgte (uint32_t *entry, uint32_t va, mem_attributes_t attr, bool ng)
+{
+    union l2_pte *p = (union l2_pte*)entry;
+    *entry = 0;
+    p->large_page._1 = 1;
+
+    p->large_page.execute_never = attr.exec;
+    p->large_page.shareable = attr.shared;
+    p->large_page.non_global = ng;
+
+    union ap_bits ap;
+    ap.access = get_access(attr);
+    p->large_page.access_permission = ap.ap;
+    p->large_page.access_permission_x = ap.apx;
+
+    struct memory_type m = get_mem_type(attr);
+    p->large_page.bufferable = m.b;
+    p->large_page.cacheable = m.c;
+    p->large_page.tex = m.tex;
+
+    p->large_page.base_address = va >> 16;
+}
+
+static void set_pgtes (uint32_t *entry, uint32_t va, size_t n, mem_attributes_t attr, bool ng, bool large)
+{
+    const size_t lpage_entries = lpage_size / page_size;
+    uint32_t *start = entry;
+
+    while (n) {
+        if (large && !(va % lpage_size) && n >= lpage_entries) {
+            /* Large page descriptor is repeated in 16 consecutive entries */
+            for (size_t i = 0; i < lpage_entries; i++)
+                set_lpgte(entry++, va, attr, ng);
+            va += lpage_size;
+            n -= lpage_entries;
+        } else {
+            set_pgte(entry++, va, attr, ng);
+            va += page_size;
+            n--;
+        }
+    }
+    dcache_flush_seg(start, (entry - start) * sizeof(*entry));
+}
+
+/* Fill n consecutive small page entries of one L2 table for pages starting at va,
+   cleaning them to memory with one range operation. TLB is not invalidated. */
+void mmu_set_pgtes (uint32_t *entry, uint32_t va, size_t n, mem_attributes_t attr, bool ng)
+{
+    set_pgtes(entry, va, n, attr, ng, false);
+}
+
+/* Same as mmu_set_pgtes, but every 64Kb aligned run of 16 pages is mapped
+   by a large page (one TLB entry instead of 16) */
+void mmu_set_lpgtes (uint32_t *entry, uint32_t va, size_t n, mem_attributes_t attr, bool ng)
+{
+    set_pgtes(entry, va, n, attr, ng, true);
+}
+
+/* Mark n consecutive valid L2 entries non-global (nG is bit 11 of both small and
+   large page descriptors), for kernel entries copied into process tables */
+void mmu_set_pgtes_ng (uint32_t *entry, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        union l2_pte *p = (union l2_pte*)&entry[i];
+        if (p->small_page.small)
+            p->small_page.non_global = 1;
+        else if (p->large_page._1)
+            p->large_page.non_global = 1;
+    }
+    dcache_flush_seg(entry, n * sizeof(*entry));
+}
+
 const size_t mmu_page_size ()
 {
     return page_size;
@@ -376,6 +485,16 @@ const size_t mmu_dir_size ()
     return dir_size;
 }
 
+const size_t mmu_lpage_size ()
+{
+    return lpage_size;
+}
+
+const size_t mmu_page_in_lpage ()
+{
+    return lpage_size / page_size;
+}
+
 const size_t mmu_page_in_dir ()
 {
     return dir_size / page_size;
@@ -24,6 +24,9 @@
 #define ARM_TTBR_ADDR_MASK    (0xffffc000) /* only the 18 upper bits are to be used as address */
 #define ARM_TTBR_FLAGS_CACHED ARM_TTBR_FLAGS_OUTER_CACHED | ARM_TTBR_FLAGS_INNER_CACHED
 
+#define ASID_BITS             (8)
+#define ASID_MASK             ((1 << ASID_BITS) - 1)
+
 
 /* Invalidate entire unified TLB */
 static inline void flush_tlb ()
@@ -44,4 +47,67 @@ static inline void flush_tlb ()
     isb();
 }
 
+/* Invalidate unified TLB entries tagged with ASID. With BUILD_SMP the Inner Shareable
+   form (TLBIASIDIS) is used: the map may have been active on other cores, whose TLBs
+   keep its entries since switching does not flush */
+static inline void flush_tlb_asid (uint32_t asid)
+{
+    dsb();
+#if defined(BUILD_SMP)
+    asm volatile("mcr p15, 0, %[asid], c8, c3, 2" : : [asid] "r" (asid & ASID_MASK));
+#else
+    asm volatile("mcr p15, 0, %[asid], c8, c7, 2" : : [asid] "r" (asid & ASID_MASK));
+#endif
+    dsb();
+    isb();
+}
+
+/* Invalidate all instruction caches to PoU and branch predictor, as flush_tlb does,
+   for code mapped at reused addresses (Inner Shareable forms with BUILD_SMP) */
+static inline void flush_icache ()
+{
+#if defined(BUILD_SMP)
+    asm volatile("mcr p15, 0, %[zero], c7, c1, 0" : : [zero] "r" (0));
+    asm volatile("mcr p15, 0, %[zero], c7, c1, 6" : : [zero] "r" (0)); /* flush BTB */
+#else
+    asm volatile("mcr p15, 0, %[zero], c7, c5, 0" : : [zero] "r" (0));
+    asm volatile("mcr p15, 0, %[zero], c7, c5, 6" : : [zero] "r" (0)); /* flush BTB */
+#endif
+
+    dsb();
+    isb();
+}
+
+/* Invalidate unified TLB entries of pages [va, va + pages * PAGE_SIZE) for all ASIDs
+   (TLBIMVAA, Multiprocessing Extensions, TLBIMVAAIS on all cores with BUILD_SMP),
+   then instruction caches */
+static inline void flush_tlb_range (uint32_t va, size_t pages)
+{
+    dsb();
+
+    va &= ~(PAGE_SIZE - 1);
+    for (; pages; pages--, va += PAGE_SIZE) {
+#if defined(BUILD_SMP)
+        asm volatile("mcr p15, 0, %[va], c8, c3, 3" : : [va] "r" (va));
+#else
+        asm volatile("mcr p15, 0, %[va], c8, c7, 3" : : [va] "r" (va));
+#endif
+    }
+
+    flush_icache();
+}
+
+/* Invalidate entire unified TLB on all cores (TLBIALLIS with BUILD_SMP),
+   for kernel map changes */
+static inline void flush_tlb_all ()
+{
+#if defined(BUILD_SMP)
+    dsb();
+    asm volatile("mcr p15, 0, %[zero], c8, c3, 0" : : [zero] "r" (0));
+    flush_icache();
+#else
+    flush_tlb();
+#endif
+}
+
 #endif
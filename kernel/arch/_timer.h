@@ -3,7 +3,11 @@
 
 enum timer_irq {
     SCHEDULER_IRQ_SECONDARY_BASE = SW_INTERRUPT_1,
+#ifdef BUILD_TIMER_A9
+    SCHEDULER_IRQ_ID = 29           // приватный таймер ядра (PPI, у каждого ядра свой), см. a9timer.h
+#else
     SCHEDULER_IRQ_ID = IMX_INT_EPIT1
+#endif
 };
 
 #endif /* TIMER_H_ */
@@ -0,0 +1,39 @@
+#ifndef A9TIMER_H_
+#define A9TIMER_H_
+
+#include "soc_memory_map.h"
+
+// Глобальный таймер Cortex-A9 MPCore: 64-х разрядный счетчик прямого счета,
+// общий для всех ядер, тактируется PERIPHCLK
+typedef struct {
+    vuint32_t CNTL;     // Counter Register [31:0]
+    vuint32_t CNTH;     // Counter Register [63:32]
+    vuint32_t CTRL;     // Control Register
+    vuint32_t ISR;      // Interrupt Status Register
+    vuint32_t CMPL;     // Comparator Value Register [31:0] (banked)
+    vuint32_t CMPH;     // Comparator Value Register [63:32] (banked)
+    vuint32_t AUTOINC;  // Auto-increment Register (banked)
+} A9_GTIMER_t;
+
+// Приватный таймер ядра Cortex-A9 MPCore: 32-х разрядный счетчик обратного счета,
+// у каждого ядра свой (banked), тактируется PERIPHCLK
+typedef struct {
+    vuint32_t LOAD;     // Load Register
+    vuint32_t COUNTER;  // Counter Register
+    vuint32_t CTRL;     // Control Register
+    vuint32_t ISR;      // Interrupt Status Register
+} A9_PTIMER_t;
+
+#define A9_GTIMER       ((A9_GTIMER_t *)GLOBAL_TIMER_BASE_ADDR)
+#define A9_PTIMER       ((A9_PTIMER_t *)PRIVATE_TIMERS_WD_BASE_ADDR)
+
+#define A9_TIMER_CTRL_ENABLE        0x1
+#define A9_TIMER_CTRL_COMP_ENABLE   0x2     // только глобальный таймер
+#define A9_PTIMER_CTRL_AUTO_RELOAD  0x2     // только приватный таймер
+#define A9_TIMER_CTRL_IRQ_ENABLE    0x4
+#define A9_TIMER_ISR_EVENT          0x1
+
+#define A9_GTIMER_IRQ   27      // PPI
+#define A9_PTIMER_IRQ   29      // PPI
+
+#endif /* A9TIMER_H_ */
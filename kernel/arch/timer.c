@@ -2,6 +2,8 @@
 #include "epit.h"
 #include <mem\vm.h>
 
+#ifndef BUILD_TIMER_A9
+
 // Для iMX6Q используем таймер EPIT1 в качестве таймера ядра:
 // плюсы: работает в режиме низкого потребления
 // Для диспетчера задач и подсчета времени подходит только режим его тактирования
@@ -33,6 +35,8 @@ static uint64_t time_ns;
 static uint64_t event_planned_ns;
 static uint64_t event_period_ns = 0;
 
+static struct os_time_page *time_page;
+
 static uint32_t last_counter;
 static uint32_t last_remainder; // Остаток в тиках N = 0-63 тика с периодом 1/32768 = N*0,001953125 с
 static uint32_t compare;
@@ -43,19 +47,10 @@ static const uint32_t time_ns_64 = 1953125;
 //static const uint32_t period_ns_remainder = 578125; // 1/32768 = 0,000030517578125
 static const uint32_t small_lyambda_ticks = 2;
 
-
-int timer_init(uint64_t period_ns) {
-    uint64_t tmp = period_ns, i = 0, j;
-    EPIT1->CR = 0; // disable
-    EPIT1->CR = 0x10000; // soft reset
-    while(EPIT1->CR & 0x10000);
-
-    EPIT1->CR = 0x3280002;
-    EPIT1->SR = 1;
-
-    // выполняем быстрое деление на период ns_per_tick для вычисления числа тиков таймера
-    // в два сдвига с умножениеми и добавкой до минимум ns (чуть больше можно)
-    tmp += 32768;
+// Выполняем быстрое деление на период ns_per_tick для вычисления числа тиков таймера
+// в два сдвига с умножениями, результат округляется вверх (чуть больше можно)
+static uint32_t ns_to_ticks(uint64_t ns) {
+    uint64_t i = 0, j, tmp = ns;
     while(1) {
         j = tmp >> 15;
         if(j == 0) break;
@@ -63,10 +58,37 @@ int timer_init(uint64_t period_ns) {
         i += j;
     }
     tmp = i * ns_per_tick;
-    while(tmp < period_ns) {
+    while(tmp < ns) {
         tmp += ns_per_tick;
         i++;
     }
+    return i;
+}
+
+
+// Публикация значений времени для процессов, выполняется писателем time_update
+static void time_page_update() {
+    if(time_page == NULL) {
+        return;
+    }
+    writer_begin((atomic_state_t *)&time_page->seq);
+    time_page->counter_base = last_counter + last_remainder;
+    time_page->time_ns = time_ns;
+    time_page->rtime = rtime[rtime_id];
+    writer_commit((atomic_state_t *)&time_page->seq);
+}
+
+int timer_init(uint64_t period_ns) {
+    uint64_t tmp, i;
+    EPIT1->CR = 0; // disable
+    EPIT1->CR = 0x10000; // soft reset
+    while(EPIT1->CR & 0x10000);
+
+    EPIT1->CR = 0x3280002;
+    EPIT1->SR = 1;
+
+    i = ns_to_ticks(period_ns);
+    tmp = i * ns_per_tick;
 
     event_period_ticks = i;
     time_ns = 0;
@@ -82,6 +104,7 @@ int timer_init(uint64_t period_ns) {
     compare = last_counter - event_period_ticks;
     last_remainder = 0;
     EPIT1->CMPR = compare;
+    time_page_update();
     return OK;
 }
 
@@ -111,21 +134,7 @@ int timer_set_event(uint64_t event_time_ns) {
         return ERR;
     }
     tns = tns - event_time_ns; // корректировка по времени на уменьшение
-    uint64_t i = 0, j, tmp = tns;
-    // аналогично инициализации - "быстрая" оценка
-    // выполняем быстрое деление на период ns_per_tick для вычисления числа тиков таймера
-    // (чуть больше можно)
-    while(1) {
-        j = tmp >> 15;
-        if(j == 0) break;
-        tmp = tmp - j * ns_per_tick;
-        i += j;
-    }
-    tmp = i * ns_per_tick;
-    while(tmp < tns) {
-        tmp += ns_per_tick;
-        i++;
-    }
+    uint32_t i = ns_to_ticks(tns);
     uint32_t cnt = EPIT1->CNR;
     cnt = cnt - EPIT1->CMPR; // текущее число тиков до прерывания
     if(i >= cnt - small_lyambda_ticks) {
@@ -137,6 +146,36 @@ int timer_set_event(uint64_t event_time_ns) {
     return OK;
 }
 
+int timer_set_next_event(uint64_t event_time_ns, uint64_t max_ns) {
+    uint64_t now = systime(), tns;
+    if(event_time_ns > now + max_ns) {
+        event_time_ns = now + max_ns;
+    }
+    tns = (event_time_ns > now) ? event_time_ns - now : 0;
+    uint32_t i = ns_to_ticks(tns);
+    if(i < small_lyambda_ticks) {
+        // слишком близкое событие, иначе можем пропустить момент сравнения
+        i = small_lyambda_ticks;
+    }
+    EPIT1->CMPR = EPIT1->CNR - i;
+    event_planned_ns = now + i * ns_per_tick;
+    return OK;
+}
+
+uint64_t timer_get_event() {
+    return event_planned_ns;
+}
+
+void timer_set_time_page(struct os_time_page *page) {
+    atomic_state_init((atomic_state_t *)&page->seq);
+    page->flags = 0;                // EPIT - счетчик обратного счета
+    page->counter = &EPIT1->CNR;
+    page->mult = ns_per_tick;
+    page->shift = 0;
+    time_page = page;
+    time_page_update();
+}
+
 void timer_event() {
     time_update();
     // события отвязаны от подсчета времени, подсчет времени всегда точный,
@@ -149,6 +188,18 @@ void timer_event() {
     // timer_set_event(time_ns + (ns_per_tick << 3)); // TODO uncomment to test
 }
 
+int timer_core_init() {
+    // EPIT1 один на систему, вторичные ядра получают тик от CPU_0
+    return ERR;
+}
+
+int timer_core_set_next_event(uint64_t event_time_ns, uint64_t max_ns) {
+    return ERR;
+}
+
+void timer_core_event() {
+}
+
 void time_update() {
     writer_begin(&syn);
     uint64_t t = time_ns;
@@ -172,6 +223,7 @@ void time_update() {
     }
     rtime_time_ns = time_ns;
     writer_commit(&syn);
+    time_page_update();
 }
 
 uint64_t systime() {
@@ -231,3 +283,4 @@ int time_set(int clock_id, kernel_time_t *tv) {
     return OK;
 }
 
+#endif // BUILD_TIMER_A9
@@ -0,0 +1,323 @@
+#include <arch.h>
+#include "a9timer.h"
+#include "ccm_pll.h"
+#include <mem\vm.h>
+
+#ifdef BUILD_TIMER_A9
+
+// Таймер ядра на таймерах Cortex-A9 MPCore (выбирается при сборке вместо EPIT1):
+// - источник времени - глобальный таймер, 64-х разрядный счетчик прямого счета
+//   с частотой PERIPHCLK (половина частоты ядра), общий для всех ядер,
+//   поэтому вторичные ядра читают время без обращения к CPU_0
+// - события - приватный таймер CPU_0 в однократном режиме, значение загрузки
+//   задается на каждом прерывании (timer_event) или при переносе события;
+//   приватные таймеры вторичных ядер так же дают им собственные прерывания
+//   диспетчеризации (timer_core_*), время подсчитывает только CPU_0
+// - разрешение времени и событий - единицы нс против 30,5 мкс у EPIT1
+// - подсчет времени в time_update точный: тики переводятся в нс делением
+//   с переносом остатка, без набегания ошибки; между обновлениями systime
+//   дополняет время по множителю со сдвигом, значение множителя округлено вниз,
+//   поэтому время после обновления не может уменьшиться
+//
+//  ВНИМАНИЕ! Регистры таймеров расположены на одной странице с интерфейсом
+//  процессора GIC, чтение регистров которого имеет побочные эффекты,
+//  поэтому счетчик не отображается в процессы и страница времени публикуется
+//  без счетчика (процессы получают время системным вызовом)
+
+#ifndef A9_TIMER_CLK_HZ
+#define A9_TIMER_CLK_HZ     (get_main_clock(CPU_CLK) >> 1)  // PERIPHCLK
+#endif
+
+#define NSEC_PER_SEC        1000000000u
+
+static atomic_state_t syn;
+
+static kernel_time_t rtime[2];
+static int rtime_id;
+static uint64_t rtime_time_ns;
+
+static kernel_time_t rtime_to_set;
+static int rtime_flip_id;
+
+
+static uint64_t time_ns;
+static uint64_t event_planned_ns;
+static uint64_t event_period_ns = 0;
+
+static struct os_time_page *time_page;
+
+static uint32_t clk_hz;
+static uint32_t last_counter;
+static uint32_t last_remainder;     // остаток от перевода тиков в нс, в единицах нс * clk_hz
+static uint32_t ns_mult;            // нс = (тики * ns_mult) >> ns_shift
+static uint32_t ns_shift;
+static uint32_t ticks_mult;         // тики = (нс * ticks_mult) >> 32
+static uint32_t event_period_ticks;
+
+static const uint32_t small_lyambda_ticks = 64;
+
+// Деление 64/32 сдвигом с вычитанием, без обращения к библиотеке компилятора,
+// используется при инициализации и в time_update
+static uint64_t div_u64_rem(uint64_t n, uint32_t d, uint32_t *rem) {
+    uint64_t q = 0, r = 0;
+    int i;
+    for(i = 63; i >= 0; i--) {
+        r = (r << 1) | ((n >> i) & 1);
+        if(r >= d) {
+            r -= d;
+            q |= 1ull << i;
+        }
+    }
+    if(rem != NULL) {
+        *rem = (uint32_t)r;
+    }
+    return q;
+}
+
+// Перевод нс в тики с округлением вверх, интервал ограничен разрядностью
+// приватного таймера
+static uint32_t ns_to_ticks(uint64_t ns) {
+    if(ns > 0xffffffffull) {
+        ns = 0xffffffffull;
+    }
+    return (uint32_t)((ns * ticks_mult) >> 32) + 1;
+}
+
+static uint64_t ticks_to_ns(uint32_t ticks) {
+    return ((uint64_t)ticks * ns_mult) >> ns_shift;
+}
+
+// Публикация значений времени для процессов, выполняется писателем time_update
+static void time_page_update() {
+    if(time_page == NULL) {
+        return;
+    }
+    writer_begin((atomic_state_t *)&time_page->seq);
+    time_page->counter_base = last_counter;
+    time_page->time_ns = time_ns;
+    time_page->rtime = rtime[rtime_id];
+    writer_commit((atomic_state_t *)&time_page->seq);
+}
+
+static void ptimer_load(uint32_t ticks) {
+    A9_PTIMER->LOAD = ticks; // запись загрузки перезапускает счет
+}
+
+int timer_init(uint64_t period_ns) {
+    A9_PTIMER->CTRL = 0;
+    A9_PTIMER->ISR = A9_TIMER_ISR_EVENT;
+    A9_GTIMER->CTRL = 0;
+    A9_GTIMER->ISR = A9_TIMER_ISR_EVENT;
+    A9_GTIMER->CNTL = 0; // счетчик доступен на запись только при выключенном таймере
+    A9_GTIMER->CNTH = 0;
+
+    clk_hz = A9_TIMER_CLK_HZ;
+    // наибольший сдвиг, при котором множитель помещается в 32 разряда
+    ns_shift = 32;
+    while(div_u64_rem((uint64_t)NSEC_PER_SEC << ns_shift, clk_hz, NULL) > 0xffffffffull) {
+        ns_shift--;
+    }
+    ns_mult = div_u64_rem((uint64_t)NSEC_PER_SEC << ns_shift, clk_hz, NULL);
+    ticks_mult = div_u64_rem((uint64_t)clk_hz << 32, NSEC_PER_SEC, NULL);
+
+    event_period_ticks = ns_to_ticks(period_ns);
+    time_ns = 0;
+    rtime_time_ns = 0;
+    rtime_id = 0;
+    rtime_flip_id = 0;
+    rtime[rtime_id].tv_sec = 0;
+    rtime[rtime_id].tv_nsec = 0;
+    event_period_ns = period_ns;
+    event_planned_ns = period_ns;
+    atomic_state_init(&syn);
+    last_counter = 0;
+    last_remainder = 0;
+    ptimer_load(event_period_ticks);
+    // источник времени работает всегда, независимо от timer_enable/timer_disable
+    A9_GTIMER->CTRL = A9_TIMER_CTRL_ENABLE;
+    time_page_update();
+    return OK;
+}
+
+uint64_t timer_get_period() {
+    return event_period_ns;
+}
+
+int timer_enable() {
+    if(event_period_ns == 0) {
+        return ERR;
+    }
+    A9_PTIMER->CTRL = A9_TIMER_CTRL_IRQ_ENABLE | A9_TIMER_CTRL_ENABLE;
+    return OK;
+}
+
+int timer_disable() {
+    A9_PTIMER->CTRL = 0;
+    return OK;
+}
+
+int timer_set_event(uint64_t event_time_ns) {
+    uint64_t now;
+    uint32_t i;
+    if(event_time_ns >= event_planned_ns) {
+        // текущее событие будет раньше
+        return ERR;
+    }
+    now = systime();
+    i = (event_time_ns > now) ? ns_to_ticks(event_time_ns - now) : small_lyambda_ticks;
+    if(i < small_lyambda_ticks) {
+        i = small_lyambda_ticks;
+    }
+    if(i >= A9_PTIMER->COUNTER) {
+        // текущее событие будет раньше
+        return ERR;
+    }
+    event_planned_ns = event_time_ns;
+    ptimer_load(i); // устанавливаем на более раннее срабатывание
+    return OK;
+}
+
+int timer_set_next_event(uint64_t event_time_ns, uint64_t max_ns) {
+    uint64_t now = systime(), tns;
+    if(event_time_ns > now + max_ns) {
+        event_time_ns = now + max_ns;
+    }
+    tns = (event_time_ns > now) ? event_time_ns - now : 0;
+    uint32_t i = ns_to_ticks(tns);
+    if(i < small_lyambda_ticks) {
+        // слишком близкое событие, прерывание придет сразу после выхода из обработчика
+        i = small_lyambda_ticks;
+    }
+    ptimer_load(i);
+    event_planned_ns = now + ticks_to_ns(i);
+    return OK;
+}
+
+uint64_t timer_get_event() {
+    return event_planned_ns;
+}
+
+void timer_set_time_page(struct os_time_page *page) {
+    atomic_state_init((atomic_state_t *)&page->seq);
+    page->flags = OS_TIME_PAGE_COUNTER_UP;
+    page->counter = NULL;           // см. примечание в начале модуля
+    page->mult = ns_mult;
+    page->shift = ns_shift;
+    time_page = page;
+    time_page_update();
+}
+
+void timer_event() {
+    A9_PTIMER->ISR = A9_TIMER_ISR_EVENT; // clear event
+    time_update();
+    event_planned_ns = time_ns + event_period_ns;
+    ptimer_load(event_period_ticks);
+}
+
+int timer_core_init() {
+    A9_PTIMER->CTRL = 0;
+    A9_PTIMER->ISR = A9_TIMER_ISR_EVENT;
+    ptimer_load(event_period_ticks);
+    A9_PTIMER->CTRL = A9_TIMER_CTRL_IRQ_ENABLE | A9_TIMER_CTRL_ENABLE;
+    return OK;
+}
+
+int timer_core_set_next_event(uint64_t event_time_ns, uint64_t max_ns) {
+    uint64_t now = systime(), tns;
+    if(event_time_ns > now + max_ns) {
+        event_time_ns = now + max_ns;
+    }
+    tns = (event_time_ns > now) ? event_time_ns - now : 0;
+    uint32_t i = ns_to_ticks(tns);
+    if(i < small_lyambda_ticks) {
+        i = small_lyambda_ticks;
+    }
+    ptimer_load(i);
+    return OK;
+}
+
+void timer_core_event() {
+    A9_PTIMER->ISR = A9_TIMER_ISR_EVENT; // clear event
+    ptimer_load(event_period_ticks);
+}
+
+void time_update() {
+    writer_begin(&syn);
+    uint64_t t = time_ns;
+    uint32_t cnt = A9_GTIMER->CNTL;
+    // интервал между обновлениями много меньше периода переполнения 32 разрядов счетчика
+    uint64_t tmp = (uint64_t)(cnt - last_counter) * NSEC_PER_SEC + last_remainder;
+    last_counter = cnt;
+    t += div_u64_rem(tmp, clk_hz, &last_remainder);
+    time_ns = t;
+
+    if(rtime_id != rtime_flip_id) {
+        rtime_id = rtime_flip_id;
+        rtime[rtime_id].tv_nsec = rtime_to_set.tv_nsec;
+        rtime[rtime_id].tv_sec = rtime_to_set.tv_sec;
+    }
+    rtime[rtime_id].tv_nsec += time_ns - rtime_time_ns;
+    while(rtime[rtime_id].tv_nsec >= 1000000000) {
+        rtime[rtime_id].tv_nsec -= 1000000000;
+        rtime[rtime_id].tv_sec++;
+    }
+    rtime_time_ns = time_ns;
+    writer_commit(&syn);
+    time_page_update();
+}
+
+uint64_t systime() {
+    uint64_t t = 0;
+    atomic_state_t temp;
+    do {
+        if(reader_begin(&syn, &temp) == ERR) continue;
+        t = time_ns + ticks_to_ns(A9_GTIMER->CNTL - last_counter);
+    } while (reader_commit(&syn, &temp) == ERR);
+    return t;
+}
+
+int time_get(int clock_id, kernel_time_t *tv) {
+    if(clock_id == OS_CLOCK_MONOTONIC) {
+        tv->tv_sec = 0;
+        tv->tv_nsec = systime();
+        return OK;
+    }
+    if(clock_id != OS_CLOCK_REALTIME) {
+        return ERR;
+    }
+    kernel_time_t t = {0,0};
+    atomic_state_t temp;
+    do {
+        if(reader_begin(&syn, &temp) == ERR) continue;
+        t.tv_sec = rtime[rtime_id].tv_sec;
+        t.tv_nsec = rtime[rtime_id].tv_nsec;
+        t.tv_nsec += ticks_to_ns(A9_GTIMER->CNTL - last_counter);
+        while(t.tv_nsec >= 1000000000) {
+            t.tv_nsec -= 1000000000;
+            t.tv_sec++;
+        }
+    } while (reader_commit(&syn, &temp) == ERR);
+    tv->tv_nsec = t.tv_nsec;
+    tv->tv_sec = t.tv_sec;
+    return OK;
+}
+
+int time_set(int clock_id, kernel_time_t *tv) {
+    if(clock_id != OS_CLOCK_REALTIME) {
+        return ERR;
+    }
+    if(rtime_flip_id != rtime_id) {
+        // предыдущий вызов time_set еще не завершен установкой времени в time_update
+        return ERR_BUSY;
+    }
+    if(tv->tv_nsec >= 1000000000) {
+        // значение времени не нормализовано
+        return ERR_ILLEGAL_ARGS;
+    }
+    rtime_to_set.tv_sec = tv->tv_sec;
+    rtime_to_set.tv_nsec = tv->tv_nsec;
+    rtime_flip_id = rtime_id ^ 1;
+    return OK;
+}
+
+#endif // BUILD_TIMER_A9
@@ -17,7 +17,10 @@
     #define LOGLEVEL          LOGLEVEL_ALL
 #endif
 
+//#define BUILD_PMU_USER            //!< счетчик тактов PMU доступен процессам на чтение, только для измерений (tests/test_ipc_bench, tests/test_vm_switch)
+
 //#define BUILD_SMP
+#define PAGE_CORE_CACHE             16       //!< число одиночных страниц в кэше аллокатора каждого ядра при BUILD_SMP
 #define SUPPORT_VFP
 
 #define NUM_CORE                    ARCH_NUM_CORE       //!< максимальное число поддерживаемых ядер
@@ -35,9 +38,20 @@
 #define CLOCK_TICK             1000000  //!< нс
 #define DEFAULT_THREAD_TICKS   1        //!< Величина кванта времени для первого потока, тиков
 
+#define BUILD_TICKLESS                  //!< таймер программируется на ближайшее событие вместо периодического тика
+#define TICKLESS_MAX_NS        1000000000 //!< максимальный интервал между прерываниями таймера в безтактовом режиме, нс
+#define BUILD_KEVENT_WHEEL              //!< хранилище событий менеджера событий на колесе таймеров вместо дерева
+#define BUILD_IRQ_PRIO_MASK             //!< маскирование в GIC прерываний с приоритетом не выше выполняемого потока
+//#define BUILD_TIMER_A9                  //!< таймер ядра на глобальном и приватном таймерах Cortex-A9 вместо EPIT1
+//#define A9_TIMER_CLK_HZ        396000000 //!< частота PERIPHCLK, если отличается от половины частоты ядра по CCM
+
 #define THREAD_SYSTEM_STACK_PAGES       (1)
 
+#ifdef BUILD_TIMER_A9
+#define TIMEOUT_MIN             10000   //!< разрешение таймера позволяет короткие таймауты
+#else
 #define TIMEOUT_MIN             1000000
+#endif
 
 #define MIN_RES_STATIC_ID       1
 #define MAX_RES_STATIC_ID       (INT_MAX/2)
@@ -47,6 +61,14 @@
 
 #define MAX_CHANNEL_PROC        1000
 #define MAX_CONNECTION_PROC     1000
+#define MSG_MOVE_PAGES_MIN      (0x4000UL)  //!< минимальный размер данных сообщения для передачи переносом страниц (MSG_MOVE_PAGES)
+#define MSG_PRIO_LANES          4           //!< число уровней приоритета сообщений канала (по 16 приоритетов потоков)
+#define MSG_PULSES              8           //!< размер очереди импульсов канала (различных кодов событий)
+
+// Память пула резервируется секцией .mmutbl в bsp/os.ld по символу __mmu_tbl_pool_size__,
+// который должен совпадать с MMU_TBL_POOL_SIZE: скрипт компоновки не проходит препроцессор.
+// При меньшей секции init_mmutbl_pool останавливает систему
+#define MMU_TBL_POOL_SIZE       16          //!< число таблиц L1 в пуле MMU, больше числа ядер, не более 64
 
 #define KMEM_AUTOEXTEND_FREESIZE    (0x4000UL)  //!< свободный размер kheap для авторасширения
 
@@ -290,12 +290,23 @@ extern "C" {
 
         ----
 
-        \note Предназначен для реализации быстрых механизмов взаимодействия в системе ))
-        \warning Передача возможна только внутри процесса.
+        ----
+
+        Текущая реализация: диспетчер переключается на поток tid напрямую, без выбора по очередям
+        готовых потоков (прямое переключение отменяется только при наличии готового потока
+        с более высоким приоритетом). Поток tid выполняется с остатком кванта и приоритетом
+        вызывающего потока, если он выше собственного. Грант завершается блокировкой потока tid,
+        его дальнейшей передачей (с тем же остатком) или исчерпанием остатка, после чего поток tid
+        возвращается к собственным приоритету и кванту. Вызывающий поток ставится в очередь
+        как отработавший свой квант.
+
+        \note Предназначен для реализации быстрых механизмов взаимодействия в системе, в том числе
+        для синхронного обмена клиент-сервер между процессами
+        \warning Поток tid должен быть готовым к выполнению (не блокированным и не остановленным)
 
         \param tid  Идентификатор потока
 
-        \return Ошибки выполнения
+        \return OK, ERR_ILLEGAL_ARGS - поток не найден или является текущим, ERR_BUSY - поток не готов
     */
     __syscall int os_thread_yield_to (int tid);
 
@@ -349,10 +360,16 @@ extern "C" {
 
         Номер вызова: \b SYSCALL_THREAD_PRIO
 
-        \param tid Идентификатор потока
-        \param val Абсолютное значение приоритета
+        Изменение приоритета вступает в силу сразу: готовый поток переставляется
+        в очереди планирования, ожидающий мьютекс с наследованием - в очереди ожидания мьютекса.
+        Наследованный приоритет сохраняется, пока он выше нового. Приоритет прерывания,
+        назначенного потоку-обработчику, следует за приоритетом потока.
 
-        \return Ошибки выполнения, текущий или установленный приоритет
+        \param tid Идентификатор потока того же процесса, 0 - текущий поток
+        \param val Абсолютное значение приоритета [PRIO_MAX, PRIO_MIN] или PRIO_GET_CURRENT
+            для запроса текущего
+
+        \return Ошибки выполнения (ERR_ILLEGAL_ARGS, ERR_ACCESS_DENIED), текущий или установленный приоритет
     */
     __syscall int os_thread_prio (int tid, int val);
 
@@ -493,6 +510,14 @@ extern "C" {
     #define CHANNEL_AUTO_KILL           0x01
     #define CHANNEL_SINGLE_CONNECTION   0x02
     #define CHANNEL_AUTO_CONNECT        0x04
+    #define CHANNEL_SHARED_RING         0x08
+    #define CHANNEL_PRIO_INHERIT        0x10
+    #define CHANNEL_MULTICAST           0x20
+    #define CHANNEL_MCAST_DROP_OLDEST   0x40
+    #define CHANNEL_PRIO_LANES          0x80
+
+    #define RING_CONSUMER               0   //!< сторона кольца - владелец канала
+    #define RING_PRODUCER               1   //!< сторона кольца - соединение с каналом
 
     /** \brief Создание и открытие канала для приема сообщений
 
@@ -513,6 +538,23 @@ extern "C" {
 
                           CHANNEL_SINGLE_CONNECTION
                           CHANNEL_AUTO_CONNECT
+                          CHANNEL_SHARED_RING - буфер канала является кольцом os_ring_t
+                                               с областью данных size, доступным на запись
+                                               владельцу и одному производителю (os_ring_attach),
+                                               сообщения os_send в такой канал не принимаются
+                          CHANNEL_PRIO_INHERIT - поток, принявший сообщение, выполняется с приоритетом
+                                               отправителя, если он выше собственного, до ответа
+                                               (os_msg_reply) или следующего приема из любого канала
+                          CHANNEL_MULTICAST - канал рассылки: владелец публикует сообщения (os_mcast_publish),
+                                               каждое соединение является подписчиком и читает все
+                                               сообщения из общего буфера (os_mcast_receive)
+                          CHANNEL_MCAST_DROP_OLDEST - при переполнении буфера рассылки публикация вытесняет
+                                               самые старые сообщения, не дожидаясь отстающих подписчиков,
+                                               иначе публикация блокируется до освобождения места
+                          CHANNEL_PRIO_LANES - сообщения выдаются по уровням собственного приоритета
+                                               отправителей (MSG_PRIO_LANES уровней по 16 приоритетов),
+                                               внутри уровня и без флага - в порядке поступления;
+                                               наследованный отправителем приоритет уровень не меняет
 
         \return Идентификатор канала или Код ошибки
         \retval ERR_CHANNEL_NAME_USED
@@ -590,6 +632,10 @@ extern "C" {
     __syscall int os_connection_close (int conid);
 
     #define MSG_WAIT_COMPLETE           0x01
+    #define MSG_MOVE_PAGES              0x02    //!< передача данных переносом страниц без копирования
+
+    #define MSG_IOV_MAX                 16      //!< максимальное число частей сообщения os_sendv
+    #define MSG_BATCH_MAX               32      //!< максимальное число сообщений за вызов os_receive_batch
 
     /**
         \brief Посылка сообщения
@@ -610,7 +656,19 @@ extern "C" {
                         или
                         NO_WAIT - не ждать, если приемник не может принять сообщение
                         TIMEOUT_INFINITY - бесконечное ожидание
-        \param flags    TODO флаг передачи приоритета
+        Сообщения выдаются получателю в порядке поступления, для канала с CHANNEL_PRIO_LANES -
+        по уровням собственного приоритета потоков-отправителей на момент посылки
+        (см. MSG_PRIO_LANES ядра), в порядке поступления среди сообщений одного уровня.
+
+        \param flags    MSG_WAIT_COMPLETE - ожидание приема сообщения получателем\n
+                        MSG_MOVE_PAGES - если данные сообщения занимают с начала собственный сегмент
+                        страничной памяти отправителя (выделенный os_malloc) и их размер не меньше
+                        MSG_MOVE_PAGES_MIN ядра, страницы сегмента переносятся в карту памяти получателя
+                        вместо копирования в буфер канала. Отправитель теряет доступ к сегменту,
+                        получатель принимает сообщение с описанием сегмента типа SYS_MSG_MEM_SEND,
+                        поле data указывает на перенесенные страницы, после обработки
+                        сегмент освобождается получателем (os_mfree).
+                        Иначе данные копируются как обычно
 
         \return Ошибки выполнения
         \retval ERR_SEND_FULL   Переполнение очереди приема
@@ -640,6 +698,282 @@ extern "C" {
     */
     __syscall int os_receive (int chid, struct msg **m, uint64_t timeout);
 
+
+    /**
+        \brief Посылка сообщения, собранного из нескольких частей
+
+        Номер вызова: \b SYSCALL_SENDV
+
+        Аналогично os_send, данные частей iov копируются подряд в одну запись буфера канала,
+        получатель принимает одно сообщение без системных данных (sys.ptr = NULL)
+        с общим размером всех частей.
+
+        \param conid    Номер соединения
+        \param iov      Части данных сообщения
+        \param iovcnt   Число частей, не более MSG_IOV_MAX
+        \param timeout  время ожидания отправки, нс
+                        или
+                        NO_WAIT - не ждать, если приемник не может принять сообщение
+                        TIMEOUT_INFINITY - бесконечное ожидание
+        \param flags    MSG_WAIT_COMPLETE
+
+        \return Ошибки выполнения
+    */
+    __syscall int os_sendv (int conid, const struct msg_iov *iov, int iovcnt, uint64_t timeout, int flags);
+
+
+    /** \brief Пакетный прием сообщений
+
+        Номер вызова: \b SYSCALL_RECEIVE_BATCH
+
+        Получение за один вызов до n (не более MSG_BATCH_MAX) сообщений, находящихся в канале.
+        Если новых сообщений нет, происходит блокировка потока аналогично os_receive.
+        Полученные сообщения остаются в буфере канала и действительны до явного освобождения
+        os_receive_release, занимаемое ими место становится доступным отправителям после освобождения.
+
+        \warning Сообщения, полученные os_receive, освобождаются также при os_receive_release,
+                 поэтому смешивать вызовы в разных потоках по одному каналу не следует
+
+        \param       chid         Номер канала
+        \param[out]  m            Массив указателей на сообщения
+        \param       n            Размер массива
+        \param       timeout      время ожидания получения, нс
+                                  NO_WAIT - неблокирующий вызов
+                                  TIMEOUT_INFINITY - бесконечная блокировка
+
+        \return Число полученных сообщений или Код ошибки
+    */
+    __syscall int os_receive_batch (int chid, struct msg **m, int n, uint64_t timeout);
+
+
+    /** \brief Освобождение сообщений пакетного приема
+
+        Номер вызова: \b SYSCALL_RECEIVE_RELEASE
+
+        \param chid     Номер канала
+        \param m        Массив указателей на сообщения, полученные os_receive_batch
+        \param n        Число сообщений
+
+        \return Ошибки выполнения
+        \retval ERR_ILLEGAL_ARGS    Среди указанных есть сообщения, не выданные пакетным приемом
+    */
+    __syscall int os_receive_release (int chid, struct msg **m, int n);
+
+
+    /** \brief Синхронная посылка запроса с ожиданием ответа
+
+        Номер вызова: \b SYSCALL_MSG_SEND_RECV
+
+        Синхронный обмен запрос-ответ через соединение без буферизации в канале.\n
+        Если в канале ожидает поток-получатель (os_msg_receive), процессор сразу передается ему
+        с остатком кванта и приоритетом отправителя (как при os_thread_yield_to). Внутри процесса
+        данные запроса и ответа копируются один раз непосредственно между буферами потоков,
+        между процессами - через буфер в памяти ядра, так как каждый процесс обращается
+        только к своей памяти.
+        Иначе поток блокируется до приема запроса на время timeout.
+        После приема запроса поток ожидает ответа (os_msg_reply) без ограничения по времени,
+        данные ответа копируются в rbuf, при ответе процессор передается обратно отправителю.
+
+        \param conid    Номер соединения
+        \param sbuf     Данные запроса
+        \param slen     Размер запроса в байтах
+        \param rbuf     Буфер ответа
+        \param rlen     Размер буфера ответа, ответ большего размера усекается
+        \param timeout  время ожидания приема запроса получателем, нс
+                        NO_WAIT - не ждать, если в канале нет ожидающего получателя
+                        TIMEOUT_INFINITY - бесконечное ожидание
+
+        \return Значение status ответа или Код ошибки
+        \retval ERR_TIMEOUT     Запрос не принят за время timeout
+        \retval ERR_DEAD        Канал закрыт
+        \retval ERR_NO_MEM      Нет памяти ядра для передачи запроса или ответа другому процессу
+    */
+    __syscall int os_msg_send_recv (int conid, const void *sbuf, size_t slen, void *rbuf, size_t rlen, uint64_t timeout);
+
+
+    /** \brief Синхронный прием запроса
+
+        Номер вызова: \b SYSCALL_MSG_RECEIVE
+
+        Прием запроса, посланного os_msg_send_recv, в буфер buf.
+        Ожидающие отправители принимаются в порядке приоритета, равные - в порядке поступления.
+        Если ожидающих отправителей нет, поток блокируется на время timeout.
+        Для канала с CHANNEL_PRIO_INHERIT поток выполняется с приоритетом отправителя
+        до ответа или следующего приема.
+        Отправитель остается заблокированным до ответа по номеру приема os_msg_reply.
+
+        \param       chid     Номер канала
+        \param       buf      Приемный буфер
+        \param       size     Размер приемного буфера, запрос большего размера усекается
+        \param[out]  len      Размер принятых данных (может быть NULL)
+        \param       timeout  время ожидания запроса, нс
+                              NO_WAIT - неблокирующий вызов
+                              TIMEOUT_INFINITY - бесконечная блокировка
+
+        \return Номер приема для ответа (> 0) или Код ошибки
+        \retval ERR_TIMEOUT     Нет запросов за время timeout
+        \retval ERR_DEAD        Канал закрыт
+    */
+    __syscall int os_msg_receive (int chid, void *buf, size_t size, size_t *len, uint64_t timeout);
+
+
+    /** \brief Ответ на синхронный запрос
+
+        Номер вызова: \b SYSCALL_MSG_REPLY
+
+        Копирование ответа в буфер отправителя и его разблокировка,
+        отправитель получает status как результат os_msg_send_recv.
+        Если отвечающий поток выполняется с квантом отправителя, полученным при
+        передаче запроса, процессор передается отправителю с остатком кванта.
+
+        \param rcvid    Номер приема, полученный os_msg_receive
+        \param status   Результат для отправителя
+        \param buf      Данные ответа
+        \param len      Размер ответа в байтах
+
+        \return Ошибки выполнения
+        \retval ERR_ILLEGAL_ARGS    Нет отправителя, ожидающего ответа по номеру приема
+        \retval ERR_NO_MEM          Нет памяти ядра для передачи ответа другому процессу,
+                                    отправитель разблокируется с этим же кодом
+    */
+    __syscall int os_msg_reply (int rcvid, int status, const void *buf, size_t len);
+
+
+    /** \brief Подключение к кольцу канала CHANNEL_SHARED_RING
+
+        Номер вызова: \b SYSCALL_RING_ATTACH
+
+        Запись и чтение кольца выполняются в процессах без системных вызовов
+        (os_ring_put/os_ring_get библиотеки), ядро участвует только в ожидании
+        и пробуждении сторон (os_ring_wait/os_ring_signal).
+        Производитель у кольца может быть только один, буфер кольца отображается
+        в его процесс только при подключении, остальным соединениям канала он недоступен.
+
+        \param       id     Номер канала (RING_CONSUMER) или соединения с ним (RING_PRODUCER)
+        \param       side   Сторона кольца
+        \param[out]  ring   Адрес кольца в памяти процесса
+
+        \return Ошибки выполнения
+        \retval ERR_ILLEGAL_ARGS    Канал не является кольцом
+        \retval ERR_BUSY            У кольца уже есть производитель
+        \retval ERR_IPC_SHARE       Не удалось отобразить буфер кольца производителю
+    */
+    __syscall int os_ring_attach (int id, int side, os_ring_t **ring);
+
+
+    /** \brief Ожидание звонка стороне кольца
+
+        Номер вызова: \b SYSCALL_RING_WAIT
+
+        Блокирует поток до звонка os_ring_signal другой стороны, если звонок
+        не поступил ранее. Потребитель ожидает данные, производитель - место.
+
+        \param id       Номер канала (RING_CONSUMER) или соединения (RING_PRODUCER)
+        \param side     Сторона ожидающего
+        \param timeout  время ожидания, нс
+
+        \return Ошибки выполнения
+        \retval ERR_TIMEOUT     Нет звонка за время timeout
+        \retval ERR_DEAD        Канал закрыт или производитель отключен
+    */
+    __syscall int os_ring_wait (int id, int side, uint64_t timeout);
+
+
+    /** \brief Звонок другой стороне кольца
+
+        Номер вызова: \b SYSCALL_RING_SIGNAL
+
+        Пробуждает поток, ожидающий другой стороны, или оставляет звонок до ее ожидания.
+
+        \param id       Номер канала (RING_CONSUMER) или соединения (RING_PRODUCER)
+        \param side     Сторона звонящего
+
+        \return Ошибки выполнения
+    */
+    __syscall int os_ring_signal (int id, int side);
+
+
+    /** \brief Публикация сообщения в канал рассылки
+
+        Номер вызова: \b SYSCALL_MCAST_PUBLISH
+
+        Данные сообщения копируются один раз в буфер канала CHANNEL_MULTICAST, доступный
+        всем подписчикам только на чтение. Сообщение хранится, пока его не примут все соединения,
+        подключенные к каналу на момент публикации. Если подписчиков нет, сообщение не сохраняется.
+        При нехватке места поток блокируется на время timeout, для канала с CHANNEL_MCAST_DROP_OLDEST
+        место освобождается вытеснением старых сообщений, кроме принятых и еще обрабатываемых.
+
+        \param chid     Номер канала рассылки
+        \param m        Сообщение, системная часть не поддерживается
+        \param timeout  время ожидания места, нс
+
+        \return Ошибки выполнения
+        \retval ERR_TIMEOUT             Нет места за время timeout
+        \retval ERR_IPC_ILLEGAL_CHANNEL Канал не является каналом рассылки
+    */
+    __syscall int os_mcast_publish (int chid, const struct msg *m, uint64_t timeout);
+
+
+    /** \brief Прием сообщения подписчиком канала рассылки
+
+        Номер вызова: \b SYSCALL_MCAST_RECEIVE
+
+        Выдает следующее сообщение по курсору соединения. Сообщение находится в общем буфере
+        канала и доступно до следующего вызова по этому соединению, после чего освобождается.
+        Если новых сообщений нет, поток блокируется на время timeout.
+
+        \param conid    Номер соединения с каналом рассылки
+        \param m[out]   Указатель на сообщение
+        \param timeout  время ожидания, нс
+
+        \return Число сообщений, вытесненных до приема этого сообщения (CHANNEL_MCAST_DROP_OLDEST),
+                или ошибки выполнения
+        \retval ERR_TIMEOUT             Нет сообщений за время timeout
+        \retval ERR_DEAD                Канал закрыт
+        \retval ERR_IPC_ILLEGAL_CHANNEL Канал не является каналом рассылки
+    */
+    __syscall int os_mcast_receive (int conid, struct msg **m, uint64_t timeout);
+
+
+    /** \brief Отправка импульса в канал
+        Номер вызова: \b SYSCALL_PULSE
+
+        Импульс - уведомление фиксированного размера, хранится в очереди импульсов канала
+        в памяти ядра, а не в буфере сообщений. Если импульс с кодом code уже ожидает приема,
+        новый объединяется с ним: значение заменяется, счетчик импульсов увеличивается.
+        Вызов никогда не блокируется, новый импульс будит не более одного потока,
+        ожидающего в os_pulse_receive, и оповещает порты ожидания канала.
+
+        \param conid    Номер соединения
+        \param code     Код события
+        \param value    Значение
+
+        \return Ошибки выполнения
+        \retval ERR_ILLEGAL_ARGS    Канал является кольцом или рассылкой
+        \retval ERR_BUSY    Очередь импульсов канала заполнена импульсами с другими кодами (MSG_PULSES)
+        \retval ERR_DEAD    Канал закрыт
+    */
+    __syscall int os_pulse (int conid, int code, uint32_t value);
+
+
+    /** \brief Прием импульса владельцем канала
+        Номер вызова: \b SYSCALL_PULSE_RECEIVE
+
+        Выдает самый старый ожидающий импульс канала. Если импульсов нет,
+        поток блокируется на время timeout. Импульсы принимаются отдельно от сообщений,
+        для одновременного ожидания тех и других канал добавляется в порт ожидания.
+
+        \param chid     Номер канала
+        \param p[out]   Импульс с числом объединенных в нем импульсов
+        \param timeout  время ожидания, нс
+
+        \return Ошибки выполнения
+        \retval ERR_ILLEGAL_ARGS    Канал является кольцом или рассылкой
+        \retval ERR_TIMEOUT Нет импульсов за время timeout
+        \retval ERR_DEAD    Канал закрыт
+    */
+    __syscall int os_pulse_receive (int chid, pulse_t *p, uint64_t timeout);
+
     /**@}*/
 
 /**@}*/
@@ -826,6 +1160,166 @@ extern "C" {
 /**@}*/
 
 
+/** \name Таймеры */
+/**@{*/
+
+    /** Таймеры ядра срабатывают в заданные моменты системного времени OS_CLOCK_MONOTONIC
+        однократно или периодически. Периодический таймер перезапускается ядром без участия
+        процесса от момента предыдущего срабатывания, а не от момента оповещения, поэтому
+        ошибка времени срабатываний не накапливается. Таймер доступен только процессу-создателю
+        и удаляется при его завершении.
+    */
+
+    /** \defgroup timer Таймеры
+        \ingroup API */
+    /**@{*/
+
+    /** \brief Создание таймера
+
+        Номер вызова: \b SYSCALL_TIMER_CREATE
+
+        Таймер создается остановленным, запуск выполняется по os_timer_set.
+        При срабатывании ядро освобождает семафор SEMAPHORE_TYPE_PSHARED (TIMER_NOTIFY_SYN)
+        или помещает в канал процесса импульс (TIMER_NOTIFY_PULSE) с кодом, равным номеру таймера,
+        и значением notify->value.value_int, импульс принимается os_pulse_receive. Пропущенные
+        срабатывания объединяются в один импульс со счетчиком и не занимают буфер канала.
+        TIMER_NOTIFY_CHANNEL сохранен для совместимости и оповещает так же, как TIMER_NOTIFY_PULSE:
+        срабатывание обрабатывается по прерыванию, когда память процесса-владельца
+        (буфер канала, счетчик SEMAPHORE_TYPE_PLOCAL) может быть недоступна.
+
+        \param notify  Способ оповещения, семафор или канал сообщений должны принадлежать процессу
+
+        \return >0               - идентификатор таймера
+                ERR_ILLEGAL_ARGS - недопустимый способ оповещения, семафор или канал не найден,
+                                   семафор SEMAPHORE_TYPE_PLOCAL, канал кольца или рассылки
+                ERR_NO_MEM       - превышено число таймеров процесса
+    */
+    __syscall int os_timer_create (const struct timer_notify *notify);
+
+
+    /** \brief Удаление таймера
+
+        Номер вызова: \b SYSCALL_TIMER_DELETE
+
+        \param id  Идентификатор таймера
+
+        \return OK  - выполнено
+                ERR - не верный идентификатор
+    */
+    __syscall int os_timer_delete (int id);
+
+
+    /** \brief Запуск или остановка таймера
+
+        Номер вызова: \b SYSCALL_TIMER_SET
+
+        Новые параметры заменяют предыдущие, в том числе для запущенного таймера.
+        Момент срабатывания в прошлом приводит к срабатыванию сразу. Если периодический
+        таймер пропустил несколько периодов, оповещение выполняется один раз, а следующее
+        срабатывание назначается на ближайший будущий момент из последовательности периодов.
+
+        \param id     Идентификатор таймера
+        \param spec   Момент первого срабатывания и период, spec->value = 0 - остановка таймера,
+                      период не меньше TIMEOUT_MIN ядра
+        \param flags  TIMER_FLAG_ABSTIME - spec->value задан абсолютным временем OS_CLOCK_MONOTONIC,
+                      иначе относительно текущего времени
+
+        \return OK               - выполнено
+                ERR              - не верный идентификатор
+                ERR_ILLEGAL_ARGS - недопустимые параметры
+    */
+    __syscall int os_timer_set (int id, const struct timer_spec *spec, int flags);
+
+    /**@}*/
+
+/**@}*/
+
+
+/** \name Порты ожидания */
+/**@{*/
+
+    /** Порт ожидания позволяет одному потоку ожидать события сразу нескольких источников:
+        каналов процесса, разделяемых семафоров и прерываний. Источник по умолчанию выдается
+        при каждом ожидании, пока он готов (по уровню), с флагом PORT_EDGE - только при новых
+        событиях (по фронту). Прерывание, подключенное к порту, запрещается ядром при
+        срабатывании и выдается как событие, обработчик разрешает его снова os_irq_ctrl
+        после обслуживания устройства. Порт доступен только процессу-создателю
+        и удаляется при его завершении.
+    */
+
+    /** \defgroup port Порты ожидания
+        \ingroup API */
+    /**@{*/
+
+    #define PORT_ADD            1   //!< добавление источника
+    #define PORT_DEL            2   //!< удаление источника
+    #define PORT_EVENTS_MAX     32  //!< наибольшее число событий за одно ожидание
+
+    /** \brief Создание порта ожидания
+
+        Номер вызова: \b SYSCALL_PORT_CREATE
+
+        \return >0               - идентификатор порта
+                ERR_NO_MEM       - превышено число портов процесса
+    */
+    __syscall int os_port_create ();
+
+
+    /** \brief Удаление порта ожидания
+
+        Номер вызова: \b SYSCALL_PORT_DELETE
+
+        Источники отключаются от порта, ожидающие потоки получают ERR_DEAD.
+
+        \param id  Идентификатор порта
+
+        \return OK  - выполнено
+                ERR - не верный идентификатор
+    */
+    __syscall int os_port_delete (int id);
+
+
+    /** \brief Добавление или удаление источника порта
+
+        Номер вызова: \b SYSCALL_PORT_CTL
+
+        Источник добавляется в порт один раз. Канал должен принадлежать процессу,
+        прерывание не должно иметь обработчика (os_irq_hook), его приоритет задается
+        приоритетом вызывающего потока. Быстрые семафоры (SEMAPHORE_TYPE_PLOCAL) освобождаются
+        без обращения к ядру и не могут быть источником.
+
+        \param id   Идентификатор порта
+        \param op   PORT_ADD или PORT_DEL
+        \param ev   Источник: type, id, а для PORT_ADD также flags и data
+
+        \return OK               - выполнено
+                ERR              - не верный идентификатор порта
+                ERR_ILLEGAL_ARGS - источник не найден или недоступен
+                ERR_BUSY         - источник уже добавлен или прерывание занято
+    */
+    __syscall int os_port_ctl (int id, int op, const port_event_t *ev);
+
+
+    /** \brief Ожидание событий порта
+
+        Номер вызова: \b SYSCALL_PORT_WAIT
+
+        \param id       Идентификатор порта
+        \param ev       Массив для готовых источников
+        \param n        Размер массива, не более PORT_EVENTS_MAX учитывается
+        \param timeout  Время ожидания, нс
+
+        \return >0 - число готовых источников в ev
+                ERR_TIMEOUT  - нет событий за время timeout
+                ERR_DEAD     - порт удален
+    */
+    __syscall int os_port_wait (int id, port_event_t *ev, int n, uint64_t timeout);
+
+    /**@}*/
+
+/**@}*/
+
+
 /** \name Системные утилиты */
 /**@{*/
 
@@ -852,7 +1346,7 @@ extern "C" {
         Вывод запрашиваемой информации по типу
         (версия ОС, запущенные процессы, использование памяти, использование процессора и т.д.)
 
-        \param[in]  type  Тип запрашиваемой информации
+        \param[in]  type  Тип запрашиваемой информации, пока поддерживается только OS_INFO_MEM
         \param[out] info  Информация
 
         \return Ошибки выполнения
@@ -873,6 +1367,10 @@ extern "C" {
                            который определяется по первому системному вызову установки времени
         \param[out] val указатель на возвращаемое значение времени
 
+        \note Для частого получения времени без системного вызова каждый процесс имеет
+               отображенную только для чтения страницу времени (struct os_time_page),
+               ссылка на нее находится в thread_tls_user.time_page
+
         \return Ошибки выполнения
     */
     __syscall int os_time (int clock_id, kernel_time_t *val, kernel_time_t *newval);
@@ -31,12 +31,25 @@ typedef enum syscall {
 
     SYSCALL_SEND,
     SYSCALL_RECEIVE,
+    SYSCALL_SENDV,
+    SYSCALL_RECEIVE_BATCH,
+    SYSCALL_RECEIVE_RELEASE,
     SYSCALL_CHANNEL_OPEN,
     SYSCALL_CHANNEL_WAIT_CONNECTION,
     SYSCALL_CHANNEL_COMPLETE_CONNECTION,
     SYSCALL_CHANNEL_CLOSE,
     SYSCALL_CONNECTION_OPEN,
     SYSCALL_CONNECTION_CLOSE,
+    SYSCALL_MSG_SEND_RECV,
+    SYSCALL_MSG_RECEIVE,
+    SYSCALL_MSG_REPLY,
+    SYSCALL_RING_ATTACH,
+    SYSCALL_RING_WAIT,
+    SYSCALL_RING_SIGNAL,
+    SYSCALL_MCAST_PUBLISH,
+    SYSCALL_MCAST_RECEIVE,
+    SYSCALL_PULSE,
+    SYSCALL_PULSE_RECEIVE,
 
     SYSCALL_IRQ_HOOK,
     SYSCALL_IRQ_RELEASE,
@@ -49,6 +62,15 @@ typedef enum syscall {
     SYSCALL_SYN_WAIT,
     SYSCALL_SYN_DONE,
 
+    SYSCALL_TIMER_CREATE,
+    SYSCALL_TIMER_DELETE,
+    SYSCALL_TIMER_SET,
+
+    SYSCALL_PORT_CREATE,
+    SYSCALL_PORT_DELETE,
+    SYSCALL_PORT_CTL,
+    SYSCALL_PORT_WAIT,
+
     SYSCALL_SHUTDOWN,
     SYSCALL_GET_INFO,
     SYSCALL_TIME,
@@ -156,7 +178,7 @@ __syscall int os_thread_sleep (uint64_t timeout) {
 
 __syscall int os_thread_prio (int tid, int val) {
     register int ret __asm__ ("r0");
-    register const int id __asm__ ("r0") = (val);
+    register const int id __asm__ ("r0") = (tid);
     register const int v __asm__ ("r1") = (val);
     asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_THREAD_PRIO),
             "r" (id), "r" (v));
@@ -209,6 +231,144 @@ __syscall int os_receive (int chid, struct msg **m, uint64_t timeout) {
     return ret;
 }
 
+__syscall int os_sendv (int conid, const struct msg_iov *iov, int iovcnt, uint64_t timeout, int flags) {
+    register int ret __asm__ ("r0");
+    register const int id __asm__ ("r0") = (conid);
+    register const struct msg_iov *v __asm__ ("r1") = (iov);
+    register const uint64_t tout __asm__ ("r2") = (timeout);
+    register const int f __asm__ ("r4") = (flags);
+    register const int cnt __asm__ ("r5") = (iovcnt);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_SENDV),
+            "r" (id), "r" (v), "r" (tout), "r" (f), "r" (cnt));
+    return ret;
+}
+
+__syscall int os_receive_batch (int chid, struct msg **m, int n, uint64_t timeout) {
+    register int ret __asm__ ("r0");
+    register const int id __asm__ ("r0") = (chid);
+    register struct msg **msg __asm__ ("r1") = (m);
+    register const uint64_t tout __asm__ ("r2") = (timeout);
+    register const int cnt __asm__ ("r4") = (n);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_RECEIVE_BATCH),
+            "r" (id), "r" (msg), "r" (tout), "r" (cnt));
+    return ret;
+}
+
+__syscall int os_receive_release (int chid, struct msg **m, int n) {
+    register int ret __asm__ ("r0");
+    register const int id __asm__ ("r0") = (chid);
+    register struct msg **msg __asm__ ("r1") = (m);
+    register const int cnt __asm__ ("r2") = (n);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_RECEIVE_RELEASE),
+            "r" (id), "r" (msg), "r" (cnt));
+    return ret;
+}
+
+__syscall int os_msg_send_recv (int conid, const void *sbuf, size_t slen, void *rbuf, size_t rlen, uint64_t timeout) {
+    register int ret __asm__ ("r0");
+    register const int id __asm__ ("r0") = (conid);
+    register const void *sb __asm__ ("r1") = (sbuf);
+    register const size_t sl __asm__ ("r2") = (slen);
+    register void *rb __asm__ ("r3") = (rbuf);
+    register const uint64_t tout __asm__ ("r4") = (timeout);
+    register const size_t rl __asm__ ("r6") = (rlen);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_MSG_SEND_RECV),
+            "r" (id), "r" (sb), "r" (sl), "r" (rb), "r" (tout), "r" (rl));
+    return ret;
+}
+
+__syscall int os_msg_receive (int chid, void *buf, size_t size, size_t *len, uint64_t timeout) {
+    register int ret __asm__ ("r0");
+    register const int id __asm__ ("r0") = (chid);
+    register void *b __asm__ ("r1") = (buf);
+    register const uint64_t tout __asm__ ("r2") = (timeout);
+    register const size_t s __asm__ ("r4") = (size);
+    register size_t *l __asm__ ("r5") = (len);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_MSG_RECEIVE),
+            "r" (id), "r" (b), "r" (tout), "r" (s), "r" (l));
+    return ret;
+}
+
+__syscall int os_msg_reply (int rcvid, int status, const void *buf, size_t len) {
+    register int ret __asm__ ("r0");
+    register const int id __asm__ ("r0") = (rcvid);
+    register const int st __asm__ ("r1") = (status);
+    register const void *b __asm__ ("r2") = (buf);
+    register const size_t l __asm__ ("r3") = (len);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_MSG_REPLY),
+            "r" (id), "r" (st), "r" (b), "r" (l));
+    return ret;
+}
+
+__syscall int os_ring_attach (int id, int side, os_ring_t **ring) {
+    register int ret __asm__ ("r0");
+    register const int i __asm__ ("r0") = (id);
+    register const int sd __asm__ ("r1") = (side);
+    register os_ring_t **r __asm__ ("r2") = (ring);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_RING_ATTACH),
+            "r" (i), "r" (sd), "r" (r));
+    return ret;
+}
+
+__syscall int os_ring_wait (int id, int side, uint64_t timeout) {
+    register int ret __asm__ ("r0");
+    register const int i __asm__ ("r0") = (id);
+    register const int sd __asm__ ("r1") = (side);
+    register const uint64_t tout __asm__ ("r2") = (timeout);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_RING_WAIT),
+            "r" (i), "r" (sd), "r" (tout));
+    return ret;
+}
+
+__syscall int os_ring_signal (int id, int side) {
+    register int ret __asm__ ("r0");
+    register const int i __asm__ ("r0") = (id);
+    register const int sd __asm__ ("r1") = (side);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_RING_SIGNAL),
+            "r" (i), "r" (sd));
+    return ret;
+}
+
+__syscall int os_mcast_publish (int chid, const struct msg *m, uint64_t timeout) {
+    register int ret __asm__ ("r0");
+    register const int i __asm__ ("r0") = (chid);
+    register const struct msg *msg __asm__ ("r1") = (m);
+    register const uint64_t tout __asm__ ("r2") = (timeout);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_MCAST_PUBLISH),
+            "r" (i), "r" (msg), "r" (tout));
+    return ret;
+}
+
+__syscall int os_mcast_receive (int conid, struct msg **m, uint64_t timeout) {
+    register int ret __asm__ ("r0");
+    register const int i __asm__ ("r0") = (conid);
+    register struct msg **msg __asm__ ("r1") = (m);
+    register const uint64_t tout __asm__ ("r2") = (timeout);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_MCAST_RECEIVE),
+            "r" (i), "r" (msg), "r" (tout));
+    return ret;
+}
+
+__syscall int os_pulse (int conid, int code, uint32_t value) {
+    register int ret __asm__ ("r0");
+    register const int i __asm__ ("r0") = (conid);
+    register const int c __asm__ ("r1") = (code);
+    register const uint32_t v __asm__ ("r2") = (value);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_PULSE),
+            "r" (i), "r" (c), "r" (v));
+    return ret;
+}
+
+__syscall int os_pulse_receive (int chid, pulse_t *p, uint64_t timeout) {
+    register int ret __asm__ ("r0");
+    register const int i __asm__ ("r0") = (chid);
+    register pulse_t *pls __asm__ ("r1") = (p);
+    register const uint64_t tout __asm__ ("r2") = (timeout);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_PULSE_RECEIVE),
+            "r" (i), "r" (pls), "r" (tout));
+    return ret;
+}
+
 
 __syscall int os_channel_open (channel_type_t type, char *pathname, int size, int flags) {
     register int ret __asm__ ("r0");
@@ -341,6 +501,66 @@ __syscall int os_syn_done (int id) {
     return ret;
 }
 
+__syscall int os_timer_create (const struct timer_notify *notify) {
+    register int ret __asm__ ("r0");
+    register const struct timer_notify *n __asm__ ("r0") = (notify);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_TIMER_CREATE),
+            "r" (n));
+    return ret;
+}
+
+__syscall int os_timer_delete (int id) {
+    register int ret __asm__ ("r0");
+    register const int tmid __asm__ ("r0") = (id);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_TIMER_DELETE),
+            "r" (tmid));
+    return ret;
+}
+
+__syscall int os_timer_set (int id, const struct timer_spec *spec, int flags) {
+    register int ret __asm__ ("r0");
+    register const int tmid __asm__ ("r0") = (id);
+    register const struct timer_spec *sp __asm__ ("r1") = (spec);
+    register const int f __asm__ ("r2") = (flags);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_TIMER_SET),
+            "r" (tmid), "r" (sp), "r" (f));
+    return ret;
+}
+
+__syscall int os_port_create () {
+    register int ret __asm__ ("r0");
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_PORT_CREATE));
+    return ret;
+}
+
+__syscall int os_port_delete (int id) {
+    register int ret __asm__ ("r0");
+    register const int pid __asm__ ("r0") = (id);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_PORT_DELETE), "r" (pid));
+    return ret;
+}
+
+__syscall int os_port_ctl (int id, int op, const port_event_t *ev) {
+    register int ret __asm__ ("r0");
+    register const int pid __asm__ ("r0") = (id);
+    register const int o __asm__ ("r1") = (op);
+    register const port_event_t *e __asm__ ("r2") = (ev);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_PORT_CTL),
+            "r" (pid), "r" (o), "r" (e));
+    return ret;
+}
+
+__syscall int os_port_wait (int id, port_event_t *ev, int n, uint64_t timeout) {
+    register int ret __asm__ ("r0");
+    register const int pid __asm__ ("r0") = (id);
+    register port_event_t *e __asm__ ("r1") = (ev);
+    register const uint64_t tout __asm__ ("r2") = (timeout);
+    register const int cnt __asm__ ("r4") = (n);
+    asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_PORT_WAIT),
+            "r" (pid), "r" (e), "r" (tout), "r" (cnt));
+    return ret;
+}
+
 __syscall int os_shutdown () {
     register int ret __asm__ ("r0");
     asm volatile  ("svc %[sc]":[ret] "=r" (ret):[sc] "i" (SYSCALL_SHUTDOWN));
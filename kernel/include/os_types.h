@@ -256,8 +256,16 @@ struct mem_info {
     int maps;
     int segs;
     int pgts;
+    struct {
+        int size;               //!< число таблиц L1 в пуле MMU
+        uint32_t hits;          //!< переключения на карту, оставшуюся в пуле
+        uint32_t misses;        //!< загрузки карты в пул
+        uint32_t evictions;     //!< вытеснения карт других процессов из пула
+    } mmutbl;
 };
 
+#define OS_INFO_MEM     1       //!< информация о памяти, struct mem_info
+
 union os_info {
 //struct kernel_info  kernel;
     struct mem_info mem;
@@ -272,6 +280,7 @@ union os_info {
 typedef struct thread_tls_user {
     int tid;                    //! < Номер потока
     int pid;                    //! < Номер процесса
+    const struct os_time_page *time_page; //! < Страница времени, NULL - время только через os_time
     struct _reent reent;        //! < Контекст исполнения стандартной библиотеки libc, отдельный для каждого потока
 } thread_tls_user_t;
 
@@ -306,6 +315,28 @@ typedef struct kernel_time {
     uint64_t tv_nsec;
 } kernel_time_t;
 
+/**
+ * Страница времени, отображаемая ядром в каждый процесс только для чтения.
+ * Позволяет получать OS_CLOCK_MONOTONIC и OS_CLOCK_REALTIME без системного вызова os_time:
+ * к значениям на момент последнего обновления ядром добавляется время по текущему значению
+ * аппаратного счетчика таймера, регистр которого также отображен в процесс только для чтения.
+ * Чтение выполняется повторно, если в его начале в seq сброшен OS_TIME_PAGE_SEQ_VALID
+ * (ядро обновляет значения) или по его окончании значение seq изменилось
+ */
+#define OS_TIME_PAGE_SEQ_VALID      0x80000000u
+#define OS_TIME_PAGE_COUNTER_UP     0x01    //!< счетчик прямого счета, иначе - обратного
+
+typedef struct os_time_page {
+    volatile uint32_t seq;              //!< состояние обновления значений ядром
+    uint32_t flags;                     //!< OS_TIME_PAGE_*
+    const volatile uint32_t *counter;   //!< регистр аппаратного счетчика таймера, NULL - счетчик процессам недоступен
+    uint32_t counter_base;              //!< значение счетчика, соответствующее time_ns и rtime
+    uint32_t mult;                      //!< пересчет тиков счетчика в нс: (тики * mult) >> shift
+    uint32_t shift;
+    uint64_t time_ns;                   //!< OS_CLOCK_MONOTONIC, нс
+    kernel_time_t rtime;                //!< OS_CLOCK_REALTIME
+} os_time_page_t;
+
 typedef struct atomic32 {
     int32_t __attribute__((aligned(4))) val;
 } atomic32_t;
@@ -359,8 +390,11 @@ typedef struct syn {
                                 // syn_wait и syn_done поле также модифицируется ядром
         int limit;              //! [in] для семафоров и барьеров - максимальное значение счетчика
     };
+    int             flags;      //! [in]  флаги SYN_FLAG_*
 } syn_t;
 
+#define SYN_FLAG_PRIO_INHERIT   0x01    //!< мьютекс с наследованием приоритета (PTHREAD_PRIO_INHERIT)
+
 typedef enum sys_msg_type {
     SYS_MSG_MEM_SEND,                           //!< передача во владение страничной памяти другому процессу
     SYS_MSG_MEM_SHARE,                          //!< разрешение доступа к страничной памяти другому процессу
@@ -386,6 +420,62 @@ typedef struct sys_msg_signal_event {
     union sigval value;                         //!< данные
 } sys_msg_signal_event_t;        //!< операция передачи сигналов
 
+/**
+ * Импульс - асинхронное уведомление фиксированного размера (os_pulse).
+ * Импульсы с одинаковым кодом, ожидающие приема, объединяются в один
+ */
+typedef struct pulse {
+    int code;                                   //!< код события
+    uint32_t value;                             //!< значение последнего из объединенных импульсов
+    uint32_t count;                             //!< число объединенных импульсов
+} pulse_t;
+
+typedef enum timer_notify_type {
+    TIMER_NOTIFY_SYN,       //!< освобождение семафора SEMAPHORE_TYPE_PSHARED процесса, как по os_syn_done
+    TIMER_NOTIFY_CHANNEL,   //!< для совместимости, то же, что TIMER_NOTIFY_PULSE
+    TIMER_NOTIFY_PULSE,     //!< импульс в канал процесса, код - номер таймера, значение - value.value_int
+} timer_notify_type_t;
+
+/**
+ * Способ оповещения о срабатывании таймера ядра
+ */
+typedef struct timer_notify {
+    enum timer_notify_type type;    //! [in] тип оповещения
+    int id;                         //! [in] номер семафора или канала процесса-создателя таймера
+    union sigval value;             //! [in] значение импульса (value_int) для TIMER_NOTIFY_CHANNEL и TIMER_NOTIFY_PULSE
+} timer_notify_t;
+
+/**
+ * Параметры запуска таймера ядра
+ */
+typedef struct timer_spec {
+    uint64_t value;         //!< момент первого срабатывания, нс, 0 - остановка таймера
+    uint64_t interval;      //!< период срабатываний, нс, 0 - однократный таймер
+} timer_spec_t;
+
+#define TIMER_FLAG_ABSTIME      0x01    //!< value - абсолютное время OS_CLOCK_MONOTONIC, иначе от текущего
+
+typedef enum port_src_type {
+    PORT_SRC_CHANNEL = 1,   //!< канал процесса: непрочитанные сообщения, импульсы или ожидающие синхронные запросы
+    PORT_SRC_SYN,           //!< семафор SEMAPHORE_TYPE_PSHARED: счетчик больше 0
+    PORT_SRC_IRQ,           //!< прерывание: линия запрещается до разрешения os_irq_ctrl
+} port_src_type_t;
+
+#define PORT_EDGE       0x01    //!< [in] выдача только новых событий источника, иначе - пока источник готов
+#define PORT_IN         0x02    //!< [out] источник готов
+#define PORT_HUP        0x04    //!< [out] источник закрыт, событие выдается однократно
+
+/**
+ * Источник порта ожидания (os_port_ctl) и событие источника (os_port_wait)
+ */
+typedef struct port_event {
+    enum port_src_type type;        //! [in/out] тип источника
+    int id;                         //! [in/out] номер канала, семафора или прерывания
+    uint32_t flags;                 //! [in] PORT_EDGE, [out] PORT_IN, PORT_HUP
+    uint32_t count;                 //! [out] число событий источника после предыдущей выдачи
+    void *data;                     //! [in/out] данные пользователя, возвращаются без изменений
+} port_event_t;
+
 
 /** формат сообщения */
 typedef struct msg {
@@ -398,6 +488,35 @@ typedef struct msg {
     void *data;               //!< данные пользователя
 } msg_t;
 
+/** Часть данных сообщения, собираемого из нескольких буферов (os_sendv) */
+typedef struct msg_iov {
+    const void *base;
+    size_t len;
+} msg_iov_t;
+
+/** Заголовок кольца канала CHANNEL_SHARED_RING, разделяемого производителем и потребителем.
+    Индексы head и tail - смещения в байтах без заворачивания, позиция в области данных
+    получается по модулю size. Поля, изменяемые каждой стороной, размещены в разных
+    строках кэша. Счетчики звонков работают как счетчики быстрых семафоров (до 1),
+    в ядро обращаются только для ожидания или для пробуждения ожидающей стороны.
+*/
+typedef struct os_ring {
+    // строка потребителя
+    volatile uint32_t head;         //!< индекс чтения
+    volatile uint32_t data_wait;    //!< потребитель собирается ожидать данные
+    uint32_t __pad0[6];
+    // строка производителя
+    volatile uint32_t tail;         //!< индекс записи
+    volatile uint32_t space_wait;   //!< производитель собирается ожидать места
+    uint32_t __pad1[6];
+    atomic_t data_bell;             //!< звонок потребителю
+    atomic_t space_bell;            //!< звонок производителю
+    uint32_t size;                  //!< размер области данных, степень двойки
+    uint32_t __pad2[5];
+} os_ring_t;
+
+#define OS_RING_DATA(r)     ((uint8_t *)(r) + sizeof(os_ring_t))    //!< область данных кольца
+
 /** Локальная папка процесса.
     Система обеспечивает уникальность полного имени канала открытого в этой папке
     по отношению к другим процессам.
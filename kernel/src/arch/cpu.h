@@ -94,4 +94,9 @@ static inline int cpu_disable_core (int core_id);
 
 static inline void cpu_wait_energy_save ();
 
+/** \Brief Подсчет числа старших нулевых бит слова
+ Для val == 0 возвращает 32
+ */
+static inline unsigned int cpu_clz (uint32_t val);
+
 #endif
@@ -50,7 +50,10 @@ struct interrupt_context {
  * Установка текущего приоритета выполнения в среде исполнения, который
  * может быть вытеснен событием прерывания (приоритет текущего потока
  * в одноядерном процессоре или максимальный приоритет среди нескольких потоков исполняющихся на нескольких ядрах
- * в многоядерном процессоре)
+ * в многоядерном процессоре).
+ * Приоритет задается в шкале приоритетов ОС, прерывания с тем же или более низким приоритетом
+ * остаются ожидающими до снижения приоритета среды; приоритет потока простоя (PRIO_NUM)
+ * разрешает все прерывания, прерывания с приоритетом KPRIO_MAX не маскируются
  */
 void interrupt_set_env_priority (int priority);
 /**
@@ -8,19 +8,32 @@ void mmu_disable ();
 
 uint32_t* mmu_get_tbl ();
 void mmu_switch (uint32_t *tbl);
+void mmu_switch_asid (uint32_t *tbl, uint32_t asid);
 
 static inline void flush_tlb ();
+static inline void flush_tlb_asid (uint32_t asid);
+static inline void flush_tlb_range (uint32_t va, size_t pages);
+static inline void flush_icache ();
+static inline void flush_tlb_all ();
 
 void mmu_set_fault (uint32_t *entry);
-void mmu_set_dir (uint32_t *entry, uint32_t va, mem_attributes_t attr);
+// ng - запись не глобальная (тегируется ASID): для отображений процессов и копий записей ядра
+// в таблицах процессов, записи ядра глобальные и не дублируются в TLB по каждому ASID
+void mmu_set_dir (uint32_t *entry, uint32_t va, mem_attributes_t attr, bool ng);
 void mmu_set_pgt (uint32_t *entry, uint32_t *pgt);
-void mmu_set_pgte (uint32_t *entry, uint32_t va, mem_attributes_t attr);
+void mmu_set_pgte (uint32_t *entry, uint32_t va, mem_attributes_t attr, bool ng);
+void mmu_set_pgtes (uint32_t *entry, uint32_t va, size_t n, mem_attributes_t attr, bool ng);
+void mmu_set_lpgtes (uint32_t *entry, uint32_t va, size_t n, mem_attributes_t attr, bool ng);
+void mmu_set_pgtes_ng (uint32_t *entry, size_t n);
+void mmu_set_faults (uint32_t *entry, size_t n);
 
 const size_t mmu_dirtable_size ();
 const size_t mmu_pagetable_size ();
 const size_t mmu_page_in_dir ();
 const size_t mmu_page_size ();
 const size_t mmu_dir_size ();
+const size_t mmu_lpage_size ();
+const size_t mmu_page_in_lpage ();
 
 bool mmu_is_dir (uint32_t *entry);
 uint32_t mmu_get_base_addr_dir (uint32_t *entry);
@@ -23,6 +23,9 @@ extern "C" {
  *      Вторичные процессоры получают текущее время через глобальные статические переменные
  *      и текущие значения глобального таймера. При этом только ядро CPU_0 является ответсвенным
  *      за возможную корректировку времени срабатывания таймерного прерывания по timer_set_event.
+ *      Если модуль располагает локальными таймерами ядер (timer_core_init), то вторичные
+ *      ядра получают от них собственные прерывания диспетчеризации, время по-прежнему
+ *      подсчитывает только CPU_0.
  *
  * Модуль может быть построен на одном или нескольких аппаратных таймерах(не оговаривается)
  */
@@ -64,6 +67,29 @@ int timer_disable();
  */
 int timer_set_event(uint64_t event_time_ns);
 
+/**
+ * Установка момента следующего прерывания таймера для безтактового (tickless) режима.
+ * В отличие от timer_set_event момент может быть перенесен как раньше, так и позже
+ * запланированного, но не далее max_ns от текущего времени, чтобы не нарушать подсчет
+ * системного времени. Прошедшее или слишком близкое время заменяется минимально возможным.
+ * Следующее прерывание по умолчанию снова будет периодическим (см. timer_event).
+ * Предполагается, что в SMP режиме метод работает только для CPU_0
+ * в защищенном от прерывания коде.
+ */
+int timer_set_next_event(uint64_t event_time_ns, uint64_t max_ns);
+
+/**
+ * Получение запланированного момента следующего прерывания таймера в нс
+ */
+uint64_t timer_get_event();
+
+/**
+ * Назначение страницы времени, в которой модуль публикует значения системного и реального
+ * времени при каждом их обновлении, а также адрес и параметры пересчета аппаратного счетчика
+ * для получения времени процессами без системного вызова (см. struct os_time_page)
+ */
+void timer_set_time_page(struct os_time_page *page);
+
 /**
  * Обратная связь с внешним кодом, обработчик события таймерного прерывания для модуля.
  * Должен обеспечивать обновление системного времени.
@@ -72,6 +98,26 @@ int timer_set_event(uint64_t event_time_ns);
  */
 void timer_event();
 
+/**
+ * Запуск локального таймера текущего (вторичного) ядра с периодом, заданным timer_init.
+ * Прерывание локального таймера имеет тот же номер SCHEDULER_IRQ_ID на каждом ядре.
+ * Возвращает ERR, если у модуля нет локальных таймеров, тогда тик вторичным ядрам
+ * передает CPU_0.
+ */
+int timer_core_init();
+
+/**
+ * Установка момента следующего прерывания локального таймера текущего ядра,
+ * аналогично timer_set_next_event, но без влияния на подсчет времени
+ */
+int timer_core_set_next_event(uint64_t event_time_ns, uint64_t max_ns);
+
+/**
+ * Обработчик прерывания локального таймера текущего ядра: сброс события и
+ * установка следующего периодического прерывания
+ */
+void timer_core_event();
+
 /**
  * Обновление значения системного времени для обеспечения подсчета в условиях
  * аппаратных ограничений таймера.
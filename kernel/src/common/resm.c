@@ -7,6 +7,13 @@
 #include <string.h>
 
 
+// Ячейка таблицы ресурсов (RES_ID_GEN_STRATEGY_TABLE)
+struct res_slot {
+    struct rb_node *node;       // размещенный ресурс, NULL - ячейка свободна
+    int gen;                    // поколение, увеличивается при освобождении ячейки
+    int next_free;              // следующая свободная ячейка, 0 - последняя
+};
+
 typedef struct inner_res_container {
     kobject_lock_t lock;
     int finalizing;
@@ -18,6 +25,11 @@ typedef struct inner_res_container {
     struct rb_tree objects;
     struct rb_tree inverted_free_ids[2];
     int current_free_subspace;
+
+    struct res_slot *slots;     // плотная таблица ресурсов по индексу, ячейка 0 не используется
+    int slots_num;              // число ячеек таблицы, растет по мере заполнения до numlimit + 1
+    int free_slot;              // первая свободная ячейка, 0 - таблица заполнена
+    int idx_bits;               // число разрядов индекса в номере ресурса
 } inner_res_container_t;
 
 typedef struct res_node_header {
@@ -29,6 +41,78 @@ typedef struct res_node_header {
 
 #define RES_NODE_BASE_SIZE    (sizeof(struct rb_node) + sizeof(struct res_node_header))
 
+#define RES_SLOT_IDX(id, bits)      ((id) & ((1 << (bits)) - 1))
+#define RES_SLOT_GEN_MASK(bits)     ((1 << (31 - (bits))) - 1)   // номер ресурса остается положительным
+#define RES_SLOTS_NUM_MIN           (16)    // начальное число ячеек таблицы
+
+// Увеличение таблицы вдвое (не более numlimit + 1 ячеек), новые ячейки становятся свободными.
+// Выполняется при инициализации и под блокировкой контейнера при заполнении таблицы
+static int table_grow (inner_res_container_t *container)
+{
+    int num = (container->slots_num == 0) ? RES_SLOTS_NUM_MIN : (container->slots_num << 1);
+    if (num > container->numlimit + 1) {
+        num = container->numlimit + 1;
+    }
+    if (num <= container->slots_num) {
+        return ERR_BUSY;
+    }
+    struct res_slot *slots = (struct res_slot *) kmalloc(num * sizeof(struct res_slot));
+    if (slots == NULL) {
+        return ERR_NO_MEM;
+    }
+    int first = (container->slots_num == 0) ? 1 : container->slots_num;
+    if (container->slots != NULL) {
+        memcpy(slots, container->slots, container->slots_num * sizeof(struct res_slot));
+        kfree(container->slots);
+    } else {
+        slots[0].node = NULL;
+        slots[0].gen = 0;
+        slots[0].next_free = 0;
+    }
+    for (int i = first; i < num; i++) {
+        slots[i].node = NULL;
+        slots[i].gen = 0;
+        slots[i].next_free = (i < num - 1) ? i + 1 : container->free_slot;
+    }
+    container->slots = slots;
+    container->slots_num = num;
+    container->free_slot = first;
+    return OK;
+}
+
+static int table_init (inner_res_container_t *container)
+{
+    int bits = 1;
+    while ((1 << bits) <= container->numlimit) {
+        bits++;
+    }
+    if (bits > 24) {
+        // поколений должно быть достаточно, чтобы повтор номера был практически исключен
+        return ERR_ILLEGAL_ARGS;
+    }
+    container->idx_bits = bits;
+    return table_grow(container);
+}
+
+// Выборка ресурса по индексу ячейки с проверкой поколения, выполняется под блокировкой контейнера
+static inline struct rb_node *table_search (inner_res_container_t *container, int id)
+{
+    int idx = RES_SLOT_IDX(id, container->idx_bits);
+    if ((id <= 0) || (idx == 0) || (idx >= container->slots_num)) {
+        return NULL;
+    }
+    struct rb_node *node = container->slots[idx].node;
+    return ((node != NULL) && (node->key == id)) ? node : NULL;
+}
+
+static inline struct rb_node *res_search (inner_res_container_t *container, int id)
+{
+    if (container->gen_strategy == RES_ID_GEN_STRATEGY_TABLE) {
+        return table_search(container, id);
+    }
+    return rb_tree_search(&container->objects, id);
+}
+
 int resm_container_init (res_container_t *c, int numlimit, size_t memlimit, gen_strategy_t gen_strategy)
 {
 
@@ -42,6 +126,10 @@ int resm_container_init (res_container_t *c, int numlimit, size_t memlimit, gen_
     container->memused = 0;
     container->gen_strategy = gen_strategy;
     container->finalizing = 0;
+    container->slots = NULL;
+    container->slots_num = 0;
+    container->free_slot = 0;
+    container->idx_bits = 0;
 
     kobject_lock_init(&container->lock);
     rb_tree_init(&container->objects);
@@ -49,6 +137,16 @@ int resm_container_init (res_container_t *c, int numlimit, size_t memlimit, gen_
     rb_tree_init(&container->inverted_free_ids[1]);
     container->current_free_subspace = 0;
 
+    if (gen_strategy == RES_ID_GEN_STRATEGY_TABLE) {
+        int res = table_init(container);
+        if (res != OK) {
+            kfree(container);
+            return res;
+        }
+        *c = container;
+        return OK;
+    }
+
     struct rb_node *node = (struct rb_node *) kmalloc(sizeof(struct rb_node));
     rb_node_init(node);
     rb_node_set_key(node, 1);
@@ -67,9 +165,12 @@ int resm_create_and_lock (res_container_t *c, int id, size_t len, struct res_hea
     size_t memlen;
     if ((container == NULL) || (hdr == NULL))
         return ERR_ILLEGAL_ARGS;
+    // заданный номер допустим только без генерации, в частности для RES_ID_GEN_STRATEGY_TABLE
+    // ячейка таблицы выбирается только из списка свободных
     if ((id != RES_ID_GENERATE) && (container->gen_strategy != RES_ID_GEN_STRATEGY_NOGEN)) {
         return ERR_ILLEGAL_ARGS;
     }
+    int slot = 0;
     if(container->finalizing) {
         // рекурсивный вызов из res_free недопустим
         syshalt(SYSHALT_RESM_RECURSION_ERROR);
@@ -81,7 +182,19 @@ int resm_create_and_lock (res_container_t *c, int id, size_t len, struct res_hea
         return ERR_NO_MEM;
     }
 
-    if (id == RES_ID_GENERATE) {
+    if ((id == RES_ID_GENERATE) && (container->gen_strategy == RES_ID_GEN_STRATEGY_TABLE)) {
+        // первая свободная ячейка с текущим поколением, заполненная таблица увеличивается
+        if (container->free_slot == 0) {
+            int res = table_grow(container);
+            if (res != OK) {
+                kobject_unlock(&container->lock);
+                return res;
+            }
+        }
+        slot = container->free_slot;
+        id = (container->slots[slot].gen << container->idx_bits) | slot;
+        container->free_slot = container->slots[slot].next_free;
+    } else if (id == RES_ID_GENERATE) {
         // динамический захват любого свободного номера,
         // выполняем отсечением свободного диапазона справа,
         // так как не нужно удалять узел из памяти и выполнять
@@ -126,6 +239,9 @@ int resm_create_and_lock (res_container_t *c, int id, size_t len, struct res_hea
     inner_hdr->user_header.type = 0;
     *((size_t *) &inner_hdr->user_header.datalen) = len;
     rb_tree_insert(&container->objects, node);
+    if (slot != 0) {
+        container->slots[slot].node = node;
+    }
     *hdr = &inner_hdr->user_header;
     kobject_unlock_inherit(&container->lock, &inner_hdr->lock);
     return id;
@@ -147,7 +263,7 @@ int resm_search_and_lock (res_container_t *c, int id, struct res_header **hdr)
 
     while (1) {
         kobject_lock(&container->lock);
-        struct rb_node *node = rb_tree_search(&container->objects, id);
+        struct rb_node *node = res_search(container, id);
         if (node == NULL) {
             kobject_unlock(&container->lock);
             return res;
@@ -216,7 +332,14 @@ static int _res_remove (res_container_t *c, struct res_header *hdr, int locked)
     }
     rb_tree_remove(&container->objects, node);
     int target_free_subspace = container->current_free_subspace ^ 1;
-    if (container->gen_strategy != RES_ID_GEN_STRATEGY_NOGEN) {
+    if (container->gen_strategy == RES_ID_GEN_STRATEGY_TABLE) {
+        // ячейка возвращается в начало списка свободных со следующим поколением
+        int idx = RES_SLOT_IDX(node->key, container->idx_bits);
+        container->slots[idx].node = NULL;
+        container->slots[idx].gen = (container->slots[idx].gen + 1) & RES_SLOT_GEN_MASK(container->idx_bits);
+        container->slots[idx].next_free = container->free_slot;
+        container->free_slot = idx;
+    } else if (container->gen_strategy != RES_ID_GEN_STRATEGY_NOGEN) {
         // необходимо вернуть номер в хранилище свободных номеров
         struct rb_node *fnode = rb_tree_search_neareqless(
                 &container->inverted_free_ids[target_free_subspace], inverted_id);
@@ -321,6 +444,9 @@ int resm_container_free (res_container_t *c, void (*res_free) (res_container_t *
     cnt = rb_tree_get_nodes_count(&container->objects);
     free_container(c, rb_tree_get_min(&container->objects), res_free);
     kobject_unlock(&container->lock);
+    if (container->slots != NULL) {
+        kfree(container->slots);
+    }
     kfree(container);
     *c = NULL;
     return cnt;
@@ -12,7 +12,7 @@
 #define RES_ID_GENERATE                     0
 
 typedef enum gen_strategy {
-    RES_ID_GEN_STRATEGY_NOGEN,      //!< Режим без генерации номеров, только захват    RES_ID_GEN_STRATEGY_INC_AGING   //!< Режим генерации "инкрементный,освободился-не занимается пока нет переполнения"} gen_strategy_t;
+    RES_ID_GEN_STRATEGY_NOGEN,      //!< Режим без генерации номеров, только захват    RES_ID_GEN_STRATEGY_INC_AGING,  //!< Режим генерации "инкрементный,освободился-не занимается пока нет переполнения"    RES_ID_GEN_STRATEGY_TABLE       //!< Режим генерации "индекс в таблице с поколением", поиск без обхода дерева} gen_strategy_t;
 
 typedef struct res_header {
     void *ref;
@@ -31,6 +31,11 @@ typedef void * res_container_t;
  *  - с динамической генерацией номеров ресурсов;
  *  - без генерации номеров, то есть ориентированные на захват заданных номеров.
  * В результате успешной инициализации контейнера обновляется значение его идентификатора res_container_t.
+ * Для стратегии RES_ID_GEN_STRATEGY_TABLE номер ресурса составляется из индекса ячейки плотной таблицы
+ * [1, numlimit] в младших разрядах и номера поколения ячейки в старших. Освободившаяся ячейка занимается
+ * повторно с новым поколением, поэтому устаревший номер не находит новый ресурс, а поиск сводится
+ * к выборке ячейки по индексу и сравнению номера. Таблица выделяется небольшой и увеличивается вдвое
+ * по мере заполнения, не превышая numlimit ячеек.
  *
  * @param container         - идентификатор контейнера
  * @param numlimit          - максимальное число размещенных ресурсов в контейнере
@@ -5,6 +5,238 @@
 #include "syn\ksyn.h"
 #include "thread.h"
 
+#ifdef BUILD_KEVENT_WHEEL
+
+#define WHEEL_MASK      (KEVENT_WHEEL_SIZE - 1)
+#define WHEEL_RANGE     (1ULL << (KEVENT_WHEEL_BITS * KEVENT_WHEEL_LEVELS)) // диапазон колеса, тактов
+
+static struct kevent *wheel[KEVENT_WHEEL_LEVELS * KEVENT_WHEEL_SIZE]; // списки событий слотов
+static uint64_t wheel_map[KEVENT_WHEEL_LEVELS];    // карты непустых слотов по уровням
+static uint64_t wheel_tick;                         // текущий такт колеса
+static kobject_lock_t elock;
+
+static inline int ctz32 (uint32_t val)
+{
+    return 31 - cpu_clz(val & -val);
+}
+
+// Расстояние от слота from до ближайшего непустого слота уровня по кругу, -1 - все слоты пустые
+static int wheel_map_next (uint64_t map, int from)
+{
+    if (map == 0) {
+        return -1;
+    }
+    if (from != 0) {
+        map = (map >> from) | (map << (KEVENT_WHEEL_SIZE - from));
+    }
+    if ((uint32_t)map != 0) {
+        return ctz32((uint32_t)map);
+    }
+    return 32 + ctz32((uint32_t)(map >> 32));
+}
+
+static inline int wheel_empty ()
+{
+    uint64_t map = 0;
+    for (int level = 0; level < KEVENT_WHEEL_LEVELS; level++) {
+        map |= wheel_map[level];
+    }
+    return (map == 0);
+}
+
+// Размещение события в слоте по его времени относительно текущего такта колеса:
+// на уровне 0 - точно по такту, на старших - в слоте, который будет перенесен
+// на младший уровень не позже наступления события
+static void wheel_add (struct kevent *evt)
+{
+    uint64_t tick = evt->time >> KEVENT_WHEEL_TICK_SHIFT;
+    uint64_t delta;
+    int level = 0, idx;
+
+    if (tick < wheel_tick) {
+        tick = wheel_tick;  // событие уже наступило
+    }
+    delta = tick - wheel_tick;
+    if (delta >= WHEEL_RANGE) {
+        // за пределами диапазона, будет повторно размещено при переносе
+        delta = WHEEL_RANGE - 1;
+        tick = wheel_tick + delta;
+    }
+    while (delta >= KEVENT_WHEEL_SIZE) {
+        delta >>= KEVENT_WHEEL_BITS;
+        level++;
+    }
+    idx = (tick >> (level * KEVENT_WHEEL_BITS)) & WHEEL_MASK;
+    evt->head = &wheel[level * KEVENT_WHEEL_SIZE + idx];
+    evt->prev = NULL;
+    evt->next = *evt->head;
+    if (evt->next != NULL) {
+        evt->next->prev = evt;
+    }
+    *evt->head = evt;
+    wheel_map[level] |= 1ULL << idx;
+}
+
+static void wheel_del (struct kevent *evt)
+{
+    if (evt->prev != NULL) {
+        evt->prev->next = evt->next;
+    } else {
+        *evt->head = evt->next;
+    }
+    if (evt->next != NULL) {
+        evt->next->prev = evt->prev;
+    }
+    if (*evt->head == NULL) {
+        int slot = evt->head - wheel;
+        wheel_map[slot >> KEVENT_WHEEL_BITS] &= ~(1ULL << (slot & WHEEL_MASK));
+    }
+    evt->head = NULL;
+}
+
+// Перенос событий старших уровней при переходе такта уровня 0 через начало оборота
+static void wheel_cascade ()
+{
+    for (int level = 1; level < KEVENT_WHEEL_LEVELS; level++) {
+        int idx = (wheel_tick >> (level * KEVENT_WHEEL_BITS)) & WHEEL_MASK;
+        struct kevent *evt = wheel[level * KEVENT_WHEEL_SIZE + idx], *next;
+
+        wheel[level * KEVENT_WHEEL_SIZE + idx] = NULL;
+        wheel_map[level] &= ~(1ULL << idx);
+        for (; evt != NULL; evt = next) {
+            next = evt->next;
+            wheel_add(evt);
+        }
+        if (idx != 0) {
+            break;
+        }
+    }
+}
+
+// Продвижение колеса в направлении такта tick до ближайшего непустого слота уровня 0
+// или начала следующего оборота. Слот текущего такта должен быть пуст
+static void wheel_step (uint64_t tick)
+{
+    uint64_t next = (wheel_tick | WHEEL_MASK) + 1;
+    int d = wheel_map_next(wheel_map[0], (wheel_tick + 1) & WHEEL_MASK);
+
+    if ((d >= 0) && (wheel_tick + 1 + d < next)) {
+        next = wheel_tick + 1 + d;
+    }
+    if ((next > tick) || wheel_empty()) {
+        next = tick;
+    }
+    wheel_tick = next;
+    if ((wheel_tick & WHEEL_MASK) == 0) {
+        wheel_cascade();
+    }
+}
+
+void kevent_init() {
+    for (int i = 0; i < KEVENT_WHEEL_LEVELS * KEVENT_WHEEL_SIZE; i++) {
+        wheel[i] = NULL;
+    }
+    for (int level = 0; level < KEVENT_WHEEL_LEVELS; level++) {
+        wheel_map[level] = 0;
+    }
+    wheel_tick = systime() >> KEVENT_WHEEL_TICK_SHIFT;
+    kobject_lock_init(&elock);
+}
+
+void kevent_store_lock() {
+    kobject_lock(&elock);
+}
+
+void kevent_store_unlock() {
+    kobject_unlock(&elock);
+}
+
+void *kevent_insert(uint64_t event_time_ns, struct thread *thr) {
+    struct kevent *evt = &thr->evt;
+    if (evt->head != NULL) {
+        wheel_del(evt);
+    }
+    evt->time = event_time_ns;
+    evt->thr = thr;
+    wheel_add(evt);
+    return evt;
+}
+
+/**
+ * Отмена уже выбранного по kevent_fetch события допустима и ничего не делает
+ */
+void kevent_cancel_locked(void *e) {
+    if(e == NULL) {
+        return;
+    }
+    if (((struct kevent *)e)->head != NULL) {
+        wheel_del((struct kevent *)e);
+    }
+}
+
+void kevent_cancel(void *e) {
+    kevent_store_lock();
+    kevent_cancel_locked(e);
+    kevent_store_unlock();
+}
+
+int kevent_get_time(uint64_t *time) {
+    uint64_t t = UINT64_MAX, tick;
+    struct kevent *evt;
+    int level, d, found = -1;
+
+    // уровень 0 - точное время по событиям ближайшего непустого слота
+    d = wheel_map_next(wheel_map[0], wheel_tick & WHEEL_MASK);
+    if (d >= 0) {
+        evt = wheel[(wheel_tick + d) & WHEEL_MASK];
+        for (; evt != NULL; evt = evt->next) {
+            if (evt->time < t) {
+                t = evt->time;
+            }
+        }
+        found = 0;
+    }
+    // старшие уровни - время переноса ближайшего непустого слота, слот текущего
+    // индекса уровня соответствует следующему обороту уровня
+    for (level = 1; level < KEVENT_WHEEL_LEVELS; level++) {
+        tick = wheel_tick >> (level * KEVENT_WHEEL_BITS);
+        d = wheel_map_next(wheel_map[level], (tick + 1) & WHEEL_MASK);
+        if (d >= 0) {
+            tick = (tick + 1 + d) << (level * KEVENT_WHEEL_BITS);
+            if ((tick << KEVENT_WHEEL_TICK_SHIFT) < t) {
+                t = tick << KEVENT_WHEEL_TICK_SHIFT;
+            }
+            found = 0;
+        }
+    }
+    if (found == 0) {
+        *time = t;
+    }
+    return found;
+}
+
+struct thread *kevent_fetch() {
+    uint64_t now = systime();
+    uint64_t tick = now >> KEVENT_WHEEL_TICK_SHIFT;
+    struct kevent *evt;
+
+    while (1) {
+        // в слоте текущего такта могут быть и события, время которых еще не наступило
+        for (evt = wheel[wheel_tick & WHEEL_MASK]; evt != NULL; evt = evt->next) {
+            if (evt->time <= now) {
+                wheel_del(evt);
+                return evt->thr;
+            }
+        }
+        if (wheel_tick >= tick) {
+            return NULL;
+        }
+        wheel_step(tick);
+    }
+}
+
+#else
+
 struct kevent {
     struct kevent *prev;    // делаем замкнутый список чтобы иметь доступ к началу и концу
     struct kevent *next;    // организуем таким образом FIFO событий по одной метке времени
@@ -86,12 +318,11 @@ void *kevent_insert(uint64_t event_time_ns, struct thread *thr) {
  * в момент вызова. Внешний код должен гарантировать, что после выборки события по kevent_fetch
  * метод kevent_cancel по выбранному событию не будет вызван.
  */
-void kevent_cancel(void *e) {
+void kevent_cancel_locked(void *e) {
     if(e == NULL) {
         return;
     }
     struct kevent *evt = (struct kevent *)e;
-    kevent_store_lock();
     if(current == evt) {
         // специальный случай, когда событие уже наступило но не выбрано и
         // следующее на очереди именно указанное событие, его тоже нужно отменить
@@ -120,12 +351,17 @@ void kevent_cancel(void *e) {
         }
     }
     kfree(e);
+}
+
+void kevent_cancel(void *e) {
+    kevent_store_lock();
+    kevent_cancel_locked(e);
     kevent_store_unlock();
 }
 
 int kevent_get_time(uint64_t *time) {
-    if(current != NULL) {
-        *time = rb_node64_get_key(current->node);
+    if(time_node != NULL) {
+        *time = rb_node64_get_key(time_node);
         return 0;
     }
     return -1;
@@ -139,7 +375,6 @@ int kevent_get_time(uint64_t *time) {
  */
 
 struct thread *kevent_fetch() {
-    kevent_store_lock();
     if(time_node == NULL) {
         // дерево событий в этом случае всегда пустое
         return NULL;
@@ -165,7 +400,8 @@ struct thread *kevent_fetch() {
             current = next;
         }
     }
-    kevent_store_unlock();
     return thr;
 }
 
+#endif
+
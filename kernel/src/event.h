@@ -9,10 +9,33 @@
  * Для оптимизации применяется алгоритм красно-черного дерева в модификации 64-х битного
  * ключа, что позволяет хранить события по точным значениям системного 64-х битного времени в нс.
  *
+ * С BUILD_KEVENT_WHEEL хранилище реализовано иерархическим колесом таймеров:
+ * KEVENT_WHEEL_LEVELS уровней по KEVENT_WHEEL_SIZE слотов, слот уровня 0 соответствует
+ * одному такту колеса (2^KEVENT_WHEEL_TICK_SHIFT нс), слот каждого следующего уровня -
+ * KEVENT_WHEEL_SIZE слотам предыдущего. События хранятся в структуре потока (struct thread.evt),
+ * поэтому вставка и отмена выполняются за O(1) без выделения памяти в куче ядра.
+ * По мере хода времени события старших уровней переносятся на младшие, точное время
+ * события сохраняется и событие не наступает раньше срока.
+ *
  * Модуль не защищен от параллельного вызова методов,
  * предполагается внешшняя защита диспетчером задач
  */
 
+#ifdef BUILD_KEVENT_WHEEL
+#define KEVENT_WHEEL_BITS       6
+#define KEVENT_WHEEL_SIZE       (1 << KEVENT_WHEEL_BITS)
+#define KEVENT_WHEEL_LEVELS     4
+#define KEVENT_WHEEL_TICK_SHIFT 20      //!< такт колеса 2^20 нс (~1 мс), диапазон 2^44 нс (~4.9 ч)
+
+struct kevent {
+    struct kevent *prev;
+    struct kevent *next;
+    struct kevent **head;   //!< слот колеса, NULL - событие не находится в хранилище
+    uint64_t time;          //!< точное время наступления события
+    struct thread *thr;     //!< суть события, источник всегда поток
+};
+#endif
+
 void kevent_init();
 
 /**
@@ -25,7 +48,9 @@ void kevent_store_lock();
 void kevent_store_unlock();
 
 /**
- * Добавление нового события в хранилище с сортировкой по целевому времени
+ * Добавление нового события в хранилище с сортировкой по целевому времени.
+ * Для колеса таймеров у потока может быть только одно событие в хранилище
+ * (используется struct thread.evt)
  */
 void *kevent_insert(uint64_t event_time_ns, struct thread *thr);
 /**
@@ -33,13 +58,19 @@ void *kevent_insert(uint64_t event_time_ns, struct thread *thr);
  */
 void kevent_cancel(void *evt);
 /**
- * Получение времени ближайшего события, если оно имеется в хранилище, то есть оно не пустое
+ * То же, что kevent_cancel, вызывается под kevent_store_lock
+ */
+void kevent_cancel_locked(void *evt);
+/**
+ * Получение времени ближайшего события, если оно имеется в хранилище, то есть оно не пустое.
+ * Для колеса таймеров при ближайшем событии на старшем уровне возвращается время его переноса
+ * на младший уровень (не позже времени события)
  */
 int kevent_get_time(uint64_t *time);
 /**
  * Выборка ближайшего следующего события, которое наступило в соответствии с systime().
  * Объект удаляется из хранилища.
- * Операция имеет защиту по kevent_store_lock
+ * Вызывается под kevent_store_lock
  */
 struct thread *kevent_fetch();
 
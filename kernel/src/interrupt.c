@@ -3,6 +3,7 @@
 #include <arch.h>
 #include "sched.h"
 #include "interrupt.h"
+#include "port.h"
 #include <common\log.h>
 
 
@@ -63,6 +64,15 @@ void interrupt_handler (struct cpu_context *ctx)
             // метод interrupt_handle_end должен быть выполнен после завершения
             // потока обработки прерывания
             break;
+        case INTERRUPT_PORT:
+            // линия запрещается до обслуживания устройства потоком порта
+            if(port_irq(info)) {
+                // разбужен поток порта, переключаемся по плану без возврата,
+                // контекст прерванного потока сохранен по ссылке
+                interrupt_handle_end(info->id);
+                sched_switch(SCHED_SWITCH_NO_RETURN);
+            }
+            break;
         }
         // если сюда пришли, значит ссылка на контекст больше не нужна, нужно ее удалить
         if(prev != NULL) {
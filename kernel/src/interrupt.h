@@ -3,7 +3,8 @@
 
 enum interrupt_type {
     INTERRUPT_KERNEL_FUNC,
-    INTERRUPT_THREAD
+    INTERRUPT_THREAD,
+    INTERRUPT_PORT          // событие порта ожидания, обработчик - связь порта с прерыванием
 };
 
 #endif
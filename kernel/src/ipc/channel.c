@@ -11,6 +11,10 @@
 #include "common/error.h"
 #include "syn/ksyn.h"
 #include "pathname.h"
+#include "msg.h"
+#include "ring.h"
+#include "mcast.h"
+#include "port.h"
 
 struct channel* lock_channel (struct process *proc, int id)
 {
@@ -94,6 +98,9 @@ static struct channel * create_channel (void *buf, size_t size, unsigned long fl
     channel->buf.head = channel->buf.tail = channel->buf.data;
     channel->pathname = pathname;
     channel->msgs = 0;
+    channel->unread = 0;
+    memset(channel->lanes, 0, sizeof(channel->lanes));
+    channel->ports = NULL;
     channel->owner = proc;
     channel->zombie = false;
     channel->type = type;
@@ -101,6 +108,12 @@ static struct channel * create_channel (void *buf, size_t size, unsigned long fl
     channel->id = id;
     channel->receive.head = channel->receive.tail = NULL;
     channel->send.head = channel->send.tail = NULL;
+    channel->msg_receive.head = channel->msg_receive.tail = NULL;
+    channel->msg_send.head = channel->msg_send.tail = NULL;
+    channel->msg_reply.head = channel->msg_reply.tail = NULL;
+    channel->ring.producer = NULL;
+    channel->pulse.head = channel->pulse.count = 0;
+    channel->pulse.wait.head = channel->pulse.wait.tail = NULL;
     channel->pathname_use = 0;
     channel->connecting.open.head = channel->connecting.open.tail = NULL;
     channel->connecting.wait.head = channel->connecting.wait.tail = NULL;
@@ -113,7 +126,7 @@ static struct channel * create_channel (void *buf, size_t size, unsigned long fl
 }
 
 
-static void* create_buf (struct process *proc, size_t size)
+static void* create_buf (struct process *proc, size_t size, unsigned long flags)
 {
 //    if (proc == &kproc) {
 //        //    if (kernel) {
@@ -127,7 +140,7 @@ static void* create_buf (struct process *proc, size_t size)
 
     const mem_attributes_t attr = {
         .os_access = MEM_ACCESS_RW,
-        .process_access = MEM_ACCESS_RO,
+        .process_access = (flags & CHANNEL_SHARED_RING) ? MEM_ACCESS_RW : MEM_ACCESS_RO,
         .shared = MEM_SHARED_OFF,
         .type = MEM_TYPE_NORMAL,
         .exec = MEM_EXEC_NEVER,
@@ -161,7 +174,19 @@ int open_channel (struct thread *thr, channel_type_t type, char *pathname, size_
             return ERROR(ERR_IPC_PATHNAME);
     }
 
-    void *adr = create_buf(caller, size);
+    if ((flags & CHANNEL_SHARED_RING) && (flags & CHANNEL_MULTICAST)) {
+        delete_pathname(pathname_ns);
+        return ERROR(ERR_ILLEGAL_ARGS);
+    }
+    if (flags & CHANNEL_SHARED_RING) {
+        if (size < RING_SIZE_MIN) {
+            delete_pathname(pathname_ns);
+            return ERROR(ERR_ILLEGAL_ARGS);
+        }
+        size += sizeof(os_ring_t);
+    }
+
+    void *adr = create_buf(caller, size, flags);
     if (!adr) {
         delete_pathname(pathname_ns);
         return ERROR(ERR_NO_MEM);
@@ -174,6 +199,11 @@ int open_channel (struct thread *thr, channel_type_t type, char *pathname, size_
         return ERROR(ERR_NO_MEM);
     }
 
+    if (flags & CHANNEL_SHARED_RING)
+        ring_init(channel);
+    if (flags & CHANNEL_MULTICAST)
+        mcast_init(channel);
+
     unlock_pathname(pathname_ns);
     unlock_channel(channel);
 
@@ -271,7 +301,10 @@ void zombie_channel (struct channel *channel)
         return;
     channel->zombie = true;
     receivers_unblock(channel);
+    msg_sync_unblock(channel);
+    ring_unblock(channel);
     wait_connecting_unblock(channel);
+    port_source_close(&channel->ports);
 }
 
 
@@ -428,7 +461,7 @@ int channel_connection_complete (struct thread *thr, int chid, enum connection_c
             break;
 
         connect(channel, connection);
-        if (channel->flags | CHANNEL_SINGLE_CONNECTION)
+        if (channel->flags & CHANNEL_SINGLE_CONNECTION)
             clr_connecting_list(channel);
         break;
     case CONNECTION_DENY:
@@ -2,10 +2,12 @@
 #define CHANNEL_H_
 
 #include <os_types.h>
+#include <config.h>
 #include <syn/ksyn.h>
 #include <rbtree.h>
 #include "common/resm.h"
 #include <syn/mutex.h>
+#include <syn/sem.h>
 #include "connection.h"
 #include "pathname.h"
 
@@ -17,6 +19,12 @@ struct rbuf {
     uint8_t *data;
 };
 
+/** Очередь потоков синхронного обмена */
+struct msg_sync_list {
+    struct thread *head;
+    struct thread *tail;
+};
+
 /** Описатель канала */
 struct channel {
     struct process *owner;
@@ -31,7 +39,10 @@ struct channel {
     int pathname_use;
     struct rb_tree connections;
     int msgs;
+    int unread;                         // сообщения, еще не выданные получателям
+    int lanes[MSG_PRIO_LANES];          // невыданные сообщения по уровням приоритета отправителей (CHANNEL_PRIO_LANES)
     struct rbuf buf;
+    struct port_link *ports;            // наблюдающие порты ожидания, изменяется только модулем port
 
     struct {
         struct thread *head;
@@ -41,6 +52,31 @@ struct channel {
         struct thread *head;
         struct thread *tail;
     } send;
+    // синхронный обмен (os_msg_send_recv/os_msg_receive/os_msg_reply),
+    // очереди всех каналов защищены общим спинлоком sync_lock модуля msg (захватывается
+    // после kevent_store_lock), так как изменяются также диспетчером по таймауту
+    struct msg_sync_list msg_receive;   // получатели, ожидающие запроса
+    struct msg_sync_list msg_send;      // отправители, ожидающие получателя
+    struct msg_sync_list msg_reply;     // отправители, ожидающие ответа
+    // кольцо, разделяемое с производителем (CHANNEL_SHARED_RING),
+    // счетчики семафоров звонков размещены в заголовке кольца
+    struct {
+        struct connection *producer;
+        semaphore_t data;               // звонок потребителю
+        semaphore_t space;              // звонок производителю
+    } ring;
+    // импульсы (os_pulse), ожидающие приема импульсы с одинаковым кодом объединяются
+    struct {
+        pulse_t q[MSG_PULSES];
+        int head;
+        int count;
+        struct msg_sync_list wait;      // получатели, ожидающие импульса
+    } pulse;
+    // рассылка (CHANNEL_MULTICAST), номера хранимых сообщений [head_seq, tail_seq)
+    struct {
+        uint32_t head_seq;
+        uint32_t tail_seq;
+    } mcast;
     struct {
         // потоки ожидающие установки соединения (os_channel_wait_connection)
         struct {
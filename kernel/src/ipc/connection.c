@@ -8,6 +8,8 @@
 #include "mem/kmem.h"
 #include "ipc/msg.h"
 #include "channel.h"
+#include "ring.h"
+#include "mcast.h"
 #include "common/log.h"
 #include <os.h>
 #include "common/error.h"
@@ -112,6 +114,14 @@ static void delete_connection (struct connection *connection)
 }
 
 
+/* Буфер канала разделяется с процессом соединения, кроме кольца (отображается в ring_attach)
+ * и собственного канала процесса, буфер которого ему уже доступен */
+static inline bool share_buf (struct channel *channel, struct process *proc)
+{
+    return !(channel->flags & CHANNEL_SHARED_RING) && (channel->owner != proc);
+}
+
+
 void connect (struct channel *channel, struct connection *connection)
 {
     struct rb_node *node = kmalloc(sizeof(*node));
@@ -119,6 +129,7 @@ void connect (struct channel *channel, struct connection *connection)
     rb_node_set_key(node, (size_t)connection);
     rb_tree_insert(&channel->connections, node);
     connection->channel = channel;
+    mcast_connect(channel, connection);
 }
 
 
@@ -132,7 +143,11 @@ void disconnect_low (struct connection *connection)
     kfree(node);
 
     senders_unblock(channel);
-    vm_seg_unshare(connection->owner->mmap, vm_seg_get(channel->owner->mmap, channel->buf.data));
+    ring_disconnect(channel, connection);
+    mcast_disconnect(channel, connection);
+    // буфер кольца отображен только производителю и снимается в ring_disconnect
+    if (share_buf(channel, connection->owner))
+        vm_seg_unshare(connection->owner->mmap, vm_seg_get(channel->owner->mmap, channel->buf.data));
 }
 
 
@@ -196,7 +211,8 @@ int reply_connect (struct process *proc, struct connection *connection)
 
     connect(reply_channel, reply_connection);
 
-    if (vm_seg_share(reply_connection->owner->mmap, vm_seg_get(reply_connection->channel->owner->mmap, reply_connection->channel->buf.data)) != OK) {
+    if (share_buf(reply_channel, proc) &&
+        (vm_seg_share(reply_connection->owner->mmap, vm_seg_get(reply_connection->channel->owner->mmap, reply_connection->channel->buf.data)) != OK)) {
         delete_connection(reply_connection);
         unlock_channel(reply_channel);
         return ERROR(ERR_IPC_SHARE);
@@ -249,7 +265,7 @@ int open_connection (struct thread *thr, char *pathname, uint64_t timeout, int r
     if (!channel)
         return ERROR(ERR_IPC_CHANNEL_NOTFOUND);
 
-    if (channel->flags | CHANNEL_SINGLE_CONNECTION) {
+    if (channel->flags & CHANNEL_SINGLE_CONNECTION) {
         if (channel->connections.nodes) {
             unlock_channel(channel);
             return ERROR(ERR_BUSY);
@@ -290,7 +306,8 @@ int open_connection (struct thread *thr, char *pathname, uint64_t timeout, int r
         connection->connecting = NULL;
     }
 
-    if (vm_seg_share(caller->mmap, vm_seg_get(connection->channel->owner->mmap, connection->channel->buf.data)) != OK) {
+    if (share_buf(connection->channel, caller) &&
+        (vm_seg_share(caller->mmap, vm_seg_get(connection->channel->owner->mmap, connection->channel->buf.data)) != OK)) {
         delete_connection(connection);
         return ERROR(ERR);
     }
@@ -5,6 +5,8 @@
 #include <syn/ksyn.h>
 #include "common\resm.h"
 
+struct mrec;
+
 /** данные для процедуры установки соединения */
 struct connecting {
     int err;
@@ -25,6 +27,13 @@ struct connection {
     res_header_t *hdr;
 
     struct connecting *connecting;
+
+    // курсор подписчика канала рассылки (CHANNEL_MULTICAST)
+    struct {
+        uint32_t seq;                   // номер следующего сообщения
+        uint8_t *pos;                   // его положение в буфере, действительно при seq > head_seq
+        struct mrec *held;              // выданное сообщение, освобождается следующим приемом
+    } sub;
 };
 
 struct connection* lock_connection (struct process *proc, int id);
@@ -0,0 +1,298 @@
+#include "mcast.h"
+#include "msg.h"
+#include "connection.h"
+#include "channel.h"
+#include "thread.h"
+#include "sched.h"
+#include <common/utils.h>
+#include <os.h>
+#include "common\error.h"
+
+/* Запись сообщения в буфере канала, доступна подписчикам только на чтение */
+struct mrec {
+    uint32_t size;          // размер записи с данными, кратен 8
+    uint32_t seq;           // номер сообщения
+    int refs;               // подписчики, еще не освободившие сообщение
+    int holds;              // подписчики, обрабатывающие сообщение
+    bool skip;              // пустая запись до конца буфера при переходе в начало
+    struct msg m;
+};
+
+#define MREC_HDR_SIZE       ALIGN(sizeof(struct mrec), 8)
+
+
+void mcast_init (struct channel *channel)
+{
+    channel->mcast.head_seq = channel->mcast.tail_seq = 0;
+}
+
+
+/* Положение записи, следующей за rec. Остаток буфера, в который не помещается
+ заголовок, пропускается без пустой записи */
+static uint8_t* rec_next (const struct channel * const ch, const struct mrec * const rec)
+{
+    uint8_t *next = (uint8_t *)rec + rec->size;
+    if (next + MREC_HDR_SIZE > ch->buf.data + ch->buf.size)
+        next = ch->buf.data;
+    return next;
+}
+
+/* Место для записи размера size в конце очереди, NULL - места нет */
+static uint8_t* rec_place (struct channel * const ch, const size_t size)
+{
+    uint8_t * const end = ch->buf.data + ch->buf.size;
+
+    if (!ch->msgs) {
+        ch->buf.head = ch->buf.tail = ch->buf.data;
+        return (size <= ch->buf.size) ? ch->buf.data : NULL;
+    }
+    if (ch->buf.tail > ch->buf.head) {
+        if ((size_t)(end - ch->buf.tail) >= size)
+            return ch->buf.tail;
+        return ((size_t)(ch->buf.head - ch->buf.data) >= size) ? ch->buf.data : NULL;
+    }
+    if ((ch->buf.tail < ch->buf.head) && ((size_t)(ch->buf.head - ch->buf.tail) >= size))
+        return ch->buf.tail;
+    return NULL;
+}
+
+/* Единственное копирование данных сообщения - в буфер канала */
+static void rec_push (struct channel * const ch, uint8_t * const pos, const struct msg * const msg, const size_t size)
+{
+    if (pos != ch->buf.tail) {
+        // переход в начало буфера, остаток отмечается пустой записью
+        struct mrec *skip = (struct mrec *)ch->buf.tail;
+        skip->size = ch->buf.data + ch->buf.size - ch->buf.tail;
+        skip->refs = skip->holds = 0;
+        skip->skip = true;
+        ch->msgs++;
+    }
+
+    struct mrec *rec = (struct mrec *)pos;
+    rec->size = size;
+    rec->seq = ch->mcast.tail_seq++;
+    rec->refs = ch->connections.nodes;
+    rec->holds = 0;
+    rec->skip = false;
+    rec->m.sys.ptr = NULL;
+    rec->m.size = msg->size;
+    rec->m.data = pos + MREC_HDR_SIZE;
+    memcpy(rec->m.data, msg->data, msg->size);
+    ch->msgs++;
+    ch->buf.tail = rec_next(ch, rec);
+}
+
+/* Освобождение самого старого сообщения, если его освободили все подписчики,
+ при force (вытеснение) - если оно никем не обрабатывается */
+static bool rec_pop (struct channel * const ch, const bool force)
+{
+    while (ch->msgs) {
+        struct mrec *rec = (struct mrec *)ch->buf.head;
+        if (!rec->skip) {
+            if (rec->holds || (rec->refs && !force))
+                return false;
+            ch->mcast.head_seq++;
+        }
+        ch->buf.head = rec_next(ch, rec);
+        ch->msgs--;
+        if (!rec->skip)
+            return true;
+    }
+    return false;
+}
+
+/* Освобождение начала буфера с пробуждением публикатора, ожидающего место */
+static void reclaim (struct channel * const ch)
+{
+    bool freed = false;
+    while (rec_pop(ch, false))
+        freed = true;
+    if (freed)
+        msg_sync_wake(&ch->msg_send);
+}
+
+/* Следующее сообщение подписчика. Если оно вытеснено, курсор переносится
+ на самое старое хранимое сообщение с подсчетом пропущенных */
+static struct mrec* sub_cursor (struct channel * const ch, struct connection * const con, int * const lost)
+{
+    *lost = 0;
+    if ((int32_t)(con->sub.seq - ch->mcast.head_seq) < 0) {
+        *lost = ch->mcast.head_seq - con->sub.seq;
+        con->sub.seq = ch->mcast.head_seq;
+    }
+    if (con->sub.seq == ch->mcast.tail_seq)
+        return NULL;
+
+    struct mrec *rec = (struct mrec *)((con->sub.seq == ch->mcast.head_seq) ? ch->buf.head : con->sub.pos);
+    while (rec->skip)
+        rec = (struct mrec *)rec_next(ch, rec);
+    return rec;
+}
+
+static bool sub_release (struct connection * const con)
+{
+    struct mrec *rec = con->sub.held;
+    if (!rec)
+        return false;
+    con->sub.held = NULL;
+    rec->holds--;
+    rec->refs--;
+    return true;
+}
+
+
+void mcast_connect (struct channel *channel, struct connection *connection)
+{
+    if (!(channel->flags & CHANNEL_MULTICAST))
+        return;
+    // подписчик получает сообщения, опубликованные после подключения
+    connection->sub.seq = channel->mcast.tail_seq;
+    connection->sub.pos = channel->buf.tail;
+    connection->sub.held = NULL;
+}
+
+
+void mcast_disconnect (struct channel *channel, struct connection *connection)
+{
+    struct mrec *rec;
+    int lost;
+
+    if (!(channel->flags & CHANNEL_MULTICAST))
+        return;
+    sub_release(connection);
+    // оставшиеся сообщения подписчиком уже не будут приняты
+    while ((rec = sub_cursor(channel, connection, &lost)) != NULL) {
+        rec->refs--;
+        connection->sub.seq++;
+        connection->sub.pos = rec_next(channel, rec);
+    }
+    reclaim(channel);
+}
+
+
+int mcast_publish (struct thread * const thr, const int chid, const struct msg * const msg, const uint64_t timeout)
+{
+    uint64_t deadline = TIMEOUT_INFINITY;
+
+    if (!msg || msg->sys.ptr || (msg->size && !msg->data))
+        return ERROR(ERR_ILLEGAL_ARGS);
+    if ((timeout >= TIMEOUT_MIN) && (timeout != TIMEOUT_INFINITY))
+        deadline = systime() + timeout;
+
+    const size_t size = ALIGN(MREC_HDR_SIZE + msg->size, 8);
+    bool waited = false;
+    for (;;) {
+        struct channel *channel = lock_channel(thr->proc, chid);
+        if (!channel) {
+            // канал закрыт во время ожидания места, как и в pulse_send - без ERROR
+            return waited ? ERR_DEAD : ERROR(ERR_ILLEGAL_ARGS);
+        }
+        if (channel->zombie) {
+            unlock_channel(channel);
+            return ERR_DEAD;
+        }
+        if (!(channel->flags & CHANNEL_MULTICAST)) {
+            unlock_channel(channel);
+            return ERROR(ERR_IPC_ILLEGAL_CHANNEL);
+        }
+        if (size > channel->buf.size) {
+            unlock_channel(channel);
+            return ERROR(ERR_ILLEGAL_ARGS);
+        }
+        if (!channel->connections.nodes) {
+            // подписчиков нет, сообщение никому не адресовано
+            unlock_channel(channel);
+            return OK;
+        }
+
+        uint8_t *pos;
+        while (!(pos = rec_place(channel, size)) && (channel->flags & CHANNEL_MCAST_DROP_OLDEST)) {
+            if (!rec_pop(channel, true))
+                break;
+        }
+        if (pos) {
+            rec_push(channel, pos, msg, size);
+            msg_sync_wake(&channel->msg_receive);
+            unlock_channel(channel);
+            return OK;
+        }
+
+        uint64_t now = systime();
+        if ((timeout < TIMEOUT_MIN) || ((deadline != TIMEOUT_INFINITY) && (now >= deadline))) {
+            unlock_channel(channel);
+            return ERR_TIMEOUT;
+        }
+        int res = msg_sync_wait(thr, &channel->msg_send, MSG_SEND, channel,
+                (deadline == TIMEOUT_INFINITY) ? TIMEOUT_INFINITY : deadline - now);
+        unlock_channel(channel);
+        if (res != OK)
+            return res;
+        sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+        waited = true;
+    }
+}
+
+
+int mcast_receive (struct thread * const thr, const int conid, struct msg ** const msg, const uint64_t timeout)
+{
+    uint64_t deadline = TIMEOUT_INFINITY;
+
+    if (!msg)
+        return ERROR(ERR_ILLEGAL_ARGS);
+    if ((timeout >= TIMEOUT_MIN) && (timeout != TIMEOUT_INFINITY))
+        deadline = systime() + timeout;
+
+    for (;;) {
+        struct connection *connection = lock_connection(thr->proc, conid);
+        if (!connection)
+            return ERROR(ERR_ILLEGAL_ARGS);
+        if (!connection->channel) {
+            unlock_connection(connection);
+            return ERR_DEAD;
+        }
+        struct channel *channel = lock_channel(connection->channel->owner, connection->channel->id);
+        if (!channel) {
+            unlock_connection(connection);
+            return ERR_DEAD;
+        }
+        if (!(channel->flags & CHANNEL_MULTICAST)) {
+            unlock_channel(channel);
+            unlock_connection(connection);
+            return ERROR(ERR_IPC_ILLEGAL_CHANNEL);
+        }
+
+        // повторный прием освобождает предыдущее сообщение
+        bool freed = sub_release(connection);
+        int lost = 0;
+        struct mrec *rec = channel->zombie ? NULL : sub_cursor(channel, connection, &lost);
+        if (rec) {
+            rec->holds++;
+            connection->sub.held = rec;
+            connection->sub.seq++;
+            connection->sub.pos = rec_next(channel, rec);
+            *msg = &rec->m;
+        }
+        if (freed)
+            reclaim(channel);
+
+        if (rec || channel->zombie) {
+            unlock_channel(channel);
+            unlock_connection(connection);
+            return rec ? lost : ERR_DEAD;
+        }
+
+        uint64_t now = systime();
+        if ((timeout < TIMEOUT_MIN) || ((deadline != TIMEOUT_INFINITY) && (now >= deadline))) {
+            unlock_channel(channel);
+            unlock_connection(connection);
+            return ERR_TIMEOUT;
+        }
+        int res = msg_sync_wait(thr, &channel->msg_receive, MSG_RECEIVE, channel,
+                (deadline == TIMEOUT_INFINITY) ? TIMEOUT_INFINITY : deadline - now);
+        unlock_channel(channel);
+        unlock_connection(connection);
+        if (res != OK)
+            return res;
+        sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef MCAST_H_
+#define MCAST_H_
+
+#include <os_types.h>
+#include <proc.h>
+
+/**
+ * Каналы рассылки CHANNEL_MULTICAST.
+ * Владелец канала публикует сообщения, ядро копирует их один раз в буфер канала,
+ * который отображается всем соединениям (подписчикам) только на чтение.
+ * Каждое сообщение хранит число подписчиков, еще не освободивших его, и число удерживающих его
+ * в обработке; подписчик продвигает собственный курсор (номер и положение следующего сообщения).
+ * Начало буфера освобождается, когда самое старое сообщение освобождено всеми подписчиками,
+ * при CHANNEL_MCAST_DROP_OLDEST - также вытеснением публикацией, если сообщение никем не удерживается.
+ * Ожидающие публикатор и подписчики ставятся в очереди синхронного обмена канала.
+ */
+
+struct channel;
+struct connection;
+
+/** \brief Разметка буфера открываемого канала рассылки */
+void mcast_init (struct channel *channel);
+
+/** \brief Курсор нового подписчика, вызывается при подключении под блокировкой канала и соединения */
+void mcast_connect (struct channel *channel, struct connection *connection);
+
+/** \brief Освобождение сообщений отключаемого подписчика под блокировкой канала и соединения */
+void mcast_disconnect (struct channel *channel, struct connection *connection);
+
+/** \brief Публикация сообщения владельцем канала
+ * \param chid      Номер канала рассылки
+ * \return Ошибки исполнения
+ * */
+int mcast_publish (struct thread * const thr, const int chid, const struct msg * const msg, const uint64_t timeout);
+
+/** \brief Прием следующего сообщения подписчиком
+ * \param conid     Номер соединения
+ * \param msg[out]  Сообщение в буфере канала
+ * \return Число вытесненных перед ним сообщений или ошибки исполнения
+ * */
+int mcast_receive (struct thread * const thr, const int conid, struct msg ** const msg, const uint64_t timeout);
+
+#endif /* MCAST_H_ */
@@ -2,20 +2,47 @@
 #include "connection.h"
 #include "channel.h"
 #include "mem/vm.h"
+#include "mem/kmem.h"
 #include "thread.h"
 #include "proc.h"
 #include "sched.h"
+#include "port.h"
 #include <common/utils.h>
 #include <os.h>
 #include "common\error.h"
+#include <stddef.h>
 
 struct emsg {
     size_t size;
     bool drop;
+    bool pages;         // данные переданы переносом страниц, в буфер канала не копируются
+    bool held;          // выдано пакетным приемом, находится в буфере до освобождения
+    const struct msg_iov *iov;  // данные собираются из нескольких частей (os_sendv)
+    int iovcnt;
     unsigned long flags;
+    int prio;           // приоритет потока-отправителя на момент посылки (для наследования)
+    int lane;           // уровень выдачи (CHANNEL_PRIO_LANES), 0 - наивысший
     struct msg m;
 };
 
+/* Уровень выдачи сообщения для канала с CHANNEL_PRIO_LANES: сообщения выдаются по уровням,
+ начиная с наивысшего, внутри уровня - в порядке поступления. Уровень определяется собственным
+ приоритетом отправителя, а не унаследованным, чтобы сообщения одного отправителя
+ не обгоняли друг друга при изменении наследования */
+static inline int msg_lane (const int prio)
+{
+    int lane = (prio > PRIO_MAX) ? ((prio - PRIO_MAX) >> 4) : 0;
+    return (lane < MSG_PRIO_LANES) ? lane : MSG_PRIO_LANES - 1;
+}
+
+/* Наследование приоритета клиента потоком-получателем (CHANNEL_PRIO_INHERIT),
+ 0 - снятие наследования. Выполняется без блокировки канала */
+static inline void inherit_prio (struct thread * const thr, const int prio)
+{
+    if (thr->msg_prio != prio)
+        mutex_msg_prio(thr, prio);
+}
+
 static inline sys_msg_type_t get_msg_type (struct emsg *em)
 {
     return *(sys_msg_type_t*)em->m.sys.ptr;
@@ -26,11 +53,11 @@ static inline void* get_msg_sys (struct emsg *em)
     return em->m.sys.ptr;
 }
 
-static size_t sys_size (sys_msg_type_t type)
+static size_t sys_size (struct emsg *em)
 {
-    if (!type)
+    if (!get_msg_sys(em))
         return 0;
-    switch (type) {
+    switch (get_msg_type(em)) {
     case SYS_MSG_MEM_SEND:
     case SYS_MSG_MEM_SHARE:
         return sizeof(struct sys_msg_mem);
@@ -51,17 +78,20 @@ static bool drop_msg (struct channel * const ch)
 
     struct emsg *em = (struct emsg *)ch->buf.head;
     if (em->drop) {
-        ch->buf.head += em->size;
+        // сообщения в буфере выровнены на 8 байт (align_tail)
+        ch->buf.head += ALIGN(em->size, 8);
         ch->msgs--;
         return true;
     }
     return false;
 }
 
-static struct emsg* pop_msg (struct channel * const ch)
+/* Освобождение места в буфере от обработанных сообщений в его начале,
+ возвращает false если буфер пуст */
+static bool drop_msgs (struct channel * const ch)
 {
     if (!ch->msgs)
-        return NULL;
+        return false;
 
     while (drop_msg(ch)) {
         if (ch->buf.head >= ch->buf.data + ch->buf.size)
@@ -70,12 +100,50 @@ static struct emsg* pop_msg (struct channel * const ch)
 
     if (!ch->msgs) {
         ch->buf.head = ch->buf.tail = ch->buf.data;
-        return NULL;
+        return false;
     }
+    return true;
+}
 
-    struct emsg *em = (struct emsg *)ch->buf.head;
-    em->drop = true;
-    return em;
+static inline struct emsg* next_msg (const struct channel * const ch, const struct emsg * const em)
+{
+    uint8_t *next = (uint8_t *)em + ALIGN(em->size, 8);
+    if (next >= ch->buf.data + ch->buf.size)
+        next = ch->buf.data;
+    return (struct emsg *)next;
+}
+
+/* Выбор до n еще не выданных сообщений по уровням приоритета. Сообщения, выданные
+ пакетным приемом (held), остаются в буфере до освобождения и пропускаются, обычный прием
+ помечает выданное сообщение на удаление (drop) при следующем обращении к каналу.
+ Буфер просматривается только для уровней, в которых есть невыданные сообщения */
+static int select_msgs (struct channel * const ch, struct emsg ** const ems, const int n, const bool hold)
+{
+    int cnt = 0;
+    if (!drop_msgs(ch))
+        return 0;
+
+    for (int lane = 0; (lane < MSG_PRIO_LANES) && (cnt < n); lane++) {
+        struct emsg *em = (struct emsg *)ch->buf.head;
+        for (int i = ch->msgs; (i > 0) && ch->lanes[lane] && (cnt < n); i--, em = next_msg(ch, em)) {
+            if (em->drop || em->held || (em->lane != lane))
+                continue;
+            if (hold)
+                em->held = true;
+            else
+                em->drop = true;
+            ch->unread--;
+            ch->lanes[lane]--;
+            ems[cnt++] = em;
+        }
+    }
+    return cnt;
+}
+
+static struct emsg* pop_msg (struct channel * const ch)
+{
+    struct emsg *em;
+    return select_msgs(ch, &em, 1, false) ? em : NULL;
 }
 
 static size_t copy_msg (uint8_t *buf, struct emsg * const em)
@@ -84,14 +152,24 @@ static size_t copy_msg (uint8_t *buf, struct emsg * const em)
     *em_buf = *em;
     buf += sizeof(*em);
 
-    if (get_msg_type(em)) {
-        size_t size = sys_size(get_msg_type(em));
+    if (get_msg_sys(em)) {
+        size_t size = sys_size(em);
         memcpy(buf, get_msg_sys(em), size);
+        em_buf->m.sys.ptr = buf; // копия в буфере канала, исходная может быть на стеке отправителя
         buf += size;
     }
 
-    memcpy(buf, em->m.data, em->m.size);
-    em_buf->m.data = buf;
+    if (em->iov) {
+        em_buf->m.data = buf;
+        for (int i = 0; i < em->iovcnt; i++) {
+            memcpy(buf, em->iov[i].base, em->iov[i].len);
+            buf += em->iov[i].len;
+        }
+        em_buf->iov = NULL;
+    } else if (!em->pages) {
+        memcpy(buf, em->m.data, em->m.size);
+        em_buf->m.data = buf;
+    }
 
     return em_buf->size;
 }
@@ -139,39 +217,54 @@ static size_t get_free_size (const struct channel * const ch)
 }
 
 /* буфер со сверткой нужно учитывать пустоты до сверки, если туда не влезает сообщение */
-static bool push_msg (struct channel * const ch, struct emsg * const emsg)
+static bool fit_msg (const struct channel * const ch, const size_t need_size)
 {
-    if (emsg->size > ch->buf.size) {
+    if (need_size > ch->buf.size) {
         // такое сообщение никогда не влезет
         return false;
     }
 
-    size_t need_size = emsg->size;
     if (need_size > get_free_size(ch))
         return false;
 
     if (!empty_channel(ch)) {
         size_t tail_size = (ch->buf.data + ch->buf.size) - ch->buf.tail;
         size_t head_size = ch->buf.head - ch->buf.data;
-        if (tail_size < need_size + sizeof(struct emsg)) {
-            if (head_size < need_size) {
-                return false;
-            } else {
-                push_dummy_msg(ch->buf.tail, tail_size);
-                ch->msgs++;
-                ch->buf.tail = ch->buf.data;
-            }
+        if ((tail_size < need_size + sizeof(struct emsg)) && (head_size < need_size))
+            return false;
+    }
+    return true;
+}
+
+static bool push_msg (struct channel * const ch, struct emsg * const emsg)
+{
+    if (!fit_msg(ch, emsg->size))
+        return false;
+
+    if (!empty_channel(ch)) {
+        size_t tail_size = (ch->buf.data + ch->buf.size) - ch->buf.tail;
+        if (tail_size < emsg->size + sizeof(struct emsg)) {
+            push_dummy_msg(ch->buf.tail, tail_size);
+            ch->msgs++;
+            ch->buf.tail = ch->buf.data;
         }
     }
 
+    // без CHANNEL_PRIO_LANES канал - единая очередь FIFO
+    if (!(ch->flags & CHANNEL_PRIO_LANES))
+        emsg->lane = 0;
     ch->buf.tail += copy_msg(ch->buf.tail, emsg);
     ch->msgs++;
+    ch->unread++;
+    ch->lanes[emsg->lane]++;
 
     ch->buf.tail += align_tail(ch->buf.tail);
 
     if (ch->buf.tail == ch->buf.data + ch->buf.size)
         ch->buf.tail = ch->buf.data;
 
+    if (ch->ports)
+        port_notify(&ch->ports);
     return true;
 }
 
@@ -230,8 +323,9 @@ static void try_unblock_receiver (struct channel * const channel)
 
 static int set_timeout (struct thread * const thr, const uint64_t timeout)
 {
+    // без ожидания (NO_WAIT) - ожидаемый результат опроса, решение об ошибке принимает вызывающий
     if (timeout < TIMEOUT_MIN)
-        return ERROR(ERR_TIMEOUT);
+        return ERR_TIMEOUT;
 
     if (timeout == TIMEOUT_INFINITY)
         return OK;
@@ -243,6 +337,110 @@ static int set_timeout (struct thread * const thr, const uint64_t timeout)
 }
 
 
+/* Отказ от переноса страниц: данные сообщения копируются в буфер канала */
+static void pages_to_copy (struct emsg * const emsg)
+{
+    emsg->m.sys.ptr = NULL;
+    emsg->pages = false;
+    emsg->size = sizeof(*emsg) + emsg->m.size;
+}
+
+/* Постановка сообщения в канал соединения с ожиданием свободного места и,
+ при MSG_WAIT_COMPLETE, завершения приема. Страницы сегмента seg переносятся
+ получателю вместе с постановкой сообщения, если перенос не удался -
+ данные копируются */
+static int deliver (struct thread * const sender, const int conid, struct emsg * const emsg, struct seg * const seg, const uint64_t timeout)
+{
+    struct connection *connection;
+
+    for (;;) {
+        connection = lock_connection(sender->proc, conid);
+        if (!connection || !connection->channel) {
+            unlock_connection(connection);
+            return ERROR(ERR_DEAD);
+        }
+
+        struct channel *channel = lock_channel(connection->channel->owner, connection->channel->id);
+        if (channel->flags & (CHANNEL_SHARED_RING | CHANNEL_MULTICAST)) {
+            unlock_channel(channel);
+            unlock_connection(connection);
+            return ERROR(ERR_IPC_ILLEGAL_CHANNEL);
+        }
+        if (fit_msg(channel, emsg->size)) {
+            // страницы переносятся до постановки, чтобы сообщение не ссылалось
+            // на оставшиеся у отправителя данные
+            if (seg && (vm_seg_move(sender->proc->mmap, channel->owner->mmap, seg) != OK)) {
+                seg = NULL;
+                pages_to_copy(emsg);
+            }
+            if (push_msg(channel, emsg)) {
+                unlock_channel(channel);
+                break;
+            }
+        }
+        unlock_channel(channel);
+
+        int res = set_timeout(sender, timeout);
+        if (res != OK) {
+            unlock_connection(connection);
+            return ERROR(res);
+        }
+
+        block_sender(sender, connection, emsg->size);
+        unlock_connection(connection);
+        sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+
+        if (!sender->block_evt && timeout != TIMEOUT_INFINITY) {
+            return ERROR(ERR_TIMEOUT);
+        }
+        kevent_cancel(sender->block_evt);
+    }
+
+
+
+    struct channel *channel = lock_channel(connection->channel->owner, connection->channel->id);
+    try_unblock_receiver(channel);
+    unlock_channel(channel);
+
+    if (emsg->flags & MSG_WAIT_COMPLETE) {
+        int res = set_timeout(sender, timeout);
+        if (res != OK) {
+            unlock_connection(connection);
+            return ERROR(res);
+        }
+
+        block_sender(sender, connection, emsg->size);
+        sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+
+        if (!sender->block_evt && timeout != TIMEOUT_INFINITY) {
+            unlock_connection(connection);
+            return ERROR(ERR_TIMEOUT);
+        }
+        kevent_cancel(sender->block_evt);
+    }
+
+    unlock_connection(connection);
+    return OK;
+}
+
+/* Сегмент для передачи данных сообщения переносом страниц (MSG_MOVE_PAGES): данные
+ должны занимать собственный сегмент отправителя с начала, не разделяемый с другими процессами,
+ и быть не меньше MSG_MOVE_PAGES_MIN, а канал - принадлежать другому процессу,
+ иначе данные копируются в буфер канала */
+static struct seg* pages_seg (struct process * const proc, const struct process * const owner, const struct msg * const msg)
+{
+    if ((owner == proc) || (msg->size < MSG_MOVE_PAGES_MIN) || ((size_t)msg->data % mmu_page_size()))
+        return NULL;
+
+    struct seg *seg = vm_seg_get(proc->mmap, msg->data);
+    if (!seg || (seg->map != proc->mmap) || (seg->type != SEG_NORMAL) || (seg->size < msg->size))
+        return NULL;
+    if (seg->shared && seg->shared->nodes)
+        return NULL;
+    return seg;
+}
+
+
 int send (struct thread * const sender, const int conid, struct msg * const msg, const uint64_t timeout, const unsigned long flags)
 {
     struct connection *connection = lock_connection(sender->proc, conid);
@@ -253,20 +451,26 @@ int send (struct thread * const sender, const int conid, struct msg * const msg,
         unlock_connection(connection);
         return ERROR(ERR_DEAD);
     }
+    struct process *owner = connection->channel->owner;
     unlock_connection(connection);
 
     struct emsg emsg;
     emsg.drop = false;
+    emsg.pages = false;
+    emsg.held = false;
+    emsg.iov = NULL;
     emsg.m = *msg;
     emsg.flags = flags;
-    emsg.size = sizeof(emsg) + msg->size + sys_size(get_msg_type(&emsg));
+    emsg.prio = sender->prio;
+    emsg.lane = msg_lane(thread_own_prio(sender));
+    emsg.size = sizeof(emsg) + msg->size + sys_size(&emsg);
 
     if (get_msg_sys(&emsg)) {
         switch (get_msg_type(&emsg)) {
         case SYS_MSG_MEM_SEND:
         {
             struct sys_msg_mem *mem = (struct sys_msg_mem *)(msg->sys.memcmd);
-            int res = vm_seg_move(sender->proc->mmap, sender->proc->mmap, vm_seg_get(sender->proc->mmap, mem->seg.adr));
+            int res = vm_seg_move(sender->proc->mmap, connection->channel->owner->mmap, vm_seg_get(sender->proc->mmap, mem->seg.adr));
             if (res != OK) {
                 struct channel *channel = lock_channel(connection->channel->owner, connection->channel->id);
                 unlock_channel(channel);
@@ -278,7 +482,7 @@ int send (struct thread * const sender, const int conid, struct msg * const msg,
         case SYS_MSG_MEM_SHARE:
         {
             struct sys_msg_mem *mem = (struct sys_msg_mem *)(msg->sys.memcmd);
-            int res = vm_seg_share(sender->proc->mmap, vm_seg_get(sender->proc->mmap, mem->seg.adr));
+            int res = vm_seg_share(connection->channel->owner->mmap, vm_seg_get(sender->proc->mmap, mem->seg.adr));
             if (res != OK) {
                 struct channel *channel = lock_channel(connection->channel->owner, connection->channel->id);
                 unlock_channel(channel);
@@ -297,79 +501,142 @@ int send (struct thread * const sender, const int conid, struct msg * const msg,
         }
     }
 
-    for (;;) {
-        connection = lock_connection(sender->proc, conid);
-        if (!connection || !connection->channel) {
-            unlock_connection(connection);
-            return ERROR(ERR_DEAD);
+    struct sys_msg_mem memcmd;
+    struct seg *seg = NULL;
+    if ((flags & MSG_MOVE_PAGES) && !get_msg_sys(&emsg)) {
+        seg = pages_seg(sender->proc, owner, msg);
+        if (seg) {
+            // в канал помещается только описание сегмента, сами страницы переносятся
+            // в карту памяти получателя одновременно с постановкой сообщения
+            memcmd._type = SYS_MSG_MEM_SEND;
+            memcmd.seg.adr = seg->adr;
+            memcmd.seg.size = seg->size;
+            memcmd.seg.attr = seg->attr;
+            emsg.m.sys.memcmd = &memcmd;
+            emsg.pages = true;
+            emsg.size = sizeof(emsg) + sizeof(memcmd);
         }
+    }
 
-        struct channel *channel = lock_channel(connection->channel->owner, connection->channel->id);
-        if (push_msg(channel, &emsg)) {
-            unlock_channel(channel);
-            break;
-        }
-        unlock_channel(channel);
+    return deliver(sender, conid, &emsg, seg, timeout);
+}
 
-        int res = set_timeout(sender, timeout);
-        if (res != OK) {
-            unlock_connection(connection);
-            return ERROR(res);
-        }
+int receive (struct thread * const receiver, const int chid, struct msg ** const msg, const uint64_t timeout)
+{
+    *msg = NULL;
+    struct emsg *emsg = NULL;
 
-        block_sender(sender, connection, emsg.size);
-        unlock_connection(connection);
-        sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+    // повторный прием завершает обработку предыдущего сообщения
+    inherit_prio(receiver, 0);
 
-        if (!sender->block_evt && timeout != TIMEOUT_INFINITY) {
-            unlock_connection(connection);
-            return ERROR(ERR_TIMEOUT);
-        }
-        kevent_cancel(sender->block_evt);
+    struct channel *channel = lock_channel(receiver->proc, chid);
+    if (!channel) {
+        return ERROR(ERR_ILLEGAL_ARGS);
+    }
+    if (channel->flags & (CHANNEL_SHARED_RING | CHANNEL_MULTICAST)) {
+        unlock_channel(channel);
+        return ERROR(ERR_IPC_ILLEGAL_CHANNEL);
     }
 
+    for (;;) {
+        try_unblock_senders(channel);
 
+        emsg = pop_msg(channel);
+        if (emsg)
+            break;
 
-    struct channel *channel = lock_channel(connection->channel->owner, connection->channel->id);
-    try_unblock_receiver(channel);
-    unlock_channel(channel);
+        if (channel->zombie) {
+            unlock_channel(channel);
+            return ERROR(ERR_DEAD);
+        }
 
-    if (emsg.flags & MSG_WAIT_COMPLETE) {
-        int res = set_timeout(sender, timeout);
+        // пустой канал при опросе - не ошибка
+        int res = set_timeout(receiver, timeout);
         if (res != OK) {
-            unlock_connection(connection);
-            return ERROR(res);
+            unlock_channel(channel);
+            return res;
         }
 
-        block_sender(sender, connection, emsg.size);
+        block_receiver(receiver, channel);
+        unlock_channel(channel);
         sched_switch(SCHED_SWITCH_SAVE_AND_RET);
 
-        if (!sender->block_evt && timeout != TIMEOUT_INFINITY) {
-            unlock_connection(connection);
+        if (!receiver->block_evt && timeout != TIMEOUT_INFINITY) {
             return ERROR(ERR_TIMEOUT);
         }
-        kevent_cancel(sender->block_evt);
+        kevent_cancel(receiver->block_evt);
+
+        channel = lock_channel(receiver->proc, chid);
+        if (!channel) {
+            return ERROR(ERR_DEAD);
+        }
     }
+    *msg = &emsg->m;
+    int prio = (channel->flags & CHANNEL_PRIO_INHERIT) ? emsg->prio : 0;
 
-    unlock_connection(connection);
+    if (!(emsg->flags & MSG_WAIT_COMPLETE))
+        try_unblock_senders(channel);
+
+    unlock_channel(channel);
+    inherit_prio(receiver, prio);
     return OK;
 }
 
-int receive (struct thread * const receiver, const int chid, struct msg ** const msg, const uint64_t timeout)
+int sendv (struct thread * const sender, const int conid, const struct msg_iov * const iov, const int iovcnt,
+        const uint64_t timeout, const unsigned long flags)
 {
-    *msg = NULL;
-    struct emsg *emsg = NULL;
+    if (!iov || (iovcnt <= 0) || (iovcnt > MSG_IOV_MAX))
+        return ERROR(ERR_ILLEGAL_ARGS);
+
+    // описание частей копируется, чтобы размер сообщения не изменился до копирования данных
+    struct msg_iov kiov[MSG_IOV_MAX];
+    size_t size = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        kiov[i] = iov[i];
+        size += kiov[i].len;
+    }
+
+    struct emsg emsg;
+    emsg.drop = false;
+    emsg.pages = false;
+    emsg.held = false;
+    emsg.iov = kiov;
+    emsg.iovcnt = iovcnt;
+    emsg.m.sys.ptr = NULL;
+    emsg.m.data = NULL;
+    emsg.m.size = size;
+    emsg.flags = flags & MSG_WAIT_COMPLETE;
+    emsg.prio = sender->prio;
+    emsg.lane = msg_lane(thread_own_prio(sender));
+    emsg.size = sizeof(emsg) + size;
+
+    return deliver(sender, conid, &emsg, NULL, timeout);
+}
+
+int receive_batch (struct thread * const receiver, const int chid, struct msg ** const msgs, const int n, const uint64_t timeout)
+{
+    struct emsg *ems[MSG_BATCH_MAX];
+    int cnt;
+
+    if (!msgs || (n <= 0))
+        return ERROR(ERR_ILLEGAL_ARGS);
+
+    inherit_prio(receiver, 0);
 
     struct channel *channel = lock_channel(receiver->proc, chid);
     if (!channel) {
         return ERROR(ERR_ILLEGAL_ARGS);
     }
+    if (channel->flags & (CHANNEL_SHARED_RING | CHANNEL_MULTICAST)) {
+        unlock_channel(channel);
+        return ERROR(ERR_IPC_ILLEGAL_CHANNEL);
+    }
 
     for (;;) {
         try_unblock_senders(channel);
 
-        emsg = pop_msg(channel);
-        if (emsg)
+        cnt = select_msgs(channel, ems, (n < MSG_BATCH_MAX) ? n : MSG_BATCH_MAX, true);
+        if (cnt)
             break;
 
         if (channel->zombie) {
@@ -377,9 +644,12 @@ int receive (struct thread * const receiver, const int chid, struct msg ** const
             return ERROR(ERR_DEAD);
         }
 
+        // пустой канал при опросе - не ошибка
         int res = set_timeout(receiver, timeout);
-        if (res != OK)
-            return ERROR(res);
+        if (res != OK) {
+            unlock_channel(channel);
+            return res;
+        }
 
         block_receiver(receiver, channel);
         unlock_channel(channel);
@@ -395,11 +665,484 @@ int receive (struct thread * const receiver, const int chid, struct msg ** const
             return ERROR(ERR_DEAD);
         }
     }
-    *msg = &emsg->m;
+    // пакет выбран с наивысшего уровня, наследуется наивысший приоритет отправителей пакета
+    int prio = 0;
+    if (channel->flags & CHANNEL_PRIO_INHERIT) {
+        for (int i = 0; i < cnt; i++) {
+            if (!prio || (ems[i]->prio < prio))
+                prio = ems[i]->prio;
+        }
+    }
+    unlock_channel(channel);
+    inherit_prio(receiver, prio);
 
-    if (!(emsg->flags & MSG_WAIT_COMPLETE))
-        try_unblock_senders(channel);
+    for (int i = 0; i < cnt; i++)
+        msgs[i] = &ems[i]->m;
+    return cnt;
+}
+
+int receive_release (struct thread * const receiver, const int chid, struct msg ** const msgs, const int n)
+{
+    int res = OK;
+
+    if (!msgs || (n <= 0))
+        return ERROR(ERR_ILLEGAL_ARGS);
+
+    struct channel *channel = lock_channel(receiver->proc, chid);
+    if (!channel) {
+        return ERROR(ERR_ILLEGAL_ARGS);
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint8_t *p = (uint8_t *)msgs[i] - offsetof(struct emsg, m);
+        struct emsg *em = (struct emsg *)p;
+        if ((p < channel->buf.data) || (p + sizeof(*em) > channel->buf.data + channel->buf.size) || !em->held) {
+            res = ERR_ILLEGAL_ARGS;
+            continue;
+        }
+        em->held = false;
+        em->drop = true;
+    }
+    // освободившееся место может принять заблокированных отправителей
+    drop_msgs(channel);
+    try_unblock_senders(channel);
+    unlock_channel(channel);
+    return ERROR(res);
+}
+
+int post (struct process * const proc, const int chid, struct msg * const msg)
+{
+    struct emsg emsg;
+    emsg.drop = false;
+    emsg.pages = false;
+    emsg.held = false;
+    emsg.iov = NULL;
+    emsg.m = *msg;
+    emsg.flags = 0;
+    emsg.prio = PRIO_MAX;
+    emsg.lane = 0;          // оповещения ядра выдаются раньше запросов (CHANNEL_PRIO_LANES)
+    emsg.size = sizeof(emsg) + msg->size + sys_size(&emsg);
 
+    struct channel *channel = lock_channel(proc, chid);
+    if (!channel)
+        return ERROR(ERR_ILLEGAL_ARGS);
+
+    if (channel->zombie || (channel->flags & (CHANNEL_SHARED_RING | CHANNEL_MULTICAST)) || !push_msg(channel, &emsg)) {
+        unlock_channel(channel);
+        return ERROR(ERR_BUSY);
+    }
+    try_unblock_receiver(channel);
     unlock_channel(channel);
     return OK;
 }
+
+
+/* Синхронный обмен. Очереди потоков всех каналов изменяются под sync_lock, так как
+ таймаут ожидания обрабатывается диспетчером без блокировки канала, а в SMP
+ очереди изменяются на разных ядрах. Диспетчер выбирает наступившие события и
+ обрабатывает таймаут под kevent_store_lock, поэтому sync_lock всегда захватывается
+ после нее (см. sync_queues_lock), а таймаут потока отменяется при изъятии из очереди
+ под обеими блокировками - наступившее событие всегда относится к потоку, находящемуся
+ в очереди, и поток не может быть разбужен дважды.
+ Результат вызова записывается в регистр возврата потока, для заблокированного
+ потока - потоком-партнером, при закрытии канала или диспетчером по таймауту.
+ Активна только карта памяти текущего потока, поэтому между разными процессами
+ каждый поток копирует данные только из своих буферов или в свои: запрос копируется
+ отправителем в память ядра (rdv.stage), ответ - отвечающим потоком (rdv.kbuf),
+ в приемный буфер данные копирует сам принимающий поток после пробуждения.
+ Внутри процесса данные копируются один раз непосредственно между буферами. */
+
+static spinlock_t sync_lock;
+
+static inline void sync_queues_lock ()
+{
+    sched_lock();
+    kevent_store_lock();
+    spinlock_lock(&sync_lock);
+}
+
+static inline void sync_queues_unlock ()
+{
+    spinlock_unlock(&sync_lock);
+    kevent_store_unlock();
+    sched_unlock();
+}
+
+static inline void sync_result (struct thread * const thr, const int res)
+{
+    thr->uregs->basic_regs[CPU_REG_0] = res;
+}
+
+/* Копия данных в памяти ядра для передачи потоку другого процесса */
+static void* sync_stage (const void * const buf, const size_t size)
+{
+    void *kbuf = kmalloc(size);
+    if (kbuf)
+        memcpy(kbuf, buf, size);
+    return kbuf;
+}
+
+/* Завершение приема после пробуждения в контексте принимающего потока:
+ копирование данных, переданных через память ядра, в собственный буфер */
+static void sync_take (struct thread * const thr)
+{
+    if (thr->rdv.stage) {
+        kfree(thr->rdv.stage);
+        thr->rdv.stage = NULL;
+    }
+    if (thr->rdv.kbuf) {
+        memcpy(thr->rdv.rbuf, thr->rdv.kbuf, thr->rdv.klen);
+        kfree(thr->rdv.kbuf);
+        thr->rdv.kbuf = NULL;
+    }
+}
+
+static void sync_push (struct msg_sync_list * const list, struct thread * const thr)
+{
+    if (!list->head) {
+        list->head = thr;
+    } else
+        thread_block_list_insert(list->tail, thr);
+    list->tail = thr;
+}
+
+/* Отправители ожидают получателя в порядке приоритета, в порядке поступления среди равных */
+static void sync_push_prio (struct msg_sync_list * const list, struct thread * const thr)
+{
+    struct thread *prev = list->tail;
+    while (prev && (prev->prio > thr->prio))
+        prev = prev->block_list.prev;
+    if (prev) {
+        thread_block_list_insert(prev, thr);
+        if (list->tail == prev)
+            list->tail = thr;
+        return;
+    }
+    thr->block_list.next = list->head;
+    if (list->head)
+        list->head->block_list.prev = thr;
+    else
+        list->tail = thr;
+    list->head = thr;
+}
+
+static void sync_remove (struct msg_sync_list * const list, struct thread * const thr)
+{
+    if (list->head == thr)
+        list->head = thr->block_list.next;
+    if (list->tail == thr)
+        list->tail = thr->block_list.prev;
+    thread_block_list_remove(thr);
+}
+
+static struct thread* sync_pop (struct msg_sync_list * const list)
+{
+    struct thread *thr = list->head;
+    if (thr) {
+        sync_remove(list, thr);
+        kevent_cancel_locked(thr->block_evt);
+        thr->block_evt = NULL;
+    }
+    return thr;
+}
+
+static void sync_wait_reply (struct thread * const sender, struct channel * const channel)
+{
+    thread_msg_block(sender, MSG_REPLY, channel);
+    sender->block_evt = NULL;
+    sync_push(&channel->msg_reply, sender);
+}
+
+static int sync_block (struct thread * const thr, struct msg_sync_list * const list, const int type,
+        struct channel * const channel, const uint64_t timeout)
+{
+    if (timeout < TIMEOUT_MIN)
+        return ERR_TIMEOUT;
+
+    sync_queues_lock();
+    thread_msg_block(thr, type, channel);
+    thr->block_evt = NULL;
+    if (type == MSG_SEND)
+        sync_push_prio(list, thr);
+    else
+        sync_push(list, thr);
+    if (timeout != TIMEOUT_INFINITY)
+        thr->block_evt = kevent_insert(systime() + timeout, thr);
+    sync_queues_unlock();
+    return OK;
+}
+
+void msg_send_recv (struct thread * const sender, const int conid, const void * const sbuf, const size_t slen,
+        void * const rbuf, const size_t rlen, const uint64_t timeout)
+{
+    struct connection *connection = lock_connection(sender->proc, conid);
+    if (!connection) {
+        sync_result(sender, ERROR(ERR_ILLEGAL_ARGS));
+        return;
+    }
+    if (!connection->channel) {
+        unlock_connection(connection);
+        sync_result(sender, ERROR(ERR_DEAD));
+        return;
+    }
+    struct channel *channel = lock_channel(connection->channel->owner, connection->channel->id);
+    unlock_connection(connection);
+    if (!channel) {
+        sync_result(sender, ERROR(ERR_DEAD));
+        return;
+    }
+    if (channel->zombie) {
+        unlock_channel(channel);
+        sync_result(sender, ERROR(ERR_DEAD));
+        return;
+    }
+    if (channel->flags & CHANNEL_MULTICAST) {
+        unlock_channel(channel);
+        sync_result(sender, ERROR(ERR_IPC_ILLEGAL_CHANNEL));
+        return;
+    }
+
+    // получатель другого процесса принимает запрос из памяти ядра
+    bool direct = (channel->owner == sender->proc);
+    sender->rdv.stage = NULL;
+    sender->rdv.kbuf = NULL;
+    if (!direct && slen) {
+        sender->rdv.stage = sync_stage(sbuf, slen);
+        if (!sender->rdv.stage) {
+            unlock_channel(channel);
+            sync_result(sender, ERROR(ERR_NO_MEM));
+            return;
+        }
+    }
+    sender->rdv.sbuf = direct ? sbuf : sender->rdv.stage;
+    sender->rdv.slen = slen;
+    sender->rdv.rbuf = rbuf;
+    sender->rdv.rlen = rlen;
+
+    sync_queues_lock();
+    struct thread *receiver = sync_pop(&channel->msg_receive);
+    sync_queues_unlock();
+
+    if (!receiver) {
+        int res = sync_block(sender, &channel->msg_send, MSG_SEND, channel, timeout);
+        if ((res == OK) && channel->ports)
+            port_notify(&channel->ports);
+        unlock_channel(channel);
+        if (res != OK) {
+            sync_take(sender);
+            sync_result(sender, res);
+            return;
+        }
+        if (!direct) {
+            // ответ копируется в rbuf после пробуждения
+            sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+            sync_take(sender);
+        }
+        return;
+    }
+
+    // внутри процесса запрос копируется сразу в буфер ожидающего получателя,
+    // получателю другого процесса передается копия в памяти ядра
+    size_t size = slen < receiver->rdv.rlen ? slen : receiver->rdv.rlen;
+    if (direct) {
+        memcpy(receiver->rdv.rbuf, sbuf, size);
+    } else {
+        receiver->rdv.kbuf = sender->rdv.stage;
+        sender->rdv.stage = NULL;
+    }
+    receiver->rdv.klen = size;
+    sync_result(receiver, sender->tid);
+    if (channel->flags & CHANNEL_PRIO_INHERIT)
+        inherit_prio(receiver, sender->prio);
+
+    sync_queues_lock();
+    sync_wait_reply(sender, channel);
+    thread_unblock(receiver);
+    enqueue(receiver);
+    sync_queues_unlock();
+    unlock_channel(channel);
+
+    // диспетчер переключится сразу на получателя
+    // с передачей ему остатка кванта и приоритета отправителя
+    sender->yield_to = receiver;
+    if (!direct) {
+        sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+        sync_take(sender);
+    }
+}
+
+void msg_receive (struct thread * const receiver, const int chid, void * const buf, const size_t size,
+        size_t * const len, const uint64_t timeout)
+{
+    inherit_prio(receiver, 0);
+
+    struct channel *channel = lock_channel(receiver->proc, chid);
+    if (!channel) {
+        sync_result(receiver, ERROR(ERR_ILLEGAL_ARGS));
+        return;
+    }
+    if (channel->zombie) {
+        unlock_channel(channel);
+        sync_result(receiver, ERROR(ERR_DEAD));
+        return;
+    }
+    if (channel->flags & CHANNEL_MULTICAST) {
+        unlock_channel(channel);
+        sync_result(receiver, ERROR(ERR_IPC_ILLEGAL_CHANNEL));
+        return;
+    }
+
+    sync_queues_lock();
+    struct thread *sender = sync_pop(&channel->msg_send);
+    sync_queues_unlock();
+
+    if (!sender) {
+        receiver->rdv.rbuf = buf;
+        receiver->rdv.rlen = size;
+        receiver->rdv.len = len;
+        receiver->rdv.stage = NULL;
+        receiver->rdv.kbuf = NULL;
+        int res = sync_block(receiver, &channel->msg_receive, MSG_RECEIVE, channel, timeout);
+        unlock_channel(channel);
+        if (res != OK) {
+            sync_result(receiver, res);
+            return;
+        }
+        // запрос другого процесса и размер принятых данных записываются после пробуждения
+        sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+        if ((int)receiver->uregs->basic_regs[CPU_REG_0] > 0) {
+            sync_take(receiver);
+            if (len)
+                *len = receiver->rdv.klen;
+        }
+        return;
+    }
+
+    // запрос отправителя другого процесса находится в памяти ядра (rdv.stage)
+    size_t n = sender->rdv.slen < size ? sender->rdv.slen : size;
+    memcpy(buf, sender->rdv.sbuf, n);
+    if (len)
+        *len = n;
+
+    int prio = (channel->flags & CHANNEL_PRIO_INHERIT) ? sender->prio : 0;
+    sync_queues_lock();
+    sync_wait_reply(sender, channel);
+    sync_queues_unlock();
+    unlock_channel(channel);
+    inherit_prio(receiver, prio);
+    sync_result(receiver, sender->tid);
+}
+
+void msg_reply (struct thread * const replier, const int rcvid, const int status, const void * const buf, const size_t len)
+{
+    thread_allocator_lock();
+    struct thread *sender = get_thr(rcvid);
+
+    sync_queues_lock();
+    if (!sender || (sender->state != BLOCKED) || (sender->block.type != MSG_REPLY) ||
+            (sender->block.object.channel->owner != replier->proc)) {
+        sync_queues_unlock();
+        thread_allocator_unlock();
+        sync_result(replier, ERROR(ERR_ILLEGAL_ARGS));
+        return;
+    }
+    sync_remove(&sender->block.object.channel->msg_reply, sender);
+    sync_queues_unlock();
+
+    // отправитель другого процесса копирует ответ после пробуждения
+    int res = OK;
+    size_t n = len < sender->rdv.rlen ? len : sender->rdv.rlen;
+    if (sender->proc == replier->proc) {
+        memcpy(sender->rdv.rbuf, buf, n);
+    } else if (n) {
+        sender->rdv.kbuf = sync_stage(buf, n);
+        sender->rdv.klen = n;
+        if (!sender->rdv.kbuf)
+            res = ERR_NO_MEM;
+    }
+    sync_result(sender, (res == OK) ? status : res);
+
+    sync_queues_lock();
+    thread_unblock(sender);
+    enqueue(sender);
+    sync_queues_unlock();
+    thread_allocator_unlock();
+
+    if (replier->time_grant == sender) {
+        // отвечающий выполняется с квантом отправителя, полученным при передаче запроса,
+        // возвращаем остаток кванта отправителю прямым переключением
+        replier->yield_to = sender;
+        replier->state = READY;
+    }
+    inherit_prio(replier, 0);
+    sync_result(replier, ERROR(res));
+}
+
+int msg_sync_wait (struct thread * const thr, struct msg_sync_list * const list, const int type,
+        struct channel * const channel, const uint64_t timeout)
+{
+    return sync_block(thr, list, type, channel, timeout);
+}
+
+void msg_sync_wake (struct msg_sync_list * const list)
+{
+    struct thread *thr;
+
+    sync_queues_lock();
+    while ((thr = sync_pop(list)) != NULL) {
+        thread_unblock(thr);
+        enqueue(thr);
+    }
+    sync_queues_unlock();
+}
+
+bool msg_sync_wake_one (struct msg_sync_list * const list)
+{
+    struct thread *thr;
+
+    sync_queues_lock();
+    if ((thr = sync_pop(list)) != NULL) {
+        thread_unblock(thr);
+        enqueue(thr);
+    }
+    sync_queues_unlock();
+    return thr != NULL;
+}
+
+void msg_sync_timeout (struct thread * const thr)
+{
+    struct channel *channel = thr->block.object.channel;
+    struct msg_sync_list *list;
+    switch (thr->block.type) {
+    case MSG_SEND:
+        list = &channel->msg_send;
+        break;
+    case MSG_PULSE:
+        list = &channel->pulse.wait;
+        break;
+    default:
+        list = &channel->msg_receive;
+        break;
+    }
+    spinlock_lock(&sync_lock);
+    sync_remove(list, thr);
+    spinlock_unlock(&sync_lock);
+    sync_result(thr, ERR_TIMEOUT);
+    thread_unblock(thr);
+}
+
+void msg_sync_unblock (struct channel * const channel)
+{
+    struct msg_sync_list *lists[] = { &channel->msg_receive, &channel->msg_send, &channel->msg_reply, &channel->pulse.wait };
+    struct thread *thr;
+
+    sync_queues_lock();
+    for (unsigned int i = 0; i < sizeof(lists) / sizeof(lists[0]); i++) {
+        while ((thr = sync_pop(lists[i])) != NULL) {
+            sync_result(thr, ERR_DEAD);
+            thread_unblock(thr);
+            enqueue(thr);
+        }
+    }
+    sync_queues_unlock();
+}
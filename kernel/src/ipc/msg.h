@@ -4,6 +4,9 @@
 #include <os_types.h>
 #include <proc.h>
 
+struct channel;
+struct msg_sync_list;
+
 /** \brief Отправить сообщение
  * \param conid     Номер соединения
  * \param m         Отправляемое сообщение
@@ -12,6 +15,16 @@
  * */
 int send (struct thread * const thr, const int conid, struct msg * const m, const uint64_t timeout, const unsigned long flags);
 
+/** \brief Отправить сообщение, собранное из нескольких частей
+ * \param conid     Номер соединения
+ * \param iov       Части данных сообщения, не более MSG_IOV_MAX
+ * \param iovcnt    Число частей
+ * \param timeout   Таймаут на отправку сообщения
+ * \return Ошибки исполнения
+ * */
+int sendv (struct thread * const thr, const int conid, const struct msg_iov * const iov, const int iovcnt,
+        const uint64_t timeout, const unsigned long flags);
+
 /** \brief Получить сообщение
  * \param chid      Номер канала
  * \param m[out]    Получаемое сообщение
@@ -21,4 +34,76 @@ int send (struct thread * const thr, const int conid, struct msg * const m, cons
  * */
 int receive (struct thread * const thr, const int chid, struct msg ** const m, const uint64_t timeout);
 
+/** \brief Получить пакет сообщений, сообщения остаются в буфере канала до освобождения
+ * \param chid      Номер канала
+ * \param msgs[out] Массив указателей на получаемые сообщения
+ * \param n         Размер массива, за один вызов выдается не более MSG_BATCH_MAX сообщений
+ * \param timeout   Таймаут на получение
+ * \return Число полученных сообщений или ошибки исполнения
+ * */
+int receive_batch (struct thread * const thr, const int chid, struct msg ** const msgs, const int n, const uint64_t timeout);
+
+/** \brief Освободить сообщения, полученные receive_batch
+ * \param chid      Номер канала
+ * \param msgs      Массив указателей на сообщения
+ * \param n         Число сообщений
+ * \return Ошибки исполнения
+ * */
+int receive_release (struct thread * const thr, const int chid, struct msg ** const msgs, const int n);
+
+/** \brief Поместить сообщение в канал процесса от имени ядра без соединения и без блокировки,
+ * например по срабатыванию таймера
+ * \param proc      Процесс-владелец канала
+ * \param chid      Номер канала
+ * \param m         Сообщение
+ * \return Ошибки исполнения
+ * \retval ERR_BUSY  Переполнение буфера канала, сообщение не доставлено
+ * */
+int post (struct process * const proc, const int chid, struct msg * const m);
+
+/** \brief Синхронная посылка запроса с ожиданием ответа (os_msg_send_recv).
+ * Запрос копируется в буфер ожидающего получателя, после чего диспетчер переключается
+ * на получателя с передачей кванта (yield_to).
+ * Результат записывается в регистр возврата потока, при блокировке - при завершении ожидания.
+ * */
+void msg_send_recv (struct thread * const thr, const int conid, const void * const sbuf, const size_t slen,
+        void * const rbuf, const size_t rlen, const uint64_t timeout);
+
+/** \brief Синхронный прием запроса (os_msg_receive).
+ * Результат - номер приема (tid отправителя) или ошибка, записывается в регистр возврата потока.
+ * */
+void msg_receive (struct thread * const thr, const int chid, void * const buf, const size_t size,
+        size_t * const len, const uint64_t timeout);
+
+/** \brief Ответ на синхронный запрос (os_msg_reply).
+ * Результат записывается в регистр возврата потока.
+ * */
+void msg_reply (struct thread * const thr, const int rcvid, const int status, const void * const buf, const size_t len);
+
+/** \brief Завершение ожидания синхронного обмена по таймауту,
+ * вызывается диспетчером под sched_lock и kevent_store_lock
+ * */
+void msg_sync_timeout (struct thread * const thr);
+
+/** \brief Ожидание на очереди синхронного обмена канала, вызывается под блокировкой канала.
+ * Поток блокируется при выходе из вызова или при переключении SCHED_SWITCH_SAVE_AND_RET
+ * \return OK или ERR_TIMEOUT, если timeout меньше TIMEOUT_MIN
+ * */
+int msg_sync_wait (struct thread * const thr, struct msg_sync_list * const list, const int type,
+        struct channel * const channel, const uint64_t timeout);
+
+/** \brief Пробуждение всех потоков очереди синхронного обмена канала
+ * */
+void msg_sync_wake (struct msg_sync_list * const list);
+
+/** \brief Пробуждение первого потока очереди синхронного обмена канала
+ * \return true - поток разбужен
+ * */
+bool msg_sync_wake_one (struct msg_sync_list * const list);
+
+/** \brief Разблокировка всех потоков синхронного обмена канала с ошибкой ERR_DEAD,
+ * вызывается при закрытии канала под его блокировкой
+ * */
+void msg_sync_unblock (struct channel * const channel);
+
 #endif /* MSG_H_ */
@@ -0,0 +1,128 @@
+#include "pulse.h"
+#include "msg.h"
+#include "connection.h"
+#include "channel.h"
+#include "thread.h"
+#include "sched.h"
+#include "port.h"
+#include <os.h>
+#include "common\error.h"
+
+
+/* Очередь импульсов обслуживается только у каналов сообщений, но не у колец и рассылок */
+static inline bool pulse_channel (struct channel * const ch)
+{
+    return !(ch->flags & (CHANNEL_SHARED_RING | CHANNEL_MULTICAST));
+}
+
+
+/* Постановка импульса в очередь канала, выполняется под блокировкой канала */
+static int pulse_queue (struct channel * const ch, const int code, const uint32_t value)
+{
+    if (ch->zombie)
+        return ERR_DEAD;
+
+    for (int i = 0; i < ch->pulse.count; i++) {
+        pulse_t *p = &ch->pulse.q[(ch->pulse.head + i) % MSG_PULSES];
+        if (p->code == code) {
+            // получатели уже разбужены предыдущим импульсом с этим кодом
+            p->value = value;
+            p->count++;
+            return OK;
+        }
+    }
+    if (ch->pulse.count == MSG_PULSES)
+        return ERR_BUSY;
+
+    pulse_t *p = &ch->pulse.q[(ch->pulse.head + ch->pulse.count) % MSG_PULSES];
+    p->code = code;
+    p->value = value;
+    p->count = 1;
+    ch->pulse.count++;
+    msg_sync_wake_one(&ch->pulse.wait);
+    if (ch->ports)
+        port_notify(&ch->ports);
+    return OK;
+}
+
+
+int pulse_post (struct process * const proc, const int chid, const int code, const uint32_t value)
+{
+    struct channel *channel = lock_channel(proc, chid);
+    if (!channel)
+        return ERR_ILLEGAL_ARGS;
+    int res = pulse_channel(channel) ? pulse_queue(channel, code, value) : ERR_ILLEGAL_ARGS;
+    unlock_channel(channel);
+    return res;
+}
+
+
+int pulse_send (struct thread * const thr, const int conid, const int code, const uint32_t value)
+{
+    struct connection *connection = lock_connection(thr->proc, conid);
+    if (!connection)
+        return ERROR(ERR_ILLEGAL_ARGS);
+    if (!connection->channel) {
+        unlock_connection(connection);
+        return ERR_DEAD;
+    }
+    struct channel *channel = lock_channel(connection->channel->owner, connection->channel->id);
+    if (!channel) {
+        unlock_connection(connection);
+        return ERR_DEAD;
+    }
+    if (!pulse_channel(channel)) {
+        unlock_channel(channel);
+        unlock_connection(connection);
+        return ERROR(ERR_ILLEGAL_ARGS);
+    }
+    int res = pulse_queue(channel, code, value);
+    unlock_channel(channel);
+    unlock_connection(connection);
+    return res;
+}
+
+
+int pulse_receive (struct thread * const thr, const int chid, pulse_t * const pulse, const uint64_t timeout)
+{
+    uint64_t deadline = TIMEOUT_INFINITY;
+
+    if (!pulse)
+        return ERROR(ERR_ILLEGAL_ARGS);
+    if ((timeout >= TIMEOUT_MIN) && (timeout != TIMEOUT_INFINITY))
+        deadline = systime() + timeout;
+
+    for (;;) {
+        struct channel *channel = lock_channel(thr->proc, chid);
+        if (!channel)
+            return ERROR(ERR_ILLEGAL_ARGS);
+        if (!pulse_channel(channel)) {
+            unlock_channel(channel);
+            return ERROR(ERR_ILLEGAL_ARGS);
+        }
+
+        if (channel->pulse.count) {
+            *pulse = channel->pulse.q[channel->pulse.head];
+            channel->pulse.head = (channel->pulse.head + 1) % MSG_PULSES;
+            channel->pulse.count--;
+            unlock_channel(channel);
+            return OK;
+        }
+        if (channel->zombie) {
+            unlock_channel(channel);
+            return ERR_DEAD;
+        }
+
+        uint64_t now = systime();
+        if ((timeout < TIMEOUT_MIN) || ((deadline != TIMEOUT_INFINITY) && (now >= deadline))) {
+            unlock_channel(channel);
+            return ERR_TIMEOUT;
+        }
+        int res = msg_sync_wait(thr, &channel->pulse.wait, MSG_PULSE, channel,
+                (deadline == TIMEOUT_INFINITY) ? TIMEOUT_INFINITY : deadline - now);
+        unlock_channel(channel);
+        if (res != OK)
+            return res;
+        sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef PULSE_H_
+#define PULSE_H_
+
+#include <os_types.h>
+#include <proc.h>
+
+/**
+ * Импульсы - асинхронные уведомления фиксированного размера (код и 32-битное значение).
+ * Импульсы хранятся в небольшой очереди канала в памяти ядра, минуя буфер сообщений.
+ * Импульс с кодом, уже ожидающим приема, объединяется с ним: значение заменяется,
+ * счетчик увеличивается. Отправитель никогда не блокируется, новый импульс будит
+ * не более одного получателя. Импульсы принимаются os_pulse_receive, готовность
+ * канала для портов ожидания учитывает импульсы наравне с сообщениями.
+ */
+
+/** \brief Отправка импульса в канал процесса от ядра (таймеры)
+ * \return OK, ERR_BUSY - очередь импульсов канала заполнена, ERR_DEAD, ERR_ILLEGAL_ARGS
+ * */
+int pulse_post (struct process * const proc, const int chid, const int code, const uint32_t value);
+
+/** \brief Отправка импульса через соединение
+ * \return OK, ERR_BUSY - очередь импульсов канала заполнена, ERR_DEAD, ERR_ILLEGAL_ARGS
+ * */
+int pulse_send (struct thread * const thr, const int conid, const int code, const uint32_t value);
+
+/** \brief Прием импульса владельцем канала
+ * \return OK, ERR_TIMEOUT, ERR_DEAD, ERR_ILLEGAL_ARGS
+ * */
+int pulse_receive (struct thread * const thr, const int chid, pulse_t * const pulse, const uint64_t timeout);
+
+#endif /* PULSE_H_ */
@@ -0,0 +1,189 @@
+#include "ring.h"
+#include "connection.h"
+#include "channel.h"
+#include "syn/sem.h"
+#include "mem/vm.h"
+#include <arch.h>
+#include <os.h>
+#include "common\error.h"
+
+
+void ring_init (struct channel *channel)
+{
+    os_ring_t *ring = (os_ring_t *)channel->buf.data;
+    uint32_t size = RING_SIZE_MIN;
+    while ((size << 1) <= channel->buf.size - sizeof(os_ring_t))
+        size <<= 1;
+
+    ring->head = ring->tail = 0;
+    ring->data_wait = ring->space_wait = 0;
+    ring->size = size;
+
+    // семафоры звонков пусты, счетчики переносятся в разделяемый заголовок
+    sem_init(&channel->ring.data, NULL);
+    channel->ring.data.cnt = &ring->data_bell;
+    channel->ring.data.cnt->val = 0;
+    sem_init(&channel->ring.space, NULL);
+    channel->ring.space.cnt = &ring->space_bell;
+    channel->ring.space.cnt->val = 0;
+}
+
+
+void ring_unblock (struct channel *channel)
+{
+    if (!(channel->flags & CHANNEL_SHARED_RING))
+        return;
+    sem_wait_cancel(&channel->ring.data, NULL);
+    sem_wait_cancel(&channel->ring.space, NULL);
+}
+
+
+void ring_disconnect (struct channel *channel, struct connection *connection)
+{
+    if (channel->ring.producer != connection)
+        return;
+    channel->ring.producer = NULL;
+    sem_wait_cancel(&channel->ring.space, NULL);
+    vm_seg_unshare(connection->owner->mmap, vm_seg_get(channel->owner->mmap, channel->buf.data));
+}
+
+
+/* Захват канала кольца со стороны side, для производителя захватывается также соединение */
+static struct channel * lock_ring (struct thread * const thr, const int id, const int side, struct connection **connection)
+{
+    struct channel *channel = NULL;
+    *connection = NULL;
+
+    switch (side) {
+    case RING_CONSUMER:
+        channel = lock_channel(thr->proc, id);
+        break;
+    case RING_PRODUCER:
+        *connection = lock_connection(thr->proc, id);
+        if (!*connection)
+            return NULL;
+        if ((*connection)->channel)
+            channel = lock_channel((*connection)->channel->owner, (*connection)->channel->id);
+        if (!channel) {
+            unlock_connection(*connection);
+            return NULL;
+        }
+        break;
+    default:
+        return NULL;
+    }
+    if (channel && !(channel->flags & CHANNEL_SHARED_RING)) {
+        unlock_channel(channel);
+        if (*connection)
+            unlock_connection(*connection);
+        return NULL;
+    }
+    return channel;
+}
+
+
+static void unlock_ring (struct channel *channel, struct connection *connection)
+{
+    unlock_channel(channel);
+    if (connection)
+        unlock_connection(connection);
+}
+
+
+int ring_attach (struct thread * const thr, const int id, const int side, os_ring_t ** const ring)
+{
+    struct connection *connection;
+    struct channel *channel = lock_ring(thr, id, side, &connection);
+    if (!channel || !ring)
+        return ERROR(ERR_ILLEGAL_ARGS);
+
+    // буфер отображается только владельцу и подключенному производителю
+    if (connection && (channel->ring.producer != connection)) {
+        if (channel->ring.producer) {
+            unlock_ring(channel, connection);
+            return ERR_BUSY;
+        }
+        if (vm_seg_share(connection->owner->mmap, vm_seg_get(channel->owner->mmap, channel->buf.data)) != OK) {
+            unlock_ring(channel, connection);
+            return ERROR(ERR_IPC_SHARE);
+        }
+        channel->ring.producer = connection;
+    }
+    *ring = (os_ring_t *)channel->buf.data;
+    unlock_ring(channel, connection);
+    return OK;
+}
+
+
+/* Семафор звонка стороне side, производитель должен быть подключен */
+static semaphore_t * ring_bell (struct channel *channel, struct connection *connection, const int side)
+{
+    if (channel->zombie)
+        return NULL;
+    if (side == RING_CONSUMER)
+        return &channel->ring.data;
+    if (channel->ring.producer != connection)
+        return NULL;
+    return &channel->ring.space;
+}
+
+
+int ring_wait (struct thread * const thr, const int id, const int side, const uint64_t timeout)
+{
+    struct connection *connection;
+    struct channel *channel = lock_ring(thr, id, side, &connection);
+    if (!channel)
+        return ERROR(ERR_ILLEGAL_ARGS);
+
+    semaphore_t *sem = ring_bell(channel, connection, side);
+    if (!sem) {
+        unlock_ring(channel, connection);
+        return ERR_DEAD;
+    }
+    // счетчик звонка размещен в памяти процессов и мог быть испорчен
+    sem_check(sem);
+
+    int res;
+    if (timeout < TIMEOUT_MIN) {
+        res = (sem_trylock(sem, thr) == OK) ? OK : ERR_TIMEOUT;
+        unlock_ring(channel, connection);
+        return res;
+    }
+
+    // в очередь семафора встаем под блокировкой кольца, семафор освобождается вместе с каналом
+    // только после пробуждения всех ожидающих (ring_unblock)
+    const uint64_t ns = (timeout == TIMEOUT_INFINITY) ? TIMEOUT_INFINITY : systime() + timeout;
+    res = sem_lock_prepare(sem, thr, ns);
+    unlock_ring(channel, connection);
+    if (res == OK)
+        return OK;
+    res = sem_lock_wait(thr, ns);
+
+    // пробуждение при закрытии канала или отключении производителя
+    channel = lock_ring(thr, id, side, &connection);
+    if (!channel)
+        return ERR_DEAD;
+    if (!ring_bell(channel, connection, side))
+        res = ERR_DEAD;
+    unlock_ring(channel, connection);
+    return res;
+}
+
+
+int ring_signal (struct thread * const thr, const int id, const int side)
+{
+    struct connection *connection;
+    struct channel *channel = lock_ring(thr, id, side, &connection);
+    if (!channel)
+        return ERROR(ERR_ILLEGAL_ARGS);
+
+    int res = ERR_DEAD;
+    if (ring_bell(channel, connection, side)) {
+        semaphore_t *sem = (side == RING_CONSUMER) ? &channel->ring.space : &channel->ring.data;
+        sem_check(sem);
+        sem_unlock(sem, thr);
+        res = OK;
+    }
+    unlock_ring(channel, connection);
+    return res;
+}
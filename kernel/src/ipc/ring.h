@@ -0,0 +1,44 @@
+#ifndef RING_H_
+#define RING_H_
+
+#include <os_types.h>
+#include <proc.h>
+
+/**
+ * Кольца каналов CHANNEL_SHARED_RING.
+ * Буфер канала отображается владельцу (потребителю) и единственному соединению (производителю)
+ * с доступом на запись, данные передаются через кольцо без участия ядра. Остальным соединениям
+ * канала буфер не отображается, производителю - только после ring_attach.
+ * Ядро хранит два семафора, счетчики которых размещены в заголовке кольца, как у семафоров
+ * SEMAPHORE_TYPE_PLOCAL, и выполняет только ожидание и пробуждение сторон. Перед использованием
+ * счетчики приводятся к допустимому диапазону (sem_check).
+ */
+
+#define RING_SIZE_MIN       (64)    // наименьший размер области данных кольца
+
+struct channel;
+struct connection;
+
+/** \brief Разметка кольца в буфере открываемого канала */
+void ring_init (struct channel *channel);
+
+/** \brief Пробуждение ожидающих сторон при закрытии канала */
+void ring_unblock (struct channel *channel);
+
+/** \brief Отключение производителя при закрытии соединения */
+void ring_disconnect (struct channel *channel, struct connection *connection);
+
+/** \brief Подключение стороны кольца
+ * \param id        Номер канала (RING_CONSUMER) или соединения (RING_PRODUCER)
+ * \param ring[out] Адрес кольца
+ * \return Ошибки исполнения
+ * */
+int ring_attach (struct thread * const thr, const int id, const int side, os_ring_t ** const ring);
+
+/** \brief Ожидание звонка стороне side */
+int ring_wait (struct thread * const thr, const int id, const int side, const uint64_t timeout);
+
+/** \brief Звонок стороне, противоположной side */
+int ring_signal (struct thread * const thr, const int id, const int side);
+
+#endif /* RING_H_ */
@@ -0,0 +1,214 @@
+#include <arch.h>
+#include "common/resm.h"
+#include "common/syshalt.h"
+#include "syn\ksyn.h"
+#include "syn\syn.h"
+#include "ipc\channel.h"
+#include "ipc\pulse.h"
+#include "proc.h"
+#include "ktimer.h"
+
+struct ktimer {
+    struct ktimer *prev;        // список запущенных таймеров по возрастанию time
+    struct ktimer *next;
+    struct process *owner;
+    int id;
+    bool armed;
+    uint64_t time;              // расчетный момент следующего срабатывания
+    uint64_t interval;          // период, 0 - однократный
+    timer_notify_t notify;
+};
+
+static struct ktimer *armed_first;
+static kobject_lock_t tlock;
+
+void ktimer_init() {
+    armed_first = NULL;
+    kobject_lock_init(&tlock);
+}
+
+// Вставка в список запущенных, таймеры с одинаковым временем срабатывают в порядке запуска
+static void armed_insert(struct ktimer *t) {
+    struct ktimer *prev = NULL, *next = armed_first;
+    while((next != NULL) && (next->time <= t->time)) {
+        prev = next;
+        next = next->next;
+    }
+    t->prev = prev;
+    t->next = next;
+    if(prev != NULL) {
+        prev->next = t;
+    } else {
+        armed_first = t;
+    }
+    if(next != NULL) {
+        next->prev = t;
+    }
+    t->armed = true;
+}
+
+static void armed_remove(struct ktimer *t) {
+    if(!t->armed) {
+        return;
+    }
+    if(t->prev != NULL) {
+        t->prev->next = t->next;
+    } else {
+        armed_first = t->next;
+    }
+    if(t->next != NULL) {
+        t->next->prev = t->prev;
+    }
+    t->prev = NULL;
+    t->next = NULL;
+    t->armed = false;
+}
+
+// Выполняется по прерыванию в контексте любого текущего процесса, поэтому оповещение
+// не должно обращаться к памяти процесса-владельца: семафор SEMAPHORE_TYPE_PSHARED
+// и очередь импульсов канала размещаются в микроядре
+static void notify(struct ktimer *t) {
+    switch(t->notify.type) {
+    case TIMER_NOTIFY_SYN:
+        syn_post(t->notify.id, t->owner);
+        break;
+    case TIMER_NOTIFY_CHANNEL:
+    case TIMER_NOTIFY_PULSE:
+        pulse_post(t->owner, t->notify.id, t->id, (uint32_t)t->notify.value.value_int);
+        break;
+    }
+}
+
+int ktimer_create(struct process *p, const timer_notify_t *n) {
+    struct res_header *hdr;
+    struct channel *ch;
+    struct ktimer *t;
+    int id;
+
+    if(n == NULL) {
+        return ERR_ILLEGAL_ARGS;
+    }
+    switch(n->type) {
+    case TIMER_NOTIFY_SYN:
+        // счетчик SEMAPHORE_TYPE_PLOCAL находится в памяти процесса
+        if(syn_get_type(n->id, p) != SEMAPHORE_TYPE_PSHARED) {
+            return ERR_ILLEGAL_ARGS;
+        }
+        break;
+    case TIMER_NOTIFY_CHANNEL:
+    case TIMER_NOTIFY_PULSE:
+        ch = lock_channel(p, n->id);
+        if(ch == NULL) {
+            return ERR_ILLEGAL_ARGS;
+        }
+        // импульсы обслуживаются только каналами сообщений
+        if(ch->flags & (CHANNEL_SHARED_RING | CHANNEL_MULTICAST)) {
+            unlock_channel(ch);
+            return ERR_ILLEGAL_ARGS;
+        }
+        unlock_channel(ch);
+        break;
+    default:
+        return ERR_ILLEGAL_ARGS;
+    }
+    id = resm_create_and_lock(&p->timers, RES_ID_GENERATE, sizeof(struct ktimer), &hdr);
+    if(id <= 0) {
+        return id;
+    }
+    t = GET_RES_DATA(hdr);
+    hdr->ref = t;
+    t->prev = NULL;
+    t->next = NULL;
+    t->owner = p;
+    t->id = id;
+    t->armed = false;
+    t->time = 0;
+    t->interval = 0;
+    t->notify = *n;
+    resm_unlock(&p->timers, hdr);
+    return id;
+}
+
+int ktimer_delete(struct process *p, int id) {
+    struct res_header *hdr;
+    if(resm_search_and_lock(&p->timers, id, &hdr) != OK) {
+        return ERR;
+    }
+    kobject_lock(&tlock);
+    armed_remove(resm_get_ref(hdr));
+    kobject_unlock(&tlock);
+    resm_remove_locked(&p->timers, hdr);
+    return OK;
+}
+
+int ktimer_set(struct process *p, int id, const timer_spec_t *spec, int flags) {
+    struct res_header *hdr;
+    struct ktimer *t;
+    uint64_t time;
+
+    if(spec == NULL) {
+        return ERR_ILLEGAL_ARGS;
+    }
+    if((spec->interval != 0) && (spec->interval < TIMEOUT_MIN)) {
+        return ERR_ILLEGAL_ARGS;
+    }
+    time = spec->value;
+    if((time != 0) && !(flags & TIMER_FLAG_ABSTIME)) {
+        time += systime();
+    }
+    if(resm_search_and_lock(&p->timers, id, &hdr) != OK) {
+        return ERR;
+    }
+    t = resm_get_ref(hdr);
+    kobject_lock(&tlock);
+    armed_remove(t);
+    t->time = time;
+    t->interval = spec->interval;
+    if(time != 0) {
+        // ближайшее прерывание таймера ядра перепрограммируется при выходе из системного вызова
+        armed_insert(t);
+    }
+    kobject_unlock(&tlock);
+    resm_unlock(&p->timers, hdr);
+    return OK;
+}
+
+int ktimer_get_time(uint64_t *time) {
+    int res = ERR;
+    kobject_lock(&tlock);
+    if(armed_first != NULL) {
+        *time = armed_first->time;
+        res = 0;
+    }
+    kobject_unlock(&tlock);
+    return res;
+}
+
+void ktimer_expire() {
+    struct ktimer *t;
+    uint64_t now = systime();
+
+    kobject_lock(&tlock);
+    while( ((t = armed_first) != NULL) && (t->time <= now) ) {
+        armed_remove(t);
+        notify(t);
+        if(t->interval != 0) {
+            // следующий момент от расчетного, пропущенные периоды не оповещаются
+            do {
+                t->time += t->interval;
+            } while(t->time <= now);
+            armed_insert(t);
+        }
+    }
+    kobject_unlock(&tlock);
+}
+
+static void timer_finalize(res_container_t *container, int id, struct res_header *hdr) {
+    kobject_lock(&tlock);
+    armed_remove(resm_get_ref(hdr));
+    kobject_unlock(&tlock);
+}
+
+void ktimer_proc_finalize(struct process *p) {
+    resm_container_free(&p->timers, timer_finalize);
+}
@@ -0,0 +1,38 @@
+#ifndef KTIMER_H_
+#define KTIMER_H_
+
+#include <os_types.h>
+
+struct process;
+
+/**
+ * Модуль таймеров ядра, создаваемых процессами (os_timer_create).
+ * Таймер размещается в контейнере ресурсов процесса-создателя (struct process.timers),
+ * запущенные таймеры всех процессов хранятся в общем списке по возрастанию времени срабатывания.
+ * Срабатывания обрабатываются по прерыванию таймера ядра на CPU_0 (ktimer_expire),
+ * периодический таймер перезапускается от расчетного момента предыдущего срабатывания,
+ * поэтому задержки обработки прерывания и оповещения не накапливаются.
+ * Оповещение выполняется освобождением семафора SEMAPHORE_TYPE_PSHARED или импульсом в канал процесса,
+ * то есть только через объекты в памяти микроядра: обработчик работает в контексте любого процесса.
+ */
+
+void ktimer_init();
+
+int ktimer_create(struct process *p, const timer_notify_t *notify);
+int ktimer_delete(struct process *p, int id);
+int ktimer_set(struct process *p, int id, const timer_spec_t *spec, int flags);
+
+/**
+ * Получение времени ближайшего срабатывания, если есть запущенные таймеры
+ * @return 0 - время получено, иначе запущенных таймеров нет
+ */
+int ktimer_get_time(uint64_t *time);
+
+/**
+ * Обработка наступивших срабатываний, вызывается по прерыванию таймера ядра
+ */
+void ktimer_expire();
+
+void ktimer_proc_finalize(struct process *p);
+
+#endif /* KTIMER_H_ */
@@ -8,6 +8,8 @@
 #include "sched.h"
 #include <string.h>
 #include "event.h"
+#include "ktimer.h"
+#include "port.h"
 #include "syn\syn.h"
 #include "ipc/channel.h"
 #include <os_types.h>
@@ -30,8 +32,11 @@ static void announce ()
 int secondary_main ()
 {
     log_info("booting %d core\n\r", cpu_get_core_id());
+#ifdef BUILD_PMU_USER
+    cpu_pmu_user_enable();
+#endif
     vm_enable();
-    sched_switch(SCHED_SWITCH_NO_RETURN);
+    sched_start_secondary();
     syshalt(SYSHALT_OOPS_ERROR);
     return -1;
 }
@@ -49,6 +54,9 @@ int main ()
 {
     kmem_init();
     board_init();
+#ifdef BUILD_PMU_USER
+    cpu_pmu_user_enable();
+#endif
     print_banner();
     vm_init();
     board_mem_init();
@@ -58,6 +66,8 @@ int main ()
     syn_allocator_init();
     pathname_init();
     kevent_init();
+    ktimer_init();
+    port_init();
     sched_init();
     board_boot_init();
     announce();
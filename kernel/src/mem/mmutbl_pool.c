@@ -1,30 +1,38 @@
 #include "mmutbl_pool.h"
 #include <arch.h>
+#include <config.h>
 #include <common/syshalt.h>
 
-#define POOL_SIZE             4
-
 size_t get_mmutbl_pool_size ()
 {
-    return POOL_SIZE;
+    return MMU_TBL_POOL_SIZE;
 }
 
 static kobject_lock_t lock;
 
-/* Для работы MMU используется пул таблиц L1.
+/* Для работы MMU используется пул таблиц L1 размером MMU_TBL_POOL_SIZE.
  При освобождении слота таблица не очищается по дереву связанной карты,
- а лишь помечается незанятой. При выделении слота сначала ищется слот
- с уже загруженной картой, потом свободный слот, где эта карта была
- Если такого нет, первый свободный слот очищает связанную с ним L1
- и загружает требуемую.
+ а лишь помечается незанятой. При выделении слота сначала проверяется слот
+ с уже загруженной картой (попадание), иначе (промах) карта загружается
+ в чистый слот, а если таких нет - на место незанятой карты, дольше всех
+ не использовавшейся (LRU), с очисткой L1 по ее дереву (вытеснение).
+ Все таблицы пула обновляются при изменении карты ядра, поэтому
+ слишком большой пул удорожает отображение памяти ядра.
  */
 static struct {
-    bool busy;
+    int busy;               // число ядер, на которых загружена карта
+    uint32_t used;          // отметка последнего занятия слота
     struct mmap *map;
     uint32_t *tbl;
-} mmutbl_pool[POOL_SIZE];
+} mmutbl_pool[MMU_TBL_POOL_SIZE];
+
+static uint32_t mmutbl_pool_clock = 0;
 
-static int mmutbl_pool_cnt = 0;
+static struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+} stat;
 
 static inline void pool_lock ()
 {
@@ -60,102 +68,108 @@ static void unmap_tbl (struct rb_tree *tree, uint32_t *tbl)
 void init_mmutbl_pool ()
 {
     extern char __mmu_tbl_start__[], __mmu_tbl_end__[];
+    // секция .mmutbl в bsp/os.ld должна вмещать весь пул, первые слоты занимают ядра при старте
+    if ((size_t)(__mmu_tbl_end__ - __mmu_tbl_start__) < MMU_TBL_POOL_SIZE * mmu_dirtable_size()
+            || MMU_TBL_POOL_SIZE <= NUM_CORE)
+        syshalt(SYSHALT_OOPS_ERROR);
     kobject_lock_init(&lock);
     pool_lock();
     bzero(__mmu_tbl_start__, __mmu_tbl_end__ - __mmu_tbl_start__);
-    for (int i = 0; i < POOL_SIZE; i++) {
-        mmutbl_pool[i].busy = false;
+    for (int i = 0; i < MMU_TBL_POOL_SIZE; i++) {
+        mmutbl_pool[i].busy = 0;
+        mmutbl_pool[i].used = 0;
         mmutbl_pool[i].map = NULL;
         mmutbl_pool[i].tbl = (uint32_t *)(__mmu_tbl_start__ + i * mmu_dirtable_size());
     }
+    stat.hits = stat.misses = stat.evictions = 0;
     pool_unlock();
 }
 
 static void set_mmutbl_pool (int slot, struct mmap *map)
 {
     mmutbl_pool[slot].map = map;
-    mmutbl_pool[slot].busy = true;
     map_tbl(map->pgds, mmutbl_pool[slot].tbl);
-    mmutbl_pool_cnt++;
     map->mmu_pool = slot;
 }
 
+static void clear_mmutbl_pool (int slot)
+{
+    unmap_tbl(mmutbl_pool[slot].map->pgds, mmutbl_pool[slot].tbl);
+    mmutbl_pool[slot].map = NULL;
+}
+
 void light_release_mmutbl_pool (int slot)
 {
-    if (slot < 0 || slot > POOL_SIZE)
+    if (slot < 0 || slot >= MMU_TBL_POOL_SIZE)
         syshalt(SYSHALT_OOPS_ERROR);
     pool_lock();
-    mmutbl_pool[slot].busy = false;
+    if (mmutbl_pool[slot].busy)
+        mmutbl_pool[slot].busy--;
     pool_unlock();
 }
 
-void release_mmutbl_pool (int slot)
+void release_mmutbl_pool (struct mmap *map)
 {
-    if (slot < 0 || slot > POOL_SIZE)
-        syshalt(SYSHALT_OOPS_ERROR);
     pool_lock();
-    if (mmutbl_pool[slot].map) {
-        unmap_tbl(mmutbl_pool[slot].map->pgds, mmutbl_pool[slot].tbl);
-        mmutbl_pool[slot].map = NULL;
-        mmutbl_pool[slot].busy = false;
-        mmutbl_pool_cnt--;
+    int slot = map->mmu_pool;
+    // слот мог быть уже отдан другой карте при вытеснении
+    if (slot != MAP_NO_POOL && mmutbl_pool[slot].map == map) {
+        clear_mmutbl_pool(slot);
+        mmutbl_pool[slot].busy = 0;
     }
+    map->mmu_pool = MAP_NO_POOL;
     pool_unlock();
 }
 
 int load_to_mmutbl_pool (struct mmap *map)
 {
+    int slot = map->mmu_pool;
+
     pool_lock();
-    if (map->mmu_pool != MAP_NO_POOL) {
+    if (slot != MAP_NO_POOL && mmutbl_pool[slot].map == map) {
         // карта еще закеширована в пуле - вернемся на нее
-        if (!mmutbl_pool[map->mmu_pool].busy) {
-            mmutbl_pool[map->mmu_pool].busy = true;
-        }
+        stat.hits++;
     } else {
-        // проверим нет ли "чистого" пула
-        if (mmutbl_pool_cnt < POOL_SIZE) {
-            for (int i = 0; i < POOL_SIZE; i++) {
-                if (!mmutbl_pool[i].busy && !mmutbl_pool[i].map) {
-                    set_mmutbl_pool(i, map);
-                    break;
-                }
-            }
-        } else {
-            // для "цикличного" занятия частично свободного пула
-            static unsigned int start_ind = 0;
-
-            // карты нигде не было, и чистых пулов нет
-            // надо размещаться затирая любой свободный пул
-
-            // не загружаемся сразу на место предыдущей загруженной
-            static struct mmap *prev_map = NULL;
-            if (mmutbl_pool[start_ind].map == prev_map)
-                start_ind++;
-
-            for (int j = 0, i = start_ind % POOL_SIZE; j < POOL_SIZE; j++, i++) {
-                if (i >= POOL_SIZE)
-                    i = 0;
-
-                if (mmutbl_pool[i].busy)
-                    continue;
-
-                release_mmutbl_pool(i);
-                set_mmutbl_pool(i, map);
-                prev_map = map;
-                start_ind++;
+        slot = MAP_NO_POOL;
+        for (int i = 0; i < MMU_TBL_POOL_SIZE; i++) {
+            if (mmutbl_pool[i].busy)
+                continue;
+            if (!mmutbl_pool[i].map) {
+                slot = i;
                 break;
             }
+            if (slot == MAP_NO_POOL || (int32_t)(mmutbl_pool[i].used - mmutbl_pool[slot].used) < 0)
+                slot = i;
         }
+        if (slot == MAP_NO_POOL) {
+            // все слоты заняты загруженными картами
+            pool_unlock();
+            syshalt(SYSHALT_OOPS_ERROR);
+        }
+        if (mmutbl_pool[slot].map) {
+            clear_mmutbl_pool(slot);
+            stat.evictions++;
+        }
+        set_mmutbl_pool(slot, map);
+        stat.misses++;
     }
+    mmutbl_pool[slot].busy++;
+    mmutbl_pool[slot].used = ++mmutbl_pool_clock;
     pool_unlock();
 
-    if (map->mmu_pool == MAP_NO_POOL)
-        syshalt(SYSHALT_OOPS_ERROR);
-
-    return map->mmu_pool;
+    return slot;
 }
 
 uint32_t* get_mmutbl_pool (int slot)
 {
     return mmutbl_pool[slot].tbl;
 }
+
+void get_mmutbl_pool_stat (uint32_t *hits, uint32_t *misses, uint32_t *evictions)
+{
+    pool_lock();
+    *hits = stat.hits;
+    *misses = stat.misses;
+    *evictions = stat.evictions;
+    pool_unlock();
+}
@@ -10,9 +10,12 @@ void init_mmutbl_pool ();
 
 int load_to_mmutbl_pool (struct mmap *map);
 void light_release_mmutbl_pool (int slot);
-void release_mmutbl_pool (int slot);
+void release_mmutbl_pool (struct mmap *map);
 
 uint32_t* get_mmutbl_pool (int slot);
 size_t get_mmutbl_pool_size ();
 
+/** \brief Счетчики попаданий, промахов и вытеснений при загрузке карт в пул */
+void get_mmutbl_pool_stat (uint32_t *hits, uint32_t *misses, uint32_t *evictions);
+
 #endif
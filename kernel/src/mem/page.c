@@ -1,21 +1,36 @@
-/* Информация хранится в двух красно-черных деревьях:
-
- - дерево всех блоков страниц (свободных и занятых)
- - ключ: адрес стартовой страницы блока
-
- - дерево свободных блоков страниц
- - ключ: размер блока (в страницах)
- - если блоков одного размера несколько, они хранятся в узле двусвязным списком
+/* Страницы учитываются по областям памяти, добавляемым page_allocator_add.
+
+ Области фиксированной памяти (fixed) выделяются только по адресу (page_alloc_fixed),
+ динамические - парным (buddy) аллокатором с блоками из 2^k страниц, выровненными
+ по своему размеру. Свободные страницы не отображены для ядра, поэтому учет ведется
+ битовыми картами области, а не списками в самих страницах:
+
+ - used - занятые страницы, head - первые страницы выделенных участков,
+   по ним page_free находит размер освобождаемого участка
+ - free[k] - свободные блоки порядка k (бит на выровненный блок) с подсказкой
+   первого непустого слова, nfree[k] - их число
+
+ Выделение n страниц берет наименьший свободный блок порядка не меньше ceil(log2(n)),
+ хвост блока сверх n страниц сразу возвращается свободными блоками. При освобождении
+ участок разбивается на выровненные блоки, каждый объединяется со свободным парным.
+
+ При BUILD_SMP одиночные динамические страницы дополнительно кэшируются
+ для каждого ядра: страницы в кэше остаются занятыми в битовых картах,
+ поэтому выделение из кэша не берет общую блокировку и не дробит блоки.
+ Порядок блокировок: кэш ядра -> pa_lock.
  */
 
 #include "page.h"
-#include <rbtree.h>
 #include "kmem.h"
-#include "dlist.h"
+#include <string.h>
 #include "common\syshalt.h"
+#include "common\error.h"
 #include <arch.h>
 #include <syn/ksyn.h>
 
+#define PAGE_ORDERS         16      // порядки блоков 0..15, до 2^15 страниц
+#define PAGE_ZONES          16      // число добавляемых областей памяти
+
 static kobject_lock_t pa_lock;
 
 static inline void page_allocator_lock ()
@@ -33,10 +48,31 @@ struct page_stat {
     size_t free;
 };
 
+struct page_zone {
+    size_t base;                    // адрес нумерации страниц, выровнен на наибольший блок
+    uint32_t start;                 // номер первой страницы области
+    uint32_t end;                   // номер страницы за последней страницей области
+    bool fixed;
+    uint32_t *used;
+    uint32_t *head;
+    uint32_t *free[PAGE_ORDERS];
+    uint32_t hint[PAGE_ORDERS];
+    uint32_t nfree[PAGE_ORDERS];
+};
+
+// участок фиксированной памяти, выделенный несколькими владельцами (multiple_access)
+struct page_share {
+    size_t adr;
+    uint32_t pages;
+    int cnt;
+    struct page_share *next;
+};
+
 static struct page_allocator {
     size_t page_size;
-    struct rb_tree *all;
-    struct rb_tree *free;
+    struct page_zone zones[PAGE_ZONES];
+    int nzones;
+    struct page_share *shares;
     struct {
         struct page_stat all;
         struct page_stat fixed;
@@ -44,6 +80,27 @@ static struct page_allocator {
     } stat;
 } pa = { 0 };
 
+#ifdef BUILD_SMP
+static struct page_cache {
+    kobject_lock_t lock;
+    int cnt;
+    void *pages[PAGE_CORE_CACHE];
+} page_cache[NUM_CORE];
+
+static size_t get_page_cached ()
+{
+    size_t cnt = 0;
+    for (int i = 0; i < NUM_CORE; i++)
+        cnt += page_cache[i].cnt;
+    return cnt;
+}
+#else
+static inline size_t get_page_cached ()
+{
+    return 0;
+}
+#endif
+
 size_t get_page_total ()
 {
     return pa.stat.all.total;
@@ -51,12 +108,12 @@ size_t get_page_total ()
 
 size_t get_page_free ()
 {
-    return pa.stat.all.free;
+    return pa.stat.all.free + get_page_cached();
 }
 
 size_t get_page_used ()
 {
-    return pa.stat.all.total - pa.stat.all.free;
+    return pa.stat.all.total - get_page_free();
 }
 
 size_t get_page_fixed_total ()
@@ -81,346 +138,299 @@ size_t get_page_dynamic_total ()
 
 size_t get_page_dynamic_free ()
 {
-    return pa.stat.dynamic.free;
+    return pa.stat.dynamic.free + get_page_cached();
 }
 
 size_t get_page_dynamic_used ()
 {
-    return pa.stat.dynamic.total - pa.stat.dynamic.free;
+    return pa.stat.dynamic.total - get_page_dynamic_free();
 }
 
-// данные узла дерева свободных блоков
-struct fdata {
-    bool multi;
-    union {
-        struct rb_node *anode;           // single
-        struct dlist *anode_dlist_head;  // multi
-    };
-};
-
-// данные узла дерева всех блоков
-struct adata {
-    bool used;
-    bool fixed;
-    int allocate_cnt;
-    uint32_t size;
-    struct rb_node *fnode;
-};
-
-struct fnode {
-    struct rb_node rb_node;
-    struct fdata data;
-};
-
-struct anode {
-    struct rb_node rb_node;
-    struct adata data;
-};
-
-static struct rb_node* alloc_fnode ()
+static inline bool bit_get (const uint32_t *map, uint32_t i)
 {
-    struct rb_node *node = NULL;
-    size_t size_node = sizeof(*node) - sizeof(node->data)
-            + sizeof(struct fdata);
-    node = kmalloc(size_node);
-    memset(node, 0, size_node);
-    rb_node_init(node);
-    return node;
+    return (map[i >> 5] >> (i & 31)) & 1;
 }
 
-static struct rb_node* alloc_anode ()
+static inline void bit_set (uint32_t *map, uint32_t i)
 {
-    struct rb_node *node = NULL;
-    size_t size_node = sizeof(*node) - sizeof(node->data)
-            + sizeof(struct adata);
-    node = kmalloc(size_node);
-    memset(node, 0, size_node);
-    rb_node_init(node);
-    return node;
+    map[i >> 5] |= 1u << (i & 31);
 }
 
-static inline void insert_node (struct rb_tree *tree, struct rb_node *node,
-        uint32_t key)
+static inline void bit_clr (uint32_t *map, uint32_t i)
 {
-    rb_node_set_key(node, key);
-    rb_tree_insert(tree, node);
+    map[i >> 5] &= ~(1u << (i & 31));
 }
 
-static bool is_anode_fixed (struct rb_node *anode)
+static void bits_set (uint32_t *map, uint32_t i, uint32_t n)
 {
-    struct adata *adata = (struct adata *) &anode->data;
-    return adata->fixed ? true : false;
+    for (; n && (i & 31); i++, n--)
+        bit_set(map, i);
+    for (; n >= 32; i += 32, n -= 32)
+        map[i >> 5] = 0xFFFFFFFF;
+    for (; n; i++, n--)
+        bit_set(map, i);
 }
 
-static bool is_anode_used (struct rb_node *anode)
+static void bits_clr (uint32_t *map, uint32_t i, uint32_t n)
 {
-    struct adata *adata = (struct adata *) &anode->data;
-    return adata->used;
+    for (; n && (i & 31); i++, n--)
+        bit_clr(map, i);
+    for (; n >= 32; i += 32, n -= 32)
+        map[i >> 5] = 0;
+    for (; n; i++, n--)
+        bit_clr(map, i);
 }
 
-static uint32_t get_anode_size (struct rb_node *anode)
+static bool bits_any (const uint32_t *map, uint32_t i, uint32_t n)
 {
-    struct adata *adata = (struct adata*) &anode->data;
-    return adata->size;
+    for (; n && (i & 31); i++, n--)
+        if (bit_get(map, i))
+            return true;
+    for (; n >= 32; i += 32, n -= 32)
+        if (map[i >> 5])
+            return true;
+    for (; n; i++, n--)
+        if (bit_get(map, i))
+            return true;
+    return false;
 }
 
-static void set_anode_fixed (struct rb_node *anode)
+static inline uint32_t order_of (uint32_t n)
 {
-    struct adata *adata = (struct adata *) &anode->data;
-    adata->fixed = true;
+    return (n > 1) ? 32 - cpu_clz(n - 1) : 0;
 }
 
-static void set_anode_free (struct rb_node *anode)
+static struct page_zone* zone_get (size_t adr)
 {
-    struct adata *adata = (struct adata *) &anode->data;
-    adata->used = false;
+    for (int i = 0; i < pa.nzones; i++) {
+        struct page_zone *z = &pa.zones[i];
+        if (adr >= z->base + z->start * pa.page_size && adr < z->base + z->end * pa.page_size)
+            return z;
+    }
+    return NULL;
 }
 
-static void set_anode_used (struct rb_node *node)
+static inline uint32_t zone_page (const struct page_zone *z, size_t adr)
 {
-    struct adata *adata = (struct adata *) &node->data;
-    adata->used = true;
+    return (adr - z->base) / pa.page_size;
 }
 
-static void link_anode_to_fnode (struct rb_node *anode, struct rb_node *fnode)
+static inline void* zone_adr (const struct page_zone *z, uint32_t p)
 {
-    struct adata *adata = (struct adata *) &anode->data;
-    adata->fnode = fnode;
+    return (void*) (z->base + p * pa.page_size);
 }
 
-static void set_anode_size (struct rb_node *node, uint32_t new_size)
+static void block_insert (struct page_zone *z, uint32_t p, uint32_t k)
 {
-    struct adata *adata = (struct adata *) &node->data;
-    adata->size = new_size;
+    uint32_t i = p >> k;
+    bit_set(z->free[k], i);
+    if ((i >> 5) < z->hint[k])
+        z->hint[k] = i >> 5;
+    z->nfree[k]++;
 }
 
-static struct rb_node* get_anode (struct rb_node *fnode)
+static void block_remove (struct page_zone *z, uint32_t p, uint32_t k)
 {
-    struct fdata *data = (struct fdata *) &fnode->data;
-    if (data->multi) {
-        return dlist_get_entry(data->anode_dlist_head);
-    } else {
-        return data->anode;
-    }
+    bit_clr(z->free[k], p >> k);
+    z->nfree[k]--;
 }
 
-static struct rb_node* get_fnode (struct rb_node *anode)
+static inline bool block_free (const struct page_zone *z, uint32_t p, uint32_t k)
 {
-    if (is_anode_fixed(anode))
-        return NULL;
-    struct adata *adata = (struct adata *) &anode->data;
-    if (adata->used)
-        return NULL;
-    return adata->fnode;
+    return (p >= z->start) && (p < z->end) && bit_get(z->free[k], p >> k);
 }
 
-static void* get_fnode_adr (struct rb_node *fnode)
+/* Первый свободный блок порядка k, nfree[k] должен быть ненулевым */
+static uint32_t block_first (struct page_zone *z, uint32_t k)
 {
-    return (void*) rb_node_get_key(get_anode(fnode));
+    uint32_t w = z->hint[k];
+    while (!z->free[k][w])
+        w++;
+    z->hint[k] = w;
+    uint32_t bits = z->free[k][w];
+    return ((w << 5) + 31 - cpu_clz(bits & -bits)) << k;
 }
 
-static void* get_anode_adr (struct rb_node *anode)
+/* Возврат участка динамической памяти наибольшими выровненными блоками с объединением */
+static void free_range (struct page_zone *z, uint32_t p, uint32_t n)
 {
-    return (void*) rb_node_get_key(anode);
-}
+    pa.stat.dynamic.free += n;
+    pa.stat.all.free += n;
+    while (n) {
+        uint32_t k = 0;
+        while (k + 1 < PAGE_ORDERS && !(p & ((2u << k) - 1)) && (2u << k) <= n)
+            k++;
+        uint32_t size = 1u << k;
 
-static void insert_fnode (uint32_t size, struct rb_node *anode)
-{
-    struct rb_node *fnode = rb_tree_search(pa.free, size);
-    if (!fnode) {
-        fnode = alloc_fnode();
-        struct fdata *data = (struct fdata *) &fnode->data;
-        data->multi = false;
-        data->anode = anode;
-        insert_node(pa.free, fnode, size);
-    } else {
-        struct fdata *data = (struct fdata *) &fnode->data;
-        if (data->multi) {
-            struct dlist *dlist = kmalloc(sizeof(*dlist));
-            dlist_init(dlist);
-            dlist->entry = (void*) anode;
-            dlist_insert(data->anode_dlist_head, dlist);
-        } else {
-            struct dlist *dlist = kmalloc(sizeof(*dlist));
-            dlist_init(dlist);
-            dlist->entry = data->anode;
-            struct dlist *dlist_new = kmalloc(sizeof(*dlist_new));
-            dlist_init(dlist_new);
-            dlist_new->entry = anode;
-            dlist_insert(dlist, dlist_new);
-            data->anode_dlist_head = dlist;
-            data->multi = true;
+        uint32_t b = p;
+        while (k + 1 < PAGE_ORDERS && block_free(z, b ^ (1u << k), k)) {
+            block_remove(z, b ^ (1u << k), k);
+            b &= ~(1u << k);
+            k++;
         }
-    }
-    link_anode_to_fnode(anode, fnode);
-    set_anode_free(anode);
+        block_insert(z, b, k);
 
-    pa.stat.dynamic.free += size;
+        p += size;
+        n -= size;
+    }
 }
 
-static void remove_fnode (struct rb_node *fnode)
+/* Выделение n страниц из блока порядка не меньше k, NULL - блока нет */
+static void* alloc_pages (uint32_t n, uint32_t k)
 {
-    struct fdata *fdata = (struct fdata *) &fnode->data;
-    if (fdata->multi) {
-        struct dlist *dlist = fdata->anode_dlist_head;
-        fdata->anode_dlist_head = fdata->anode_dlist_head->next;
-        dlist_remove(dlist);
-        kfree(dlist);
-        dlist = fdata->anode_dlist_head;
+    for (uint32_t j = k; j < PAGE_ORDERS; j++) {
+        for (int i = 0; i < pa.nzones; i++) {
+            struct page_zone *z = &pa.zones[i];
+            if (z->fixed || !z->nfree[j])
+                continue;
 
-        if (!dlist->next) {
-            fdata->anode = dlist_get_entry(dlist);
-            fdata->multi = false;
-            kfree(dlist);
-        }
+            uint32_t p = block_first(z, j);
+            block_remove(z, p, j);
+            pa.stat.dynamic.free -= 1u << j;
+            pa.stat.all.free -= 1u << j;
+            if ((1u << j) > n)
+                free_range(z, p + n, (1u << j) - n);
 
-        return;
+            bit_set(z->head, p);
+            bits_set(z->used, p, n);
+            return zone_adr(z, p);
+        }
     }
-
-    rb_tree_remove(pa.free, fnode);
-    pa.stat.dynamic.free -= rb_node_get_key(fnode);
-    kfree(fnode);
+    return NULL;
 }
 
-static struct rb_node* insert_anode (void *adr, uint32_t size)
+/* Изъятие из свободных блоков заданного участка динамической памяти, все его страницы свободны */
+static void take_range (struct page_zone *z, uint32_t p, uint32_t n)
 {
-    struct rb_node *anode = alloc_anode();
-    set_anode_used(anode);
-    set_anode_size(anode, size);
-    insert_node(pa.all, anode, (uint32_t) adr);
-    return anode;
+    uint32_t q = p, end = p + n;
+    while (q < end) {
+        uint32_t k = 0, b = q;
+        while (!bit_get(z->free[k], b >> k)) {
+            if (++k >= PAGE_ORDERS)
+                syshalt(SYSHALT_OOPS_ERROR);
+            b = q & ~((1u << k) - 1);
+        }
+        block_remove(z, b, k);
+        pa.stat.dynamic.free -= 1u << k;
+        pa.stat.all.free -= 1u << k;
+
+        uint32_t bend = b + (1u << k);
+        if (b < q)
+            free_range(z, b, q - b);
+        if (bend > end) {
+            free_range(z, end, bend - end);
+            bend = end;
+        }
+        q = bend;
+    }
 }
 
-static void remove_anode (struct rb_node *node)
+/* Размер выделенного участка с первой страницей p */
+static uint32_t alloc_size (const struct page_zone *z, uint32_t p)
 {
-    rb_tree_remove(pa.all, node);
-    kfree(node);
+    uint32_t n = 1;
+    for (p++; p < z->end; p++, n++) {
+        if (!(p & 31) && (p + 32 <= z->end) && ((z->used[p >> 5] & ~z->head[p >> 5]) == 0xFFFFFFFF)) {
+            p += 31;
+            n += 31;
+            continue;
+        }
+        if (!bit_get(z->used, p) || bit_get(z->head, p))
+            break;
+    }
+    return n;
 }
 
-static struct rb_node* clone_anode (struct rb_node *anode)
+static void release_pages (struct page_zone *z, uint32_t p, uint32_t n)
 {
-    struct rb_node *clone = alloc_anode();
-    memcpy(clone, anode, sizeof(*clone));
-    return clone;
+    bit_clr(z->head, p);
+    bits_clr(z->used, p, n);
+    if (z->fixed) {
+        pa.stat.fixed.free += n;
+        pa.stat.all.free += n;
+    } else
+        free_range(z, p, n);
 }
 
-static bool is_contiguous (struct rb_node *anode1, struct rb_node *anode2)
+static struct page_share* share_find (size_t adr)
 {
-    if (get_anode_adr(anode1) + get_anode_size(anode1) * mmu_page_size() == get_anode_adr(anode2))
-        return true;
-
-    if (get_anode_adr(anode2) + get_anode_size(anode2) * mmu_page_size() == get_anode_adr(anode1))
-        return true;
-
-    return false;
+    for (struct page_share *s = pa.shares; s; s = s->next)
+        if (s->adr == adr)
+            return s;
+    return NULL;
 }
 
-static bool merge_anode (struct rb_node *anode_master,
-        struct rb_node *anode_slave)
+static void share_remove (struct page_share *share)
 {
-    if (!anode_master || !anode_slave)
-        return false;
-
-    if (is_anode_used(anode_master) != is_anode_used(anode_slave))
-        return false;
-
-    if (!is_contiguous(anode_master, anode_slave))
-        return false;
-
-    if ((is_anode_used(anode_master) && is_anode_used(anode_slave))
-            || (is_anode_fixed(anode_master) && is_anode_fixed(anode_slave))) {
-        set_anode_size(anode_master,
-                get_anode_size(anode_master) + get_anode_size(anode_slave));
-        remove_anode(anode_slave);
-    } else {
-        if (is_anode_fixed(anode_master) || is_anode_fixed(anode_slave))
-            return false;
-
-        uint32_t size = get_anode_size(anode_master)
-                + get_anode_size(anode_slave);
-
-        remove_fnode(get_fnode(anode_slave));
-        remove_anode(anode_slave);
-
-        remove_fnode(get_fnode(anode_master));
-        set_anode_size(anode_master, size);
-        insert_fnode(size, anode_master);
-    }
-    return true;
+    struct page_share **s = &pa.shares;
+    while (*s != share)
+        s = &(*s)->next;
+    *s = share->next;
 }
 
-static struct rb_node* split_anode (struct rb_node *anode, size_t new_size)
+#ifdef BUILD_SMP
+static void* cache_get ()
 {
-    if (new_size == 0)
-        return NULL;
+    struct page_cache *c = &page_cache[cpu_get_core_id()];
+    void *adr = NULL;
 
-    size_t size = get_anode_size(anode);
-    if (size <= new_size)
-        return NULL;
-
-    struct rb_node *cutoff = clone_anode(anode);
-    set_anode_size(anode, new_size);
-    set_anode_size(cutoff, size - new_size);
-
-    return cutoff;
+    kobject_lock(&c->lock);
+    if (!c->cnt) {
+        // пополнение половиной кэша за одну общую блокировку
+        page_allocator_lock();
+        while (c->cnt < PAGE_CORE_CACHE / 2) {
+            void *page = alloc_pages(1, 0);
+            if (!page)
+                break;
+            c->pages[c->cnt++] = page;
+        }
+        page_allocator_unlock();
+    }
+    if (c->cnt)
+        adr = c->pages[--c->cnt];
+    kobject_unlock(&c->lock);
+    return adr;
 }
 
-static void free_anode (struct rb_node *anode)
+static bool cache_put (void *adr)
 {
-    if (!anode)
-        syshalt(SYSHALT_OOPS_ERROR);
-
-    if (!is_anode_used(anode))
-        return;
-
-    if (is_anode_fixed(anode)) {
-        set_anode_free(anode);
-    } else
-        insert_fnode(get_anode_size(anode), anode);
+    struct page_cache *c = &page_cache[cpu_get_core_id()];
+    bool res = false;
 
-    struct rb_node *less = rb_tree_get_nearless(anode);
-    if (less) {
-        if (merge_anode(less, anode))
-            anode = less;
-    }
-
-    struct rb_node *larger = rb_tree_get_nearlarger(anode);
-    if (larger) {
-        merge_anode(anode, larger);
+    kobject_lock(&c->lock);
+    if (c->cnt < PAGE_CORE_CACHE) {
+        c->pages[c->cnt++] = adr;
+        res = true;
     }
+    kobject_unlock(&c->lock);
+    return res;
 }
 
-static struct rb_node* alloc_from_fnode (struct rb_node *fnode, uint32_t size)
+/* Возврат кэшей всех ядер в парный аллокатор, вызывается без pa_lock */
+static void cache_drain ()
 {
-    if (!fnode || !size)
-        return NULL;
-
-    uint32_t size_node = fnode->key;
-    void *adr = get_fnode_adr(fnode);
-    struct rb_node *anode = get_anode(fnode);
-
-    set_anode_used(anode);
-    set_anode_size(anode, size);
-    remove_fnode(fnode);
-
-    if (size_node > size) {
-        // остаток вставим новым пустым блоком
-        struct rb_node *cutoff = insert_anode(adr + pa.page_size * size,
-                size_node - size);
-        free_anode(cutoff);
-        return cutoff;
+    for (int i = 0; i < NUM_CORE; i++) {
+        struct page_cache *c = &page_cache[i];
+        kobject_lock(&c->lock);
+        page_allocator_lock();
+        while (c->cnt) {
+            void *adr = c->pages[--c->cnt];
+            struct page_zone *z = zone_get((size_t) adr);
+            release_pages(z, zone_page(z, (size_t) adr), 1);
+        }
+        page_allocator_unlock();
+        kobject_unlock(&c->lock);
     }
-
-    return NULL;
 }
+#endif
 
 void page_allocator_init (size_t page_size)
 {
     kobject_lock_init(&pa_lock);
 
     pa.page_size = page_size;
-    pa.all = NULL;
-    pa.free = NULL;
+    pa.nzones = 0;
+    pa.shares = NULL;
     pa.stat.all.total = 0;
     pa.stat.all.free = 0;
     pa.stat.fixed.total = 0;
@@ -428,28 +438,57 @@ void page_allocator_init (size_t page_size)
     pa.stat.dynamic.total = 0;
     pa.stat.dynamic.free = 0;
 
-    pa.all = kmalloc(sizeof(*pa.all));
-    rb_tree_init(pa.all);
-    rb_tree_set_mode(pa.all, RBTREE_BY_KEY_VALUE);
+#ifdef BUILD_SMP
+    for (int i = 0; i < NUM_CORE; i++) {
+        kobject_lock_init(&page_cache[i].lock);
+        page_cache[i].cnt = 0;
+    }
+#endif
+}
 
-    pa.free = kmalloc(sizeof(*pa.free));
-    rb_tree_init(pa.free);
-    rb_tree_set_mode(pa.free, RBTREE_BY_KEY_VALUE);
+static uint32_t* bitmap_alloc (uint32_t bits)
+{
+    size_t size = ((bits + 31) / 32 + 1) * sizeof(uint32_t);
+    uint32_t *map = kmalloc(size);
+    if (!map)
+        syshalt(SYSHALT_KMEM_NO_MORE);
+    memset(map, 0, size);
+    return map;
 }
 
 int page_allocator_add (void *start, uint32_t n, bool fixed)
 {
+    if (!n)
+        return OK;
+    if (pa.nzones >= PAGE_ZONES)
+        return ERROR(ERR_NO_MEM);
+
+    struct page_zone *z = &pa.zones[pa.nzones];
+    size_t block = pa.page_size << (PAGE_ORDERS - 1);
+    z->base = fixed ? (size_t) start : (size_t) start / block * block;
+    z->start = zone_page(z, (size_t) start);
+    z->end = z->start + n;
+    z->fixed = fixed;
+    z->used = bitmap_alloc(z->end);
+    z->head = bitmap_alloc(z->end);
+    for (int k = 0; k < PAGE_ORDERS; k++) {
+        z->free[k] = fixed ? NULL : bitmap_alloc(z->end >> k);
+        z->hint[k] = 0;
+        z->nfree[k] = 0;
+    }
+
+    page_allocator_lock();
+    pa.nzones++;
     pa.stat.all.total += n;
-    if (fixed)
+    if (fixed) {
         pa.stat.fixed.total += n;
-    else
+        pa.stat.fixed.free += n;
+        pa.stat.all.free += n;
+    } else {
         pa.stat.dynamic.total += n;
-
-    struct rb_node *anode = insert_anode(start, n);
-    if (fixed) {
-        set_anode_fixed(anode);
+        free_range(z, z->start, n);
     }
-    free_anode(anode);
+    page_allocator_unlock();
     return OK;
 }
 
@@ -458,69 +497,55 @@ void* page_alloc_fixed (size_t adr, uint32_t n, bool multiple_access)
     if (!n)
         return NULL;
 
-    page_allocator_lock();
-
-    struct rb_node *anode = rb_tree_search_neareqless(pa.all, adr);
-    if (!anode) {
-        page_allocator_unlock();
+    struct page_share *share = multiple_access ? kmalloc(sizeof(*share)) : NULL;
+    struct page_zone *z = zone_get(adr);
+    if (!z || (multiple_access && !share) || (adr % pa.page_size)) {
+        if (share)
+            kfree(share);
         return NULL;
     }
-
-    if (is_anode_used(anode)) {
-        page_allocator_unlock();
+    uint32_t p = zone_page(z, adr);
+    if (p + n > z->end) {
+        if (share)
+            kfree(share);
         return NULL;
     }
 
-    size_t node_adr = rb_node_get_key(anode);
-    size_t node_size = get_anode_size(anode);
-    size_t shift_to_start = (adr - node_adr) / mmu_page_size();
+#ifdef BUILD_SMP
+    // страницы области могут лежать в кэшах ядер
+    if (!z->fixed)
+        cache_drain();
+#endif
 
-    if (node_size - shift_to_start < n)
-        return NULL;
-
-    if (is_anode_fixed(anode)) {
-        struct rb_node *cutoff = NULL;
-        if (shift_to_start) {
-            cutoff = split_anode(anode, shift_to_start);
-            insert_node(pa.all, cutoff, adr);
+    page_allocator_lock();
+    if (bits_any(z->used, p, n)) {
+        // повторное выделение участка, уже выделенного с разрешением повторного доступа
+        struct page_share *s = share_find(adr);
+        if (multiple_access && s && s->pages == n) {
+            s->cnt++;
         } else
-            cutoff = anode;
-
-        anode = cutoff;
-        cutoff = split_anode(anode, n);
-        if (cutoff) {
-            insert_node(pa.all, cutoff, adr + n * mmu_page_size());
-        }
-
-        set_anode_used(anode);
-    } else {
-        struct rb_node *fnode = get_fnode(anode);
-
-        if (adr == node_adr && n == node_size) {
-            set_anode_used(get_anode(fnode));
-            remove_fnode(fnode);
-        } else if (adr == node_adr) {
-            alloc_from_fnode(fnode, n);
-        } else {
-            set_anode_used(anode);
-            set_anode_size(anode, node_size);
-            remove_fnode(fnode);
-
-            struct rb_node *alloc_node = split_anode(anode,
-                    (adr - node_adr) / mmu_page_size());
-
-            insert_node(pa.all, alloc_node, adr);
-            free_anode(alloc_node);
-
-            struct rb_node *cutoff = alloc_from_fnode(get_fnode(alloc_node), n);
-            if (cutoff) {
-                merge_anode(cutoff, rb_tree_get_nearlarger(cutoff));
-            }
-
-            free_anode(anode);
-        }
+            adr = 0;
+        page_allocator_unlock();
+        if (share)
+            kfree(share);
+        return (void*) adr;
     }
 
+    if (z->fixed) {
+        pa.stat.fixed.free -= n;
+        pa.stat.all.free -= n;
+    } else
+        take_range(z, p, n);
+    bit_set(z->head, p);
+    bits_set(z->used, p, n);
+
+    if (share) {
+        share->adr = adr;
+        share->pages = n;
+        share->cnt = 1;
+        share->next = pa.shares;
+        pa.shares = share;
+    }
     page_allocator_unlock();
     return (void*) adr;
 }
@@ -530,75 +555,33 @@ void* page_alloc (uint32_t n)
     if (!n)
         return NULL;
 
-    page_allocator_lock();
+#ifdef BUILD_SMP
+    if (n == 1)
+        return cache_get();
+#endif
 
-    struct rb_node *fnode = rb_tree_search_eqlarger(pa.free, n);
-    if (!fnode) {
-        page_allocator_unlock();
-        return NULL;
-    }
-
-    void *adr = get_fnode_adr(fnode);
-    alloc_from_fnode(fnode, n);
+    page_allocator_lock();
+    void *adr = alloc_pages(n, order_of(n));
     page_allocator_unlock();
     return adr;
 }
 
-// realtime = 1 - поиск блока двойного размера и возврат ошибки если такого нет
-// realtime = 0 - попытка разместить выровненный блок в любом блоке большего размера - если такого нет - PANIC
 void* page_alloc_align (uint32_t n /* в страницах */,
         uint32_t align /* в байтах */, uint32_t realtime)
 {
     if (!n)
         return NULL;
 
-    page_allocator_lock();
-
-    struct rb_node *fnode = rb_tree_search_neareqlarger(pa.free, n);
-    while (fnode) {
-        void *adr = NULL;
-
-        void *node_adr = get_fnode_adr(fnode);
-        size_t node_size = rb_node_get_key(fnode);
-        struct rb_node *anode = get_anode(fnode);
-
-        adr = (void*) (((size_t) node_adr / align) * align + align);
-
-        if (adr + n * mmu_page_size() <= node_adr + node_size * mmu_page_size()) {
-            if (adr == node_adr && n == node_size) {
-                set_anode_used(get_anode(fnode));
-                remove_fnode(fnode);
-            } else if (adr == node_adr) {
-                alloc_from_fnode(fnode, n);
-            } else {
-                set_anode_used(anode);
-                set_anode_size(anode, node_size);
-                remove_fnode(fnode);
-
-                struct rb_node *alloc_node = split_anode(anode,
-                        (adr - node_adr) / mmu_page_size());
-
-                insert_node(pa.all, alloc_node, (uint32_t) adr);
-                free_anode(alloc_node);
-
-                struct rb_node *cutoff = alloc_from_fnode(get_fnode(alloc_node),
-                        n);
-                if (cutoff) {
-                    merge_anode(cutoff, rb_tree_get_nearlarger(cutoff));
-                }
-
-                free_anode(anode);
-            }
-
-            page_allocator_unlock();
-            return adr;
-        }
-
-        fnode = rb_tree_get_nearlarger(fnode);
-    }
+    // блок порядка k выровнен на 2^k страниц
+    uint32_t k = order_of(n);
+    uint32_t ka = order_of((align + pa.page_size - 1) / pa.page_size);
+    if (ka > k)
+        k = ka;
 
+    page_allocator_lock();
+    void *adr = alloc_pages(n, k);
     page_allocator_unlock();
-    return NULL;
+    return adr;
 }
 
 void page_free (void *adr)
@@ -607,6 +590,35 @@ void page_free (void *adr)
         return;
 
     page_allocator_lock();
-    free_anode(rb_tree_search(pa.all, (size_t) adr));
+    struct page_zone *z = zone_get((size_t) adr);
+    uint32_t p = z ? zone_page(z, (size_t) adr) : 0;
+    if (!z || !bit_get(z->head, p))
+        syshalt(SYSHALT_OOPS_ERROR);
+
+    struct page_share *share = share_find((size_t) adr);
+    if (share) {
+        if (--share->cnt) {
+            page_allocator_unlock();
+            return;
+        }
+        share_remove(share);
+    }
+
+    uint32_t n = alloc_size(z, p);
+#ifdef BUILD_SMP
+    if (!z->fixed && n == 1) {
+        page_allocator_unlock();
+        if (cache_put(adr)) {
+            if (share)
+                kfree(share);
+            return;
+        }
+        page_allocator_lock();
+    }
+#endif
+    release_pages(z, p, n);
     page_allocator_unlock();
+
+    if (share)
+        kfree(share);
 }
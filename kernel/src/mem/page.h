@@ -33,8 +33,7 @@ void* page_alloc (uint32_t n);
  *
  * \param pages     Запрашиваемое кол-во страниц памяти
  * \param align     Заданное выравнивание в байтах
- * \param realtime  1 - поиск блока двойного размера и возврат ошибки если такого нет
- *                  0 - попытка разместить выровненный блок в любом блоке большего размера - если такого нет - PANIC
+ * \param realtime  Не используется, блок парного аллокатора всегда выровнен на свой размер
  *
  * \return Указатель на выделенную память
  * \retval NULL Память не выделена
@@ -45,7 +44,8 @@ void* page_alloc_align (uint32_t pages, uint32_t align, uint32_t realtime);
  *
  * \param adr    Адрес начала памяти
  * \param pages  Запрашиваемое кол-во страниц памяти
- * \param multiple_access   Выделяемая память может выделяться повторно
+ * \param multiple_access   Выделяемая память может выделяться повторно тем же участком,
+ *                          освобождается последним вызовом page_free
  *
  * \return Указатель на выделенную память
  * \retval NULL Память не выделена
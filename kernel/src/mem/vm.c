@@ -13,6 +13,7 @@
 #include "common\error.h"
 
 #define DEFAULT_STACK_SIZE    mmu_page_size()
+#define TLB_RANGE_PAGES_MAX   64    // больший участок сбрасывается в TLB по ASID карты, а не по адресам
 
 static inline uint32_t get_dir (uint32_t va) { return va / mmu_dir_size(); }
 
@@ -29,6 +30,11 @@ static struct stat {
 
 static kobject_lock_t mmulock;
 
+// Учет сегментов, разделяемых между картами: seg->ref и seg->shared.
+// Карты владельца и получателей защищены разными блокировками, поэтому учет
+// защищается отдельно, блокировка захватывается последней
+static kobject_lock_t seglock;
+
 static inline void mmu_lock ()
 {
     kobject_lock(&mmulock);
@@ -39,6 +45,50 @@ static inline void mmu_unlock ()
     kobject_unlock(&mmulock);
 }
 
+/* Записи TLB всех карт неглобальные и помечаются ASID карты, поэтому смена карты
+ не сбрасывает TLB. В asid карты старшие биты - поколение, младшие ASID_BITS - аппаратный ASID.
+ ASID 0 резервирован на время смены таблицы. Карта получает новый ASID, если ее поколение
+ устарело. При исчерпании ASID начинается новое поколение, каждое ядро сбрасывает TLB
+ перед первой загрузкой карты после смены поколения */
+static struct {
+    kobject_lock_t lock;
+    uint32_t gen;
+    uint32_t next;
+    uint32_t flush;         // ядра, еще не сбросившие TLB после смены поколения
+} asids;
+
+static uint32_t asid_get (struct mmap *map)
+{
+    uint32_t core = cpu_get_core_id();
+
+    kobject_lock(&asids.lock);
+    if ((map->asid & ~ASID_MASK) != asids.gen) {
+        if (asids.next > ASID_MASK) {
+            asids.gen += 1 << ASID_BITS;
+            if (!asids.gen)
+                asids.gen = 1 << ASID_BITS;
+            asids.next = 1;
+            asids.flush = (1 << NUM_CORE) - 1;
+        }
+        map->asid = asids.gen | asids.next++;
+    }
+    if (asids.flush & (1 << core)) {
+        asids.flush &= ~(1 << core);
+        flush_tlb();
+    }
+    kobject_unlock(&asids.lock);
+    return map->asid & ASID_MASK;
+}
+
+/* Сброс записей TLB карты, ASID устаревшего поколения уже сброшены сменой поколения */
+static void asid_flush (struct mmap *map)
+{
+    kobject_lock(&asids.lock);
+    if ((map->asid & ~ASID_MASK) == asids.gen)
+        flush_tlb_asid(map->asid);
+    kobject_unlock(&asids.lock);
+}
+
 static uint32_t flush_tlb_flags[NUM_CORE] = { 0 };
 
 static void flush_tlb_core (uint32_t core)
@@ -59,20 +109,48 @@ static void flush_tlb_smp (struct mmap *map)
         ;
 }
 
-static void map_page (uint32_t *entry, uint32_t va, mem_attributes_t attr)
+/* Записи таблиц изменяются без сброса TLB, mmap и unmap сбрасывают TLB
+ один раз на весь сегмент (flush_map_tlb) */
+static void flush_map_tlb (struct mmap *map, uint32_t va, size_t pages)
+{
+    if (!pages)
+        return;
+    if (pages <= TLB_RANGE_PAGES_MAX) {
+        flush_tlb_range(va, pages);
+    } else if (map == kproc.mmap) {
+        flush_tlb_all();
+    } else {
+        asid_flush(map);
+        flush_icache();
+    }
+}
+
+/* Число страниц участка от va, лежащих в одной таблице второго уровня */
+static inline size_t dir_pages (uint32_t va, size_t pages)
 {
-    uint8_t shift = (va % mmu_dir_size()) / mmu_page_size();
+    size_t left = (mmu_dir_size() - va % mmu_dir_size()) / mmu_page_size();
+    return (pages < left) ? pages : left;
+}
+
+/* Страницы процесса отображаются большими страницами 64K там, где позволяет выравнивание.
+ Таблица, разделяемая с ядром (kpgd), восстанавливается из таблицы ядра по отдельным записям,
+ поэтому в ней используются только малые страницы */
+static void map_pages (struct pgd *pgd, uint32_t va, size_t pages, mem_attributes_t attr)
+{
+    uint32_t shift = (va % mmu_dir_size()) / mmu_page_size();
     mmu_lock();
-    mmu_set_pgte(entry + shift, va, attr);
-    flush_tlb();
+    if (pgd->kpgd)
+        mmu_set_pgtes(pgd->pgt + shift, va, pages, attr, true);
+    else
+        mmu_set_lpgtes(pgd->pgt + shift, va, pages, attr, true);
     mmu_unlock();
 }
 
-static void unmap_page (uint32_t *entry)
+static void unmap_pages (uint32_t *pgt, uint32_t va, size_t pages)
 {
+    uint32_t shift = (va % mmu_dir_size()) / mmu_page_size();
     mmu_lock();
-    mmu_set_fault(entry);
-    flush_tlb();
+    mmu_set_faults(pgt + shift, pages);
     mmu_unlock();
 }
 
@@ -80,15 +158,13 @@ static void map_pagetable (uint32_t va, uint32_t *pgt)
 {
     mmu_lock();
     mmu_set_pgt(mmu_get_tbl() + get_dir(va), pgt);
-    flush_tlb();
     mmu_unlock();
 }
 
 static void map_dir (uint32_t va, mem_attributes_t attr)
 {
     mmu_lock();
-    mmu_set_dir(mmu_get_tbl() + get_dir(va), va, attr);
-    flush_tlb();
+    mmu_set_dir(mmu_get_tbl() + get_dir(va), va, attr, true);
     mmu_unlock();
 }
 
@@ -96,7 +172,6 @@ static void unmap_dir (uint32_t va)
 {
     mmu_lock();
     mmu_set_fault(mmu_get_tbl() + get_dir(va));
-    flush_tlb();
     mmu_unlock();
 }
 
@@ -117,6 +192,17 @@ static bool seg_dir (const struct seg *seg)
     return (!((uint32_t) seg->adr % mmu_dir_size()) && !(seg->size % mmu_dir_size())) ? true : false;
 }
 
+/* Выравнивание участка из pages страниц под наибольшую запись MMU, которой он может быть
+ отображен: секция для участка из целых секций, большая страница для участка не меньше нее */
+static size_t seg_align (size_t pages)
+{
+    if (pages >= mmu_page_in_dir() && !(pages % mmu_page_in_dir()))
+        return mmu_dir_size();
+    if (pages >= mmu_page_in_lpage())
+        return mmu_lpage_size();
+    return mmu_page_size();
+}
+
 static void* new_pagetable ()
 {
     ++stat.page_tables;
@@ -153,7 +239,9 @@ static int seg_insert (struct mmap *map, struct seg *seg)
     rb_node_set_key(node, (size_t) seg->adr);
     rb_tree_insert(map->segs, node);
     map->size += seg->size;
+    kobject_lock(&seglock);
     seg->ref++;
+    kobject_unlock(&seglock);
     return OK;
 }
 
@@ -165,7 +253,9 @@ static int seg_remove (struct mmap *map, struct seg *seg)
     map->size -= seg->size;
     rb_tree_remove(map->segs, node);
     kfree(node);
+    kobject_lock(&seglock);
     seg->ref--;
+    kobject_unlock(&seglock);
     return OK;
 }
 
@@ -224,21 +314,22 @@ static void init_pgt_from_kmap (struct pgd *pgd, struct pgd *kpgd)
     if (mmu_is_dir(&kpgd->entry)) {
         for (int i = 0; i < mmu_page_in_dir(); i++) {
             struct seg *seg = vm_seg_get(kmap, (void*)mmu_get_base_addr_dir(&kpgd->entry));
-            mmu_set_pgte(pgd->pgt + i, mmu_get_base_addr_dir(&kpgd->entry) + i * mmu_page_size(), seg->attr);
+            mmu_set_pgte(pgd->pgt + i, mmu_get_base_addr_dir(&kpgd->entry) + i * mmu_page_size(), seg->attr, true);
         }
     } else {
+        // копии записей ядра в таблице процесса не глобальные, как и записи самого процесса
         memcpy(pgd->pgt, kpgd->pgt, mmu_pagetable_size());
+        mmu_set_pgtes_ng(pgd->pgt, mmu_page_in_dir());
     }
     pgd->kpgd = kpgd;
 }
 
-static void map_kdir (uint32_t va, mem_attributes_t attr)
+static void map_kdir (uint32_t va, mem_attributes_t attr, bool ng)
 {
     mmu_lock();
     for (int i = 0; i < get_mmutbl_pool_size(); i++) {
-        mmu_set_dir(get_mmutbl_pool(i) + get_dir(va), va, attr);
+        mmu_set_dir(get_mmutbl_pool(i) + get_dir(va), va, attr, ng);
     }
-    flush_tlb();
     mmu_unlock();
 }
 
@@ -248,21 +339,41 @@ static void map_kpagetable (uint32_t va, uint32_t *pgt)
     for (int i = 0; i < get_mmutbl_pool_size(); i++) {
         mmu_set_pgt(get_mmutbl_pool(i) + get_dir(va), pgt);
     }
-    flush_tlb();
     mmu_unlock();
 }
 
-static void map_kpage (uint32_t va, mem_attributes_t attr)
+static void map_kpages (uint32_t va, size_t pages, mem_attributes_t attr, bool ng)
 {
-    uint8_t shift = (va % mmu_dir_size()) / mmu_page_size();
+    uint32_t shift = (va % mmu_dir_size()) / mmu_page_size();
     mmu_lock();
     for (int i = 0; i < get_mmutbl_pool_size(); i++) {
-        mmu_set_pgte(((uint32_t *)mmu_get_base_addr_dir(get_mmutbl_pool(i) + get_dir(va))) + shift, va, attr);
+        mmu_set_pgtes(((uint32_t *)mmu_get_base_addr_dir(get_mmutbl_pool(i) + get_dir(va))) + shift, va, pages, attr, ng);
     }
-    flush_tlb();
     mmu_unlock();
 }
 
+/* Записи ядра глобальные, кроме директорий, пересекающихся с отображениями процессов:
+ глобальная запись ядра, загруженная в TLB в другом процессе, перекрыла бы отличающуюся
+ запись процесса по тому же адресу. Такая директория ядра навсегда становится не глобальной */
+static void kdir_set_ng (struct pgd *kpgd, uint32_t va)
+{
+    if (kpgd->ng)
+        return;
+    kpgd->ng = true;
+    if (mmu_is_dir(&kpgd->entry)) {
+        uint32_t dir_va = mmu_get_base_addr_dir(&kpgd->entry);
+        struct seg *seg = vm_seg_get(kmap, (void*)dir_va);
+        mmu_set_dir(&kpgd->entry, dir_va, seg->attr, true);
+        map_kdir(dir_va, seg->attr, true);
+    } else {
+        // таблица страниц директории ядра общая для всех таблиц пула
+        mmu_lock();
+        mmu_set_pgtes_ng(kpgd->pgt, mmu_page_in_dir());
+        mmu_unlock();
+    }
+    flush_tlb_range(va - va % mmu_dir_size(), mmu_page_in_dir());
+}
+
 void mmap (struct mmap *map, const struct seg *seg)
 {
     uint32_t va = (uint32_t) seg->adr;
@@ -275,9 +386,9 @@ void mmap (struct mmap *map, const struct seg *seg)
 
         if (seg_dir(seg)) {
             if (map == kproc.mmap || !rb_tree_search(kmap->pgds, get_dir(va))) {
-                mmu_set_dir(&pgd->entry, va, attr);
+                mmu_set_dir(&pgd->entry, va, attr, (map != kproc.mmap) || pgd->ng);
                 if (map == kproc.mmap) {
-                    map_kdir(va, attr);
+                    map_kdir(va, attr, pgd->ng);
                 } else if (active_map(map)) {
                     map_dir(va, attr);
                 }
@@ -294,6 +405,7 @@ void mmap (struct mmap *map, const struct seg *seg)
             if (map != kproc.mmap) {
                 struct rb_node *kmap_node = rb_tree_search(kmap->pgds, get_dir(va));
                 if (kmap_node) {
+                    kdir_set_ng((struct pgd*)(&kmap_node->data), va);
                     init_pgt_from_kmap(pgd, (struct pgd*)(&kmap_node->data));
                 }
             }
@@ -306,76 +418,81 @@ void mmap (struct mmap *map, const struct seg *seg)
             }
         }
 
-        do {
-            if (map == kproc.mmap)
-                map_kpage(va, attr);
-            else
-                map_page(pgd->pgt, va, attr);
+        size_t n = dir_pages(va, pages);
+        if (map == kproc.mmap)
+            map_kpages(va, n, attr, pgd->ng);
+        else
+            map_pages(pgd, va, n, attr);
 
-            ++pgd->cnt;
-            va += mmu_page_size();
-        } while (--pages && ((va % mmu_dir_size()) != 0));
+        pgd->cnt += n;
+        va += n * mmu_page_size();
+        pages -= n;
     }
+    flush_map_tlb(map, (uint32_t) seg->adr, seg->size / mmu_page_size());
     seg_insert(map, (struct seg*)seg);
 
-    if (map != cur_map[cpu_get_core_id()].map && map->mmu_pool != MAP_NO_POOL) {
-        release_mmutbl_pool(map->mmu_pool);
-        map->mmu_pool = MAP_NO_POOL;
-    }
+    if (map != cur_map[cpu_get_core_id()].map && map->mmu_pool != MAP_NO_POOL)
+        release_mmutbl_pool(map);
 
     map_unlock(map);
 }
 
-static void unmap_kpage (uint32_t *entry, struct pgd *pgd, uint32_t va)
+static void unmap_kpages (struct pgd *pgd, uint32_t va, size_t pages)
 {
+    uint32_t shift = (va % mmu_dir_size()) / mmu_page_size();
+    mmu_lock();
     if (pgd->kpgd->pgt) {
-        uint8_t shift = (va % mmu_dir_size()) / mmu_page_size();
-        memcpy(entry, pgd->kpgd->pgt + shift, sizeof(*entry));
+        memcpy(pgd->pgt + shift, pgd->kpgd->pgt + shift, pages * sizeof(*pgd->pgt));
+        mmu_set_pgtes_ng(pgd->pgt + shift, pages);
     } else {
         struct seg *seg = vm_seg_get(kmap, (void*)mmu_get_base_addr_dir(&pgd->kpgd->entry));
-        mmu_set_pgte(entry, va, seg->attr);
+        mmu_set_pgtes(pgd->pgt + shift, va, pages, seg->attr, true);
     }
+    mmu_unlock();
 }
 
 static void unmap (struct mmap *map, struct seg *seg)
 {
     uint32_t va = (uint32_t) seg->adr;
+    uint32_t flush_va = va;     // начало участка, еще не сброшенного в TLB
     size_t pages = seg->size / mmu_page_size();
 
     map_lock(map);
     while (pages > 0) {
+        uint32_t dir_va = va;
         struct pgd *pgd = get_pgd(map, get_dir(va));
         if (seg_dir(seg)) {
             pgd->cnt = 0;
             va += mmu_dir_size();
             pages -= mmu_page_in_dir();
         } else {
-            do {
-                uint8_t shift = (uint8_t)((va % mmu_dir_size()) / mmu_page_size());
-
-                // страницы пересакаются с ядром - унмапить хитро :)
-                if (pgd->kpgd) {
-                    // TODO
-                    unmap_kpage(pgd->pgt + shift, pgd, va);
-                } else
-                    unmap_page(pgd->pgt + shift);
-                --pgd->cnt;
-                va += mmu_page_size();
-            } while (--pages && ((va % mmu_dir_size()) != 0));
+            size_t n = dir_pages(va, pages);
+
+            // страницы пересакаются с ядром - унмапить хитро :)
+            if (pgd->kpgd) {
+                // TODO
+                unmap_kpages(pgd, va, n);
+            } else
+                unmap_pages(pgd->pgt, va, n);
+            pgd->cnt -= n;
+            va += n * mmu_page_size();
+            pages -= n;
         }
 
         if (!pgd->cnt) {
             if (!pgd->kpgd)
-                unmap_dir(va);
-            free_pgd(map->pgds, pgd, get_dir(va));
+                unmap_dir(dir_va);
+            // таблица освобождается только после сброса TLB по снятым с нее страницам
+            flush_map_tlb(map, flush_va, (va - flush_va) / mmu_page_size());
+            flush_va = va;
+            free_pgd(map->pgds, pgd, get_dir(dir_va));
         }
     }
+    flush_map_tlb(map, flush_va, (va - flush_va) / mmu_page_size());
     seg_remove(map, seg);
 
-    if (map != cur_map[cpu_get_core_id()].map && map->mmu_pool != MAP_NO_POOL) {
-        release_mmutbl_pool(map->mmu_pool);
-        map->mmu_pool = MAP_NO_POOL;
-    }
+    if (map != cur_map[cpu_get_core_id()].map && map->mmu_pool != MAP_NO_POOL)
+        release_mmutbl_pool(map);
 
     map_unlock(map);
 }
@@ -415,28 +532,43 @@ static void free_mmu_pgd (struct rb_node *node)
     free_mmu_pgd(next_node);
 }
 
-static void free_map_segs (struct rb_node *node)
+static void free_map_segs (struct mmap *map, struct rb_node *node)
 {
     if (!node)
         return;
     struct rb_node *next_node = NULL;
     if (rb_tree_get_next(node, &next_node)) {
-        free_map_segs(next_node);
+        free_map_segs(map, next_node);
         next_node = NULL;
     }
     struct seg *seg = rb_node_get_data(node);
-    seg_free(seg);
-    kfree(seg);
+    if (seg->map == map) {
+        seg_free(seg);
+        kfree(seg);
+    } else {
+        // расшаренный из другой карты сегмент остается у владельца, удаляется только учет
+        kobject_lock(&seglock);
+        struct rb_node *share_node = seg->shared ? rb_tree_search(seg->shared, (size_t)map) : NULL;
+        if (share_node) {
+            rb_tree_remove(seg->shared, share_node);
+        }
+        seg->ref--;
+        kobject_unlock(&seglock);
+        if (share_node) {
+            kfree(share_node);
+        }
+    }
     kfree(node);
-    free_map_segs(next_node);
+    free_map_segs(map, next_node);
 }
 
 void vm_map_terminate (struct mmap *map)
 {
-    release_mmutbl_pool(map->mmu_pool);
+    release_mmutbl_pool(map);
+    asid_flush(map);
     free_mmu_pgd(rb_tree_get_min(map->pgds));
     kfree(map->pgds);
-    free_map_segs(rb_tree_get_min(map->segs));
+    free_map_segs(map, rb_tree_get_min(map->segs));
     kfree(map->segs);
     kfree(map);
     --stat.maps;
@@ -453,6 +585,7 @@ struct mmap* vm_map_create ()
     rb_tree_set_mode(map->segs, RBTREE_BY_KEY_VALUE);
     map->size = 0;
     map->mmu_pool = MAP_NO_POOL;
+    map->asid = 0;
     kobject_lock_init(&map->lock);
     ++stat.maps;
     return map;
@@ -494,20 +627,35 @@ int vm_seg_share (struct mmap *map_to, struct seg *seg)
     if (seg->map == map_to)
         return ERROR(ERR_ILLEGAL_ARGS);
 
+    struct rb_node *new_node = kmalloc(sizeof(*new_node));
+    // дерево учета создается однажды и живет вместе с сегментом
+    struct rb_tree *new_tree = seg->shared ? NULL : kmalloc(sizeof(*new_tree));
+    rb_node_init(new_node);
+    rb_node_set_key(new_node, (size_t)map_to);
+    set_share_cnt(new_node, 1);
+    if (new_tree) {
+        rb_tree_init(new_tree);
+        rb_tree_set_mode(new_tree, RBTREE_BY_KEY_VALUE);
+    }
+
+    kobject_lock(&seglock);
+    if (!seg->shared) {
+        seg->shared = new_tree;
+        new_tree = NULL;
+    }
     struct rb_node *node = rb_tree_search(seg->shared, (size_t)map_to);
     if (node) {
         inc_share_cnt(node);
     } else {
-        struct rb_node *new_node = kmalloc(sizeof(*new_node));
-        rb_node_init(new_node);
-        rb_node_set_key(new_node, (size_t)map_to);
-        set_share_cnt(new_node, 1);
-        if (!seg->shared) {
-            seg->shared = kmalloc(sizeof(*(seg->shared)));
-            rb_tree_init(seg->shared);
-            rb_tree_set_mode(seg->shared, RBTREE_BY_KEY_VALUE);
-        }
         rb_tree_insert(seg->shared, new_node);
+    }
+    kobject_unlock(&seglock);
+
+    if (new_tree)
+        kfree(new_tree);
+    if (node) {
+        kfree(new_node);
+    } else {
         mmap(map_to, seg);
     }
     return OK;
@@ -515,14 +663,19 @@ int vm_seg_share (struct mmap *map_to, struct seg *seg)
 
 int vm_seg_unshare (struct mmap *map_from, struct seg *seg)
 {
-    struct rb_node *node = rb_tree_search(seg->shared, (size_t)map_from);
-    if (!node)
+    kobject_lock(&seglock);
+    struct rb_node *node = seg->shared ? rb_tree_search(seg->shared, (size_t)map_from) : NULL;
+    if (!node) {
+        kobject_unlock(&seglock);
         return ERROR(ERR);
+    }
     dec_share_cnt(node);
     if (get_share_cnt(node)) {
+        kobject_unlock(&seglock);
         return OK;
     }
     rb_tree_remove(seg->shared, node);
+    kobject_unlock(&seglock);
     kfree(node);
     unmap(map_from, seg);
     return OK;
@@ -571,7 +724,14 @@ int vm_map (struct process *proc, void *adr, size_t pages, mem_attributes_t attr
 
 void* vm_alloc (struct process *proc, size_t pages, mem_attributes_t attr)
 {
-    void *adr = page_alloc(pages);
+    void *adr = NULL;
+    size_t align = seg_align(pages);
+
+    // выровненный участок займет меньше записей TLB, при нехватке такого - любой
+    if (align > mmu_page_size())
+        adr = page_alloc_align(pages, align, 0);
+    if (!adr)
+        adr = page_alloc(pages);
     if (!adr)
         return NULL;
 
@@ -634,7 +794,7 @@ static void load_map (struct mmap *map)
     int i = load_to_mmutbl_pool(map);
     cur_map[cpu_get_core_id()].map = map;
     cur_map[cpu_get_core_id()].pool = i;
-    mmu_switch(get_mmutbl_pool(i));
+    mmu_switch_asid(get_mmutbl_pool(i), asid_get(map));
     map_unlock(map);
 }
 
@@ -659,7 +819,6 @@ void vm_switch (struct mmap *unload, struct mmap *load)
         return;
     unload_map(unload);
     load_map(load);
-    flush_tlb();
 }
 
 void vm_enable ()
@@ -677,8 +836,14 @@ static void pages_init ()
 void vm_init ()
 {
     kobject_lock_init(&mmulock);
+    kobject_lock_init(&seglock);
     init_mmutbl_pool();
 
+    kobject_lock_init(&asids.lock);
+    asids.gen = 1 << ASID_BITS;
+    asids.next = 1;
+    asids.flush = 0;
+
     for (int i = 0; i < NUM_CORE; i++) {
         cur_map[i].map = NULL;
         cur_map[i].pool = MAP_NO_POOL;
@@ -754,6 +919,8 @@ void vm_get_info (struct mem_info *info)
     info->maps = stat.maps;
     info->segs = stat.segs;
     info->pgts = stat.page_tables;
+    info->mmutbl.size = get_mmutbl_pool_size();
+    get_mmutbl_pool_stat(&info->mmutbl.hits, &info->mmutbl.misses, &info->mmutbl.evictions);
 }
 
 void map_kmap (struct process *proc, void *adr)
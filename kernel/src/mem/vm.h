@@ -25,6 +25,7 @@ struct pgd {
     struct pgd *kpgd;
     uint32_t cnt;    // кол-во использованных страниц в директории
     uint32_t *pgt;   // для простого доступа в таблице страниц директории
+    bool ng;         // директория ядра пересекается с отображением процесса, записи не глобальные
 };
 
 /** типы выделяемых сегментов */
@@ -37,6 +38,7 @@ enum seg_type {
 struct mmap {
     kobject_lock_t lock;
     int mmu_pool;           // Индекс пула
+    uint32_t asid;          // Поколение и ASID, назначенные при загрузке, 0 - не назначались
     struct rb_tree *pgds;   // Дерево записей для корректировки L1 при загрузке
     struct rb_tree *segs;
     size_t size;
@@ -91,6 +93,9 @@ int vm_map_lookup (struct mmap *map, void *adr, size_t size);
 void vm_switch (struct mmap *from, struct mmap *to);
 
 /** \brief Динамическое выделение памяти.
+ *
+ * Участок из целых секций выравнивается на секцию, не меньший большой страницы (64K) -
+ * на большую страницу, если есть свободный блок с таким выравниванием.
  *
  * \param map    Карта памяти, в которую выделяется память
  * \param pages  Запрашиваемое кол-во страниц памяти
@@ -0,0 +1,493 @@
+#include <arch.h>
+#include "common/resm.h"
+#include "mem\kmem.h"
+#include "syn\ksyn.h"
+#include "syn\syn.h"
+#include "ipc\channel.h"
+#include "interrupt.h"
+#include "sched.h"
+#include "proc.h"
+#include "port.h"
+
+struct port_link {
+    struct port_link *next;         // список связей порта
+    struct port_link *src_next;     // список связей источника
+    struct port_link **src;         // голова списка источника, NULL - прерывание или источник закрыт
+    void *obj;                      // канал, семафор или контекст прерывания, NULL - источник закрыт
+    struct port *port;
+    port_event_t ev;                // параметры добавления, флаги - только PORT_EDGE
+    uint32_t count;                 // события источника после предыдущей выдачи
+    bool hup;                       // источник закрыт, признак еще не выдан
+    int prio;                       // приоритет прерывания (приоритет добавившего потока)
+};
+
+struct port {
+    struct process *owner;
+    int id;
+    struct port_link *links;
+    uint32_t seq;                   // номер события, увеличивается при каждом оповещении
+    struct thread *wait_first;      // ожидающие потоки, очередь защищена wlock
+    struct thread *wait_last;
+};
+
+// связи всех портов, списки связей источников и счетчики событий;
+// захватывается также из обработчика прерываний
+static spinlock_t plock;
+
+// очереди ожидающих потоков всех портов; порядок захвата как у очередей синхронных
+// сообщений: sched_lock, kevent_store_lock, wlock - так же их захватывает диспетчер
+// при таймауте ожидания (port_wait_timeout), plock захватывается раньше всех
+static spinlock_t wlock;
+
+void port_init() {
+    spinlock_init(&plock);
+    spinlock_init(&wlock);
+}
+
+static inline void waiters_lock() {
+    sched_lock();
+    kevent_store_lock();
+    spinlock_lock(&wlock);
+}
+
+static inline void waiters_unlock() {
+    spinlock_unlock(&wlock);
+    kevent_store_unlock();
+    sched_unlock();
+}
+
+static void wait_push(struct port *port, struct thread *thr) {
+    if(port->wait_first == NULL) {
+        port->wait_first = thr;
+    } else {
+        thread_block_list_insert(port->wait_last, thr);
+    }
+    port->wait_last = thr;
+}
+
+static void wait_remove(struct port *port, struct thread *thr) {
+    if(port->wait_first == thr) {
+        port->wait_first = thr->block_list.next;
+    }
+    if(port->wait_last == thr) {
+        port->wait_last = thr->block_list.prev;
+    }
+    thread_block_list_remove(thr);
+}
+
+// Пробуждение всех ожидающих порт потоков, выполняется под waiters_lock.
+// Поток сам выбирает готовые события после пробуждения
+static bool wake_waiters(struct port *port) {
+    struct thread *thr;
+    bool res = false;
+    while((thr = port->wait_first) != NULL) {
+        wait_remove(port, thr);
+        kevent_cancel_locked(thr->block_evt);
+        thr->block_evt = NULL;
+        thr->state = READY;
+        thr->block.object.ref = NULL;
+        enqueue(thr);
+        res = true;
+    }
+    return res;
+}
+
+// Событие источника, выполняется под plock
+static void link_event(struct port_link *l) {
+    l->count++;
+    l->port->seq++;
+}
+
+// Готовность источника, выполняется под plock
+static bool link_ready(struct port_link *l) {
+    struct channel *ch;
+    if(l->obj == NULL) {
+        return false;
+    }
+    if((l->ev.flags & PORT_EDGE) || (l->ev.type == PORT_SRC_IRQ)) {
+        return l->count != 0;
+    }
+    switch(l->ev.type) {
+    case PORT_SRC_CHANNEL:
+        ch = l->obj;
+        return (ch->unread > 0) || (ch->pulse.count > 0) || (ch->msg_send.head != NULL);
+    case PORT_SRC_SYN:
+        return atomic_read(((semaphore_t *)l->obj)->cnt) > 0;
+    default:
+        return false;
+    }
+}
+
+// Выборка готовых событий порта, выполняется под plock
+static int collect(struct port *port, port_event_t *ev, int n) {
+    struct port_link *l;
+    uint32_t flags;
+    int cnt = 0;
+    for(l = port->links; (l != NULL) && (cnt < n); l = l->next) {
+        if(l->hup) {
+            flags = PORT_HUP;
+            l->hup = false;
+        } else if(link_ready(l)) {
+            flags = PORT_IN;
+        } else {
+            continue;
+        }
+        ev[cnt] = l->ev;
+        ev[cnt].flags = flags;
+        ev[cnt].count = l->count;
+        l->count = 0;
+        cnt++;
+    }
+    return cnt;
+}
+
+static struct port_link *link_find(struct port *port, int type, int id) {
+    struct port_link *l;
+    for(l = port->links; l != NULL; l = l->next) {
+        if((l->ev.type == type) && (l->ev.id == id)) {
+            break;
+        }
+    }
+    return l;
+}
+
+static void link_insert(struct port_link *l) {
+    uint32_t s = interrupt_disable_s();
+    spinlock_lock(&plock);
+    if(l->src != NULL) {
+        l->src_next = *l->src;
+        *l->src = l;
+    }
+    l->next = l->port->links;
+    l->port->links = l;
+    if(l->count != 0) {
+        l->port->seq++;
+    }
+    spinlock_unlock(&plock);
+    interrupt_enable_s(s);
+}
+
+static void link_unlink(struct port_link *l) {
+    struct port_link **pl;
+    uint32_t s = interrupt_disable_s();
+    spinlock_lock(&plock);
+    if(l->src != NULL) {
+        for(pl = l->src; *pl != l; pl = &(*pl)->src_next);
+        *pl = l->src_next;
+    }
+    for(pl = &l->port->links; *pl != l; pl = &(*pl)->next);
+    *pl = l->next;
+    spinlock_unlock(&plock);
+    interrupt_enable_s(s);
+}
+
+// Удаление связи из порта с освобождением источника, выполняется под блокировкой порта
+static void link_remove(struct port_link *l) {
+    struct interrupt_context *irqctx;
+    if(l->ev.type == PORT_SRC_IRQ) {
+        // после освобождения прерывания обработчик связь не получает
+        irqctx = interrupt_get_context(l->ev.id);
+        kobject_lock(&irqctx->lock);
+        interrupt_disable(l->ev.id);
+        interrupt_release(l->ev.id);
+        kobject_unlock(&irqctx->lock);
+    }
+    link_unlink(l);
+    if(l->ev.type == PORT_SRC_SYN) {
+        // ссылка на семафор сохраняется и после его удаления до удаления связи
+        syn_sem_put(l->ev.id);
+    }
+    kfree(l);
+}
+
+static int link_add(struct thread *thr, struct port *port, const port_event_t *ev) {
+    struct interrupt_context *irqctx;
+    struct channel *ch;
+    semaphore_t *sem;
+    struct port_link *l;
+    int res = OK;
+
+    if(link_find(port, ev->type, ev->id) != NULL) {
+        return ERR_BUSY;
+    }
+    l = kmalloc(sizeof(struct port_link));
+    if(l == NULL) {
+        return ERR_NO_MEM;
+    }
+    l->next = NULL;
+    l->src_next = NULL;
+    l->src = NULL;
+    l->obj = NULL;
+    l->port = port;
+    l->ev = *ev;
+    l->ev.flags &= PORT_EDGE;
+    l->ev.count = 0;
+    l->count = 0;
+    l->hup = false;
+    l->prio = thr->prio;
+
+    switch(ev->type) {
+    case PORT_SRC_CHANNEL:
+        // наблюдать можно только собственные каналы процесса
+        ch = lock_channel(thr->proc, ev->id);
+        if(ch == NULL) {
+            res = ERR_ILLEGAL_ARGS;
+            break;
+        }
+        if(ch->zombie || (ch->flags & (CHANNEL_SHARED_RING | CHANNEL_MULTICAST))) {
+            res = ERR_ILLEGAL_ARGS;
+        } else {
+            l->obj = ch;
+            l->src = &ch->ports;
+            // уже накопленные сообщения - начальное событие
+            l->count = ch->unread + ch->pulse.count + ((ch->msg_send.head != NULL) ? 1 : 0);
+            link_insert(l);
+        }
+        unlock_channel(ch);
+        break;
+    case PORT_SRC_SYN:
+        sem = syn_sem_get(ev->id, thr->proc);
+        if(sem == NULL) {
+            res = ERR_ILLEGAL_ARGS;
+            break;
+        }
+        l->obj = sem;
+        l->src = &sem->ports;
+        l->count = (atomic_read(sem->cnt) > 0) ? 1 : 0;
+        link_insert(l);
+        break;
+    case PORT_SRC_IRQ:
+        irqctx = interrupt_get_context(ev->id);
+        if(irqctx == NULL) {
+            res = ERR_ILLEGAL_ARGS;
+            break;
+        }
+        l->obj = irqctx;
+        l->ev.flags = PORT_EDGE;
+        kobject_lock(&irqctx->lock);
+        // связь включается в порт до подключения обработчика
+        link_insert(l);
+        res = interrupt_hook(ev->id, l, INTERRUPT_PORT);
+        kobject_unlock(&irqctx->lock);
+        if(res != OK) {
+            link_unlink(l);
+            res = ERR_BUSY;
+        }
+        break;
+    default:
+        res = ERR_ILLEGAL_ARGS;
+        break;
+    }
+    if(res != OK) {
+        kfree(l);
+    }
+    return res;
+}
+
+int port_create(struct process *p) {
+    struct res_header *hdr;
+    struct port *port;
+    int id;
+
+    id = resm_create_and_lock(&p->ports, RES_ID_GENERATE, sizeof(struct port), &hdr);
+    if(id <= 0) {
+        return id;
+    }
+    port = GET_RES_DATA(hdr);
+    hdr->ref = port;
+    port->owner = p;
+    port->id = id;
+    port->links = NULL;
+    port->seq = 0;
+    port->wait_first = NULL;
+    port->wait_last = NULL;
+    resm_unlock(&p->ports, hdr);
+    return id;
+}
+
+// Освобождение порта: ожидающие потоки будятся и не находят порт (ERR_DEAD)
+static void port_release(struct port *port) {
+    while(port->links != NULL) {
+        link_remove(port->links);
+    }
+    waiters_lock();
+    wake_waiters(port);
+    waiters_unlock();
+}
+
+int port_delete(struct process *p, int id) {
+    struct res_header *hdr;
+    if(resm_search_and_lock(&p->ports, id, &hdr) != OK) {
+        return ERR;
+    }
+    port_release(resm_get_ref(hdr));
+    resm_remove_locked(&p->ports, hdr);
+    return OK;
+}
+
+int port_ctl(struct thread *thr, int id, int op, const port_event_t *ev) {
+    struct res_header *hdr;
+    struct port *port;
+    struct port_link *l;
+    int res;
+
+    if(ev == NULL) {
+        return ERR_ILLEGAL_ARGS;
+    }
+    if(resm_search_and_lock(&thr->proc->ports, id, &hdr) != OK) {
+        return ERR;
+    }
+    port = resm_get_ref(hdr);
+    switch(op) {
+    case PORT_ADD:
+        res = link_add(thr, port, ev);
+        break;
+    case PORT_DEL:
+        l = link_find(port, ev->type, ev->id);
+        if(l != NULL) {
+            link_remove(l);
+            res = OK;
+        } else {
+            res = ERR_ILLEGAL_ARGS;
+        }
+        break;
+    default:
+        res = ERR_ILLEGAL_ARGS;
+        break;
+    }
+    resm_unlock(&thr->proc->ports, hdr);
+    return res;
+}
+
+int port_wait(struct thread *thr, int id, port_event_t *ev, int n, uint64_t timeout) {
+    struct res_header *hdr;
+    struct port *port;
+    uint64_t deadline = TIMEOUT_INFINITY;
+    uint32_t seq, s;
+    int cnt;
+
+    if((ev == NULL) || (n <= 0)) {
+        return ERR_ILLEGAL_ARGS;
+    }
+    if(n > PORT_EVENTS_MAX) {
+        n = PORT_EVENTS_MAX;
+    }
+    if((timeout >= TIMEOUT_MIN) && (timeout != TIMEOUT_INFINITY)) {
+        deadline = systime() + timeout;
+    }
+    for(;;) {
+        if(resm_search_and_lock(&thr->proc->ports, id, &hdr) != OK) {
+            return ERR_DEAD;
+        }
+        port = resm_get_ref(hdr);
+        s = interrupt_disable_s();
+        spinlock_lock(&plock);
+        seq = port->seq;
+        cnt = collect(port, ev, n);
+        spinlock_unlock(&plock);
+        interrupt_enable_s(s);
+        if(cnt > 0) {
+            resm_unlock(&thr->proc->ports, hdr);
+            return cnt;
+        }
+        if((timeout < TIMEOUT_MIN) || ((deadline != TIMEOUT_INFINITY) && (systime() >= deadline))) {
+            resm_unlock(&thr->proc->ports, hdr);
+            return ERR_TIMEOUT;
+        }
+        waiters_lock();
+        if(port->seq != seq) {
+            // событие между выборкой и постановкой в очередь, повторяем выборку
+            waiters_unlock();
+            resm_unlock(&thr->proc->ports, hdr);
+            continue;
+        }
+        thread_port_block(thr, port);
+        thr->block_evt = NULL;
+        wait_push(port, thr);
+        if(deadline != TIMEOUT_INFINITY) {
+            thr->block_evt = kevent_insert(deadline, thr);
+        }
+        waiters_unlock();
+        // порт не удаляется, пока поток находится в очереди: удаление будит всех ожидающих
+        resm_unlock(&thr->proc->ports, hdr);
+        sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+    }
+}
+
+void port_wait_timeout(struct thread *thr) {
+    // диспетчер уже удерживает sched_lock и kevent_store_lock
+    spinlock_lock(&wlock);
+    wait_remove(thr->block.object.port, thr);
+    thr->state = READY;
+    thr->block.object.ref = NULL;
+    spinlock_unlock(&wlock);
+}
+
+void port_notify(struct port_link **list) {
+    struct port_link *l;
+    uint32_t s = interrupt_disable_s();
+    spinlock_lock(&plock);
+    if(*list != NULL) {
+        for(l = *list; l != NULL; l = l->src_next) {
+            link_event(l);
+        }
+        // связи и порты не освобождаются, пока удерживается plock
+        waiters_lock();
+        for(l = *list; l != NULL; l = l->src_next) {
+            wake_waiters(l->port);
+        }
+        waiters_unlock();
+    }
+    spinlock_unlock(&plock);
+    interrupt_enable_s(s);
+}
+
+void port_source_close(struct port_link **list) {
+    struct port_link *l;
+    uint32_t s = interrupt_disable_s();
+    spinlock_lock(&plock);
+    for(l = *list; l != NULL; l = l->src_next) {
+        l->obj = NULL;
+        l->src = NULL;
+        l->hup = true;
+        l->port->seq++;
+    }
+    waiters_lock();
+    for(l = *list; l != NULL; l = l->src_next) {
+        wake_waiters(l->port);
+    }
+    waiters_unlock();
+    *list = NULL;
+    spinlock_unlock(&plock);
+    interrupt_enable_s(s);
+}
+
+bool port_irq(const struct interrupt_context *info) {
+    struct port_link *l = info->handler;
+    bool res;
+    uint32_t s;
+    interrupt_disable(info->id);
+    s = interrupt_disable_s();
+    spinlock_lock(&plock);
+    link_event(l);
+    waiters_lock();
+    res = wake_waiters(l->port);
+    waiters_unlock();
+    spinlock_unlock(&plock);
+    interrupt_enable_s(s);
+    return res;
+}
+
+struct process *port_irq_owner(const struct interrupt_context *ctx, int *prio) {
+    struct port_link *l = ctx->handler;
+    *prio = l->prio;
+    return l->port->owner;
+}
+
+static void port_finalize(res_container_t *container, int id, struct res_header *hdr) {
+    port_release(resm_get_ref(hdr));
+}
+
+void port_proc_finalize(struct process *p) {
+    resm_container_free(&p->ports, port_finalize);
+}
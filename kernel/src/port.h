@@ -0,0 +1,63 @@
+#ifndef PORT_H_
+#define PORT_H_
+
+#include <os_types.h>
+
+struct process;
+struct thread;
+struct port;
+struct port_link;
+struct interrupt_context;
+
+/**
+ * Модуль портов ожидания (os_port_create).
+ * Порт размещается в контейнере ресурсов процесса-создателя (struct process.ports)
+ * и содержит связи с источниками событий: каналами процесса, разделяемыми семафорами
+ * и прерываниями. Связь одновременно включена в список источника, по которому
+ * источник оповещает порты (port_notify), поэтому поток, обслуживающий несколько
+ * источников, ожидает их одним системным вызовом без опроса.
+ * Списки связей изменяются под общей блокировкой модуля, очереди ожидающих порт
+ * потоков - под sched_lock, так как таймаут ожидания обрабатывается диспетчером.
+ */
+
+void port_init();
+
+int port_create(struct process *p);
+int port_delete(struct process *p, int id);
+int port_ctl(struct thread *thr, int id, int op, const port_event_t *ev);
+int port_wait(struct thread *thr, int id, port_event_t *ev, int n, uint64_t timeout);
+
+/**
+ * Прерывание ожидания порта по таймауту, вызывается из диспетчера задач под sched_lock
+ * и kevent_store_lock, очередь ожидающих дополнительно защищается спинлоком модуля
+ */
+void port_wait_timeout(struct thread *thr);
+
+/**
+ * Оповещение портов о событии источника
+ * @param list - список связей источника с портами
+ */
+void port_notify(struct port_link **list);
+
+/**
+ * Закрытие источника, связи остаются в портах до удаления и однократно
+ * выдаются с признаком PORT_HUP
+ * @param list - список связей источника с портами
+ */
+void port_source_close(struct port_link **list);
+
+/**
+ * Обработка прерывания, связанного с портом, вызывается из обработчика прерываний.
+ * Линия прерывания запрещается до ее разрешения потоком порта (os_irq_ctrl)
+ * @return true - разбужен поток, ожидающий порт
+ */
+bool port_irq(const struct interrupt_context *info);
+
+/**
+ * Процесс-владелец порта и приоритет прерывания, связанного с портом
+ */
+struct process *port_irq_owner(const struct interrupt_context *ctx, int *prio);
+
+void port_proc_finalize(struct process *p);
+
+#endif /* PORT_H_ */
@@ -12,6 +12,8 @@
 #include <syn/signal.h>
 #include <ipc/channel.h>
 #include <ipc/connection.h>
+#include "ktimer.h"
+#include "port.h"
 #include <common/namespace.h>
 
 static struct process *proc_tbl[PROCS_NUM + 1];
@@ -54,6 +56,32 @@ const mem_attributes_t proc_arg_pages_attr = {
     .shared = MEM_SHARED_OFF,
 };
 
+// Страница времени доступна процессам только для чтения, ядро публикует в ней время
+static const mem_attributes_t time_page_attr = {
+    .type = MEM_TYPE_NORMAL,
+    .exec = MEM_EXEC_NEVER,
+    .os_access = MEM_ACCESS_RW,
+    .process_access = MEM_ACCESS_RO,
+    .inner_cached = MEM_CACHED_WRITE_BACK,
+    .outer_cached = MEM_CACHED_WRITE_BACK,
+    .shared = MEM_SHARED_OFF,
+};
+
+// Страница регистров таймера с аппаратным счетчиком, также только для чтения
+static const mem_attributes_t time_counter_attr = {
+    .type = MEM_TYPE_DEVICE,
+    .exec = MEM_EXEC_NEVER,
+    .os_access = MEM_ACCESS_RW,
+    .process_access = MEM_ACCESS_RO,
+    .inner_cached = MEM_CACHED_OFF,
+    .outer_cached = MEM_CACHED_OFF,
+    .shared = MEM_SHARED_OFF,
+};
+
+static struct os_time_page *time_page;
+static struct seg *time_page_seg;
+static struct seg *time_counter_seg;
+
 //! Процесс не содержит потоков, не диспетчеризируется
 struct process kproc;
 
@@ -123,20 +151,39 @@ void proc_init_idle ()
     // здесь контекст не вытесняемый, но можно применять proc_init
     proc_init(&idle_hdr, &idle_attr, &kproc);
     idle_proc = proc_tbl[IDLE_PID];
-#ifndef BUILD_SMP
     // для каждого ядра создаем свой idle поток
     for (int i = 0; i < NUM_CORE - 1; i++) {
         thread_init(&idlethr_attr, idle_proc, &thr);
     }
-#endif
 }
 
 void proc_init_kernel ()
 {
     kproc.channels = kmalloc(sizeof(*kproc.channels));
     kproc.connections = kmalloc(sizeof(*kproc.connections));
-    resm_container_init(kproc.channels, MAX_CHANNEL_PROC, RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_INC_AGING);
-    resm_container_init(kproc.connections, MAX_CONNECTION_PROC, RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_INC_AGING);
+    resm_container_init(kproc.channels, MAX_CHANNEL_PROC, RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_TABLE);
+    resm_container_init(kproc.connections, MAX_CONNECTION_PROC, RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_TABLE);
+
+    // страница времени размещается в карте ядра и расшаривается всем процессам при создании,
+    // страница регистров таймера уже отображена в карте ядра, поэтому для процессов
+    // создается отдельный сегмент без размещения в карте ядра
+    time_page = vm_alloc(&kproc, 1, time_page_attr);
+    if (time_page == NULL) {
+        syshalt(SYSHALT_OOPS_ERROR);
+    }
+    memset(time_page, 0, PAGE_SIZE);
+    timer_set_time_page(time_page);
+    time_page_seg = vm_seg_get(kmap, time_page);
+    if (time_page->counter != NULL) {
+        // таймер может не публиковать счетчик, если его страницу нельзя открыть процессам
+        time_counter_seg = seg_create(kmap, (void *)((size_t)time_page->counter & ~(PAGE_SIZE - 1)),
+                PAGE_SIZE, time_counter_attr);
+    }
+}
+
+const struct os_time_page *proc_get_time_page ()
+{
+    return time_page;
 }
 
 /**
@@ -253,6 +300,13 @@ int proc_init (const struct proc_header *hdr, struct proc_attr *attr, struct pro
             return tmp;
         }
     }
+    if (p->mmap != kmap) {
+        // время без системного вызова через страницу времени
+        vm_seg_share(p->mmap, time_page_seg);
+        if (time_counter_seg != NULL) {
+            vm_seg_share(p->mmap, time_counter_seg);
+        }
+    }
 
     // теперь инициализация, ее вроде можно выполнить вне защищенного кода выше,
     // так как пока процесс не участвует в работе (ресурсы не захвачены и поток не запущен)
@@ -329,6 +383,10 @@ int proc_init (const struct proc_header *hdr, struct proc_attr *attr, struct pro
             RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_NOGEN);
     resm_container_init (&p->syns_opened, RES_CONTAINER_NUM_LIMIT_DEFAULT,
             RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_NOGEN);
+    resm_container_init (&p->timers, RES_CONTAINER_NUM_LIMIT_DEFAULT,
+            RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_INC_AGING);
+    resm_container_init (&p->ports, RES_CONTAINER_NUM_LIMIT_DEFAULT,
+            RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_INC_AGING);
 
     log_info("+pid %i '%s'; prio=%i, entry=0x%08lx\n\r", p->pid, hdr->pathname, p->prio, hdr->entry);
 
@@ -365,9 +423,9 @@ int proc_init (const struct proc_header *hdr, struct proc_attr *attr, struct pro
     }
 
     p->channels = kmalloc(sizeof(*p->channels));
-    resm_container_init(p->channels, MAX_CHANNEL_PROC, RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_INC_AGING);
+    resm_container_init(p->channels, MAX_CHANNEL_PROC, RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_TABLE);
     p->connections = kmalloc(sizeof(*p->connections));
-    resm_container_init(p->connections, MAX_CONNECTION_PROC, RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_INC_AGING);
+    resm_container_init(p->connections, MAX_CONNECTION_PROC, RES_CONTAINER_MEM_LIMIT_DEFAULT, RES_ID_GEN_STRATEGY_TABLE);
 
     attr->pid = p->pid;
     attr->prio = p->prio;
@@ -406,6 +464,9 @@ void proc_prepare_finalize(struct process *p, struct thread *last_thread)
     last_thread->substate = PROC_FINALIZE;     // NORMAL   -> PROC_FINALIZING
     send_signals_on_finalize(p, last_thread);
 
+    // таймеры и порты раньше каналов и объектов синхронизации, по которым они оповещают
+    ktimer_proc_finalize(p);
+    port_proc_finalize(p);
     close_channels(p);
     close_connections(p);
 
@@ -54,6 +54,12 @@ struct process {
     // управляется только модулем syn!
     res_container_t syns_opened;
 
+    // Таймеры процесса (os_timer_create), управляется только модулем ktimer!
+    res_container_t timers;
+
+    // Порты ожидания процесса (os_port_create), управляется только модулем port!
+    res_container_t ports;
+
     res_container_t *channels;
     res_container_t *connections;
 
@@ -109,6 +115,8 @@ namespace_t *get_proc_namespace();
 
 void proc_init_idle ();
 void proc_init_kernel ();
+/** \brief Страница времени, отображаемая во все процессы только для чтения */
+const struct os_time_page *proc_get_time_page ();
 
 
 /** \brief Проверка на идентичность двух процессов, то есть на то, что это один процесс.
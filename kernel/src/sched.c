@@ -32,26 +32,67 @@
 #include "common\utils.h"
 #include "syn\ksyn.h"
 #include "event.h"
+#include "ktimer.h"
+#include "ipc\msg.h"
+#include "port.h"
 
 extern char __stack_svc_end__[];
 static void *kernel_global_stack[NUM_CORE];
 static void *kernel_global_sp[NUM_CORE];
 
-// очередь готовых на выполнение потоков по приоритетам
-// TODO - переделать из массива на список
-static struct rdy_queue {
+// очередь готовых на выполнение потоков одного приоритета (двусвязный список)
+struct rdy_queue {
     struct thread *head;
     struct thread *tail;
-} rdy[PRIO_NUM];
+};
+
+// битовая карта непустых очередей, старший бит слова соответствует наивысшему
+// приоритету в слове, поэтому поиск непустой очереди выполняется через CLZ
+#define RDY_MAP_WORDS   ((PRIO_NUM + 31) >> 5)
+#define RDY_MAP_BIT(q)  (0x80000000UL >> ((q) & 31))
+
+// Набор очередей готовых потоков по приоритетам, у каждого ядра свой со своей блокировкой,
+// поэтому переключения потоков на разных ядрах не сериализуются одной общей блокировкой.
+// Без BUILD_SMP используется только набор ядра CPU_0.
+static struct runqueue {
+    kobject_lock_t lock;
+    struct rdy_queue q[PRIO_NUM];
+    uint32_t map[RDY_MAP_WORDS];
+    int nr;                         // число потоков в очередях
+} rq[NUM_CORE];
 
 // текущий выполняемый поток (на каждом ядре)
 static struct thread* run_thr[NUM_CORE];
 static uint64_t run_thr_tstamp[NUM_CORE];
 
+// поток, с которого выполнялось последнее переключение на ядре,
+// его контекст может быть еще не сохранен до следующего вызова sched_switch на этом ядре
+static struct thread* out_thr[NUM_CORE];
+
 // потоки бездействия
 static struct thread* idle_thr[NUM_CORE];
 
-static kobject_lock_t schedlock;
+// состояние флага прерываний до sched_lock на каждом ядре
+static uint32_t schedlock_state[NUM_CORE];
+
+#ifdef BUILD_TICKLESS
+// момент истечения кванта выполняемого потока на каждом ядре, 0 - без ограничения (idle)
+static uint64_t quantum_end[NUM_CORE];
+#endif
+
+#ifdef BUILD_SMP
+// вторичное ядро получает тик от собственного локального таймера, а не от CPU_0
+static bool core_timer[NUM_CORE];
+#endif
+
+static inline bool core_timer_local (int core)
+{
+#ifdef BUILD_SMP
+    return core_timer[core];
+#else
+    return false;
+#endif
+}
 
 struct thread* cur_thr ()
 {
@@ -68,6 +109,9 @@ struct process* cur_proc ()
 //static int sleep_q; // очередь спящих потоков
 
 static void sched_tick ();
+#ifdef BUILD_SMP
+static void sched_ipi ();
+#endif
 
 static void init_gstacks() {
     for(int i = 0; i < NUM_CORE; i++) {
@@ -87,14 +131,20 @@ static void init_gstacks() {
 
 static void init_queues ()
 {
-    for (int i = 0; i < PRIO_NUM; i++)
-        rdy[i].head = rdy[i].tail = NULL;
+    for (int c = 0; c < NUM_CORE; c++) {
+        kobject_lock_init(&rq[c].lock);
+        for (int i = 0; i < PRIO_NUM; i++)
+            rq[c].q[i].head = rq[c].q[i].tail = NULL;
+        for (int i = 0; i < RDY_MAP_WORDS; i++)
+            rq[c].map[i] = 0;
+        rq[c].nr = 0;
+    }
 }
 
 static void init_rdy ()
 {
     for (int i = 0; i < NUM_CORE; i++)
-        run_thr[i] = NULL;
+        run_thr[i] = out_thr[i] = NULL;
 }
 
 static void init_proc ()
@@ -131,12 +181,13 @@ void sched_init ()
     interrupt_set_cpu(SCHEDULER_IRQ_ID, CPU_0, 1);
 
 #ifdef BUILD_SMP
-    int cpu = CPU_1;
-    for(int i = SCHEDULER_IRQ_SECONDARY_BASE; i < SCHEDULER_IRQ_SECONDARY_BASE + NUM_CORE; i++) {
-        interrupt_hook(i, sched_tick, INTERRUPT_KERNEL_FUNC);
-        interrupt_set_assert_type(i, IRQ_ASSERT_EDGE_RISING);
-        interrupt_set_priority(i, KPRIO_MAX);
-        interrupt_set_cpu(i, cpu++, 1);
+    // программные прерывания перепланирования, по одному на каждое ядро:
+    // для вторичных ядер без локального таймера это их системный тик от CPU_0, для всех - пробуждение
+    // при постановке в их очередь потока, который должен вытеснить текущий
+    for(int i = 0; i < NUM_CORE; i++) {
+        interrupt_hook(SCHEDULER_IRQ_SECONDARY_BASE + i, sched_ipi, INTERRUPT_KERNEL_FUNC);
+        interrupt_set_priority(SCHEDULER_IRQ_SECONDARY_BASE + i, KPRIO_MAX);
+        interrupt_enable(SCHEDULER_IRQ_SECONDARY_BASE + i);
     }
 #endif
 
@@ -150,14 +201,34 @@ void sched_start ()
     // сюда при нормальной работе никогда не попадем
 }
 
+void sched_start_secondary ()
+{
+#ifdef BUILD_SMP
+    int core = cpu_get_core_id();
+    if (timer_core_init() == OK) {
+        // прерывание локального таймера банковано в GIC, настраивается на каждом ядре
+        interrupt_set_assert_type(SCHEDULER_IRQ_ID, IRQ_ASSERT_EDGE_RISING);
+        interrupt_set_priority(SCHEDULER_IRQ_ID, KPRIO_MAX);
+        interrupt_enable(SCHEDULER_IRQ_ID);
+        core_timer[core] = true;
+    }
+#endif
+    sched_switch(SCHED_SWITCH_NO_RETURN);
+}
+
+/* Блокировка планировщика на текущем ядре - запрет прерываний (вытеснения).
+ Очереди готовых потоков защищаются собственными блокировками каждого ядра
+ внутри enqueue/dequeue */
 void sched_lock ()
 {
-    kobject_lock(&schedlock);
+    uint32_t s = interrupt_disable_s();
+    schedlock_state[cpu_get_core_id()] = s;
 }
 
 void sched_unlock ()
 {
-    kobject_unlock(&schedlock);
+    uint32_t s = schedlock_state[cpu_get_core_id()];
+    interrupt_enable_s(s);
 }
 
 /* Эта функция определяет политику планирования.
@@ -165,7 +236,7 @@ void sched_unlock ()
 static void sched (struct thread *thr, int *queue, int *front)
 {
     static struct thread *prev = 0;
-    int expire = thr->time_sum > thr->time_slice;
+    int expire = thr->time_sum >= thr->time_slice;
     int penalty = 0;
 
     /* Проверка наличия неизрасходованного времени у процесса. При его отсутствии выделение
@@ -184,7 +255,8 @@ static void sched (struct thread *thr, int *queue, int *front)
         }
     }
 
-    if (penalty || thr->nice) {
+    // приоритет, повышенный наследованием, не меняем до его снятия
+    if ((penalty || thr->nice) && !thr->pi_boosted) {
         thr->prio += penalty + thr->nice;
         if (thr->prio < PRIO_MAX)
             thr->prio = PRIO_MAX;
@@ -196,55 +268,345 @@ static void sched (struct thread *thr, int *queue, int *front)
     *front = expire;
 }
 
-/* enqueue, dequeue и pick реализуют механизм планирования */
+/* enqueue, dequeue и pick реализуют механизм планирования,
+ все три операции выполняются за O(1) вне зависимости от числа готовых потоков */
+
+static void rq_insert (struct runqueue *r, struct thread *thr, int q, int front)
+{
+    struct rdy_queue *rdy = &r->q[q];
+
+    if (rdy->head == NULL) {                  // пустая очередь
+        thr->ready_list.next = thr->ready_list.prev = NULL;
+        rdy->head = rdy->tail = thr;
+        r->map[q >> 5] |= RDY_MAP_BIT(q);
+    } else if (front) {                       // в начало
+        thr->ready_list.prev = NULL;
+        thr->ready_list.next = rdy->head;
+        rdy->head->ready_list.prev = thr;
+        rdy->head = thr;
+    } else {                                  // в конец
+        thr->ready_list.next = NULL;
+        thr->ready_list.prev = rdy->tail;
+        rdy->tail->ready_list.next = thr;
+        rdy->tail = thr;
+    }
+    thr->queued = 1;
+    r->nr++;
+}
+
+static void rq_remove (struct runqueue *r, struct thread *thr)
+{
+    int q = thr->prio;
+    struct rdy_queue *rdy = &r->q[q];
+    struct thread *next = thr->ready_list.next, *prev = thr->ready_list.prev;
+
+    if (prev != NULL)
+        prev->ready_list.next = next;
+    else
+        rdy->head = next;
+    if (next != NULL)
+        next->ready_list.prev = prev;
+    else
+        rdy->tail = prev;
+    thr->ready_list.next = thr->ready_list.prev = NULL;
+    thr->queued = 0;
+
+    if (rdy->head == NULL)
+        r->map[q >> 5] &= ~RDY_MAP_BIT(q);
+    r->nr--;
+}
+
+static struct thread* rq_first (struct runqueue *r)
+{
+    for (int i = 0; i < RDY_MAP_WORDS; i++) {
+        if (r->map[i])
+            return r->q[(i << 5) + cpu_clz(r->map[i])].head;
+    }
+    return NULL;
+}
+
+#ifdef BUILD_SMP
+/* Маска ядер, на которых разрешено выполнение потоков процесса,
+ пустая маска process.available_cores означает все ядра */
+static uint32_t thread_cores (struct thread *thr)
+{
+    uint32_t mask = thr->proc->available_cores & ((1 << NUM_CORE) - 1);
+    return (mask == 0) ? ((1 << NUM_CORE) - 1) : mask;
+}
+
+/* Поток выполняется или только что был переключен на ядре core,
+ его контекст может быть еще не сохранен, поэтому переносить его на другое ядро нельзя */
+static int thread_on_core (struct thread *thr, int core)
+{
+    return (run_thr[core] == thr) || (out_thr[core] == thr);
+}
+
+static int core_idle (int core)
+{
+    return ((run_thr[core] == NULL) || (run_thr[core] == idle_thr[core])) && (rq[core].nr == 0);
+}
+
+/* Выбор ядра для постановки потока в очередь:
+ - ядро, на котором поток выполнялся последним, если оно разрешено и свободно
+ - любое свободное разрешенное ядро
+ - наименее загруженное разрешенное ядро, при равенстве - последнее ядро потока
+ Оценка загрузки приблизительная (без блокировок), ошибки исправляет перехват работы в pick */
+static int select_core (struct thread *thr)
+{
+    uint32_t mask = thread_cores(thr);
+    int last = thr->core, best = -1;
+
+    if (thread_on_core(thr, last))
+        return last;
+    if ((mask & (1 << last)) && core_idle(last))
+        return last;
+    for (int i = 0; i < NUM_CORE; i++) {
+        if (!(mask & (1 << i)))
+            continue;
+        if (core_idle(i))
+            return i;
+        if ((best < 0) || (rq[i].nr < rq[best].nr))
+            best = i;
+    }
+    if ((mask & (1 << last)) && (rq[last].nr <= rq[best].nr))
+        return last;
+    return best;
+}
+
+/* Перехват готового потока из очереди другого ядра для свободного ядра core.
+ Просматриваются очереди ядер по кругу, начиная со следующего за core, в каждой
+ выбирается наиболее приоритетный поток, которому разрешено выполнение на core.
+ Одновременно удерживается не более одной блокировки очереди, что исключает взаимоблокировки */
+static struct thread* steal (int core)
+{
+    struct thread *thr = NULL;
+
+    for (int i = 1; (i < NUM_CORE) && (thr == NULL); i++) {
+        int victim = (core + i) % NUM_CORE;
+        struct runqueue *r = &rq[victim];
+        if (r->nr == 0)
+            continue;
+        kobject_qlock(&r->lock);
+        for (int w = 0; (w < RDY_MAP_WORDS) && (thr == NULL); w++) {
+            uint32_t map = r->map[w];
+            while ((map != 0) && (thr == NULL)) {
+                int q = (w << 5) + cpu_clz(map);
+                for (thr = r->q[q].head; thr != NULL; thr = thr->ready_list.next) {
+                    if ((thread_cores(thr) & (1 << core)) && !thread_on_core(thr, victim))
+                        break;
+                }
+                map &= ~RDY_MAP_BIT(q);
+            }
+        }
+        if (thr != NULL) {
+            rq_remove(r, thr);
+            thr->core = core;
+        }
+        kobject_qunlock(&r->lock);
+    }
+    return thr;
+}
+#endif
+
+/* Захват очереди ядра, в которой находится или последним находился поток,
+ поток может быть перехвачен другим ядром, пока ждем блокировку его очереди */
+static struct runqueue* rq_lock_thread (struct thread *thr)
+{
+    struct runqueue *r;
+    for (;;) {
+        r = &rq[thr->core];
+        kobject_qlock(&r->lock);
+        if (r == &rq[thr->core])
+            return r;
+        kobject_qunlock(&r->lock);
+    }
+}
+
+/* Изъятие заданного потока из очереди для прямого переключения на ядре core,
+ поток должен быть готовым и разрешенным для выполнения на этом ядре */
+static int rq_take (int core, struct thread *thr)
+{
+    struct runqueue *r;
+    int res = 0;
+
+#ifdef BUILD_SMP
+    if (!(thread_cores(thr) & (1 << core)))
+        return 0;
+#endif
+    r = rq_lock_thread(thr);
+    if (thr->queued && (thr->state == READY)) {
+#ifdef BUILD_SMP
+        if ((thr->core == core) || !thread_on_core(thr, thr->core))
+#endif
+        {
+            rq_remove(r, thr);
+            res = 1;
+        }
+    }
+    kobject_qunlock(&r->lock);
+    return res;
+}
+
+#ifdef BUILD_SMP
+/* Пробуждение ядра core, если поставленный в его очередь поток должен вытеснить выполняемый на нем */
+static void rq_kick (int core, struct thread *thr)
+{
+    if (core != cpu_get_core_id()) {
+        struct thread *running = run_thr[core];
+        if ((running == NULL) || thread_preemptable(running, thr))
+            interrupt_soft(SCHEDULER_IRQ_SECONDARY_BASE + core, core);
+    }
+}
+#endif
 
 /* Добавление потока в очередь планирования */
 void enqueue (struct thread *thr)
 {
     int q;
     int front;
+    int core = 0;
+    struct runqueue *r;
     sched(thr, &q, &front);
 
     ++thr->stat.run;
 
-    if (rdy[q].head == NULL) {                // пустая очередь
-        rdy[q].head = rdy[q].tail = thr;
-        thr->ready_list.next = NULL;
-    } else if (front) {                       // в начало
-        thr->ready_list.next = rdy[q].head;
-        rdy[q].head = thr;
-    } else {                                  // в конец
-        rdy[q].tail->ready_list.next = thr;
-        rdy[q].tail = thr;
-        thr->ready_list.next = NULL;
-    }
+#ifdef BUILD_SMP
+    core = select_core(thr);
+#endif
+    r = &rq[core];
+    kobject_qlock(&r->lock);
+    thr->core = core;
+    rq_insert(r, thr, q, front);
+    kobject_qunlock(&r->lock);
+
+#ifdef BUILD_SMP
+    rq_kick(core, thr);
+#endif
 }
 
 /* Удаление потока из планирования */
 void dequeue (struct thread *thr)
 {
-    int q = thr->prio;
-    if (rdy[q].head == thr && rdy[q].tail == thr) {
-        rdy[q].head = rdy[q].tail = NULL;
-    } else if (rdy[q].head == thr) {
-        rdy[q].head = thr->ready_list.next;
-    } else if (rdy[q].tail == thr) {
-        rdy[q].tail = thr->ready_list.prev;
+    struct runqueue *r = rq_lock_thread(thr);
+    rq_remove(r, thr);
+    kobject_qunlock(&r->lock);
+}
+
+void sched_change_prio (struct thread *thr, int prio)
+{
+    struct runqueue *r = rq_lock_thread(thr);
+    if (thr->queued) {
+        rq_remove(r, thr);
+        thr->prio = prio;
+        rq_insert(r, thr, prio, 0);
     } else {
-        thr->ready_list.prev->ready_list.next = thr->ready_list.next;
+        thr->prio = prio;
     }
+    kobject_qunlock(&r->lock);
+#ifdef BUILD_SMP
+    if (thr->queued)
+        rq_kick(thr->core, thr);
+#endif
 }
 
-/* Выбор потока для выполнения. */
-static struct thread* pick ()
+/* Выбор потока для выполнения на ядре core и изъятие его из очереди,
+ если текущий поток cur отсутствует (NULL) или может быть вытеснен выбранным.
+ Свободное ядро при пустой собственной очереди перехватывает работу у других ядер. */
+static struct thread* pick (int core, struct thread *cur)
 {
-    for (int i = 0; i < PRIO_NUM; i++) {
-        if (rdy[i].head)
-            return rdy[i].head;
+    struct runqueue *r = &rq[core];
+    struct thread *thr;
+
+    kobject_qlock(&r->lock);
+    thr = rq_first(r);
+    if ((thr != NULL) && ((cur == NULL) || thread_preemptable(cur, thr)))
+        rq_remove(r, thr);
+    else
+        thr = NULL;
+    kobject_qunlock(&r->lock);
+
+#ifdef BUILD_SMP
+    if ((thr == NULL) && ((cur == NULL) || (cur == idle_thr[core])))
+        thr = steal(core);
+#endif
+    return thr;
+}
+
+/* Грант кванта вызовом yield_to: поток thr выполняется с остатком кванта left и
+ приоритетом prio донора (если он выше собственного), собственные значения сохраняются */
+static void grant_begin (struct thread *thr, struct thread *donor, int prio, uint64_t left)
+{
+    thr->time_grant = donor;
+    thr->grant_prio = thr->prio;
+    thr->grant_sum = thr->time_sum;
+    // приоритет, повышенный наследованием, не трогаем
+    if (!thr->pi_boosted && (prio < thr->prio))
+        thr->prio = prio;
+    if (left > thr->time_slice)
+        left = thr->time_slice;
+    thr->time_sum = thr->time_slice - left;
+}
+
+/* Завершение гранта: поток возвращается к собственным приоритету и кванту,
+ как будто в течение гранта не выполнялся */
+static void grant_end (struct thread *thr)
+{
+    if (thr->pi_boosted)
+        thr->base_prio = thr->grant_prio;   // наследование началось во время гранта
+    else
+        thr->prio = thr->grant_prio;
+    thr->time_sum = thr->grant_sum;
+    thr->time_grant = NULL;
+}
+
+#ifdef BUILD_TICKLESS
+/* Безтактовый режим: вместо периодических прерываний с периодом CLOCK_TICK таймер
+ программируется на ближайший из моментов - наступления события в менеджере событий или
+ истечения кванта выполняемого потока (в SMP на любом из ядер), но не далее TICKLESS_MAX_NS.
+ Таймер обслуживается только CPU_0, поэтому вторичное ядро при более раннем моменте
+ запрашивает перепрограммирование таймера у CPU_0 программным прерыванием.
+ Вторичное ядро с собственным локальным таймером программирует его на истечение своего
+ кванта и в расчете момента для CPU_0 не участвует. */
+static void sched_timer_program (int core, struct thread *thr, uint64_t timestamp)
+{
+    uint64_t next = timestamp + TICKLESS_MAX_NS, t;
+
+    if (thr == idle_thr[core])
+        quantum_end[core] = 0;
+    else if (thr->time_sum < thr->time_slice)
+        quantum_end[core] = timestamp + thr->time_slice - thr->time_sum;
+    else
+        quantum_end[core] = timestamp;
+
+#ifdef BUILD_SMP
+    if ((core != CPU_0) && core_timer_local(core)) {
+        timer_core_set_next_event((quantum_end[core] != 0) ? quantum_end[core] : next, TICKLESS_MAX_NS);
+        return;
     }
-    // нет готовых
-    return NULL;
+#endif
+    for (int i = 0; i < NUM_CORE; i++) {
+        if ((i != CPU_0) && core_timer_local(i))
+            continue;
+        if ((quantum_end[i] != 0) && (quantum_end[i] < next))
+            next = quantum_end[i];
+    }
+    kevent_store_lock();
+    if ((kevent_get_time(&t) == 0) && (t < next))
+        next = t;
+    kevent_store_unlock();
+    if ((ktimer_get_time(&t) == 0) && (t < next))
+        next = t;
+
+#ifdef BUILD_SMP
+    if (core != CPU_0) {
+        if (next < timer_get_event())
+            interrupt_soft(SCHEDULER_IRQ_SECONDARY_BASE + CPU_0, CPU_0);
+        return;
+    }
+#endif
+    timer_set_next_event(next, TICKLESS_MAX_NS);
 }
+#endif
 
 /**
  *  Переключение потоков.
@@ -253,8 +615,9 @@ static struct thread* pick ()
 void sched_switch (enum sched_switch_mode mode)
 {
     int core = cpu_get_core_id();
-    uint64_t timestamp;
-    struct thread *current, *pending = NULL, *encoming;
+    uint64_t timestamp, yield_left = 0;
+    int yield_prio = PRIO_MIN;
+    struct thread *current, *pending = NULL, *encoming, *yield = NULL;
 
     sched_lock();
 
@@ -286,6 +649,16 @@ void sched_switch (enum sched_switch_mode mode)
             thread_sleep_unblock(encoming);
             enqueue(encoming);
             break;
+        case MSG_SEND:
+        case MSG_RECEIVE:
+        case MSG_PULSE:
+            msg_sync_timeout(encoming);
+            enqueue(encoming);
+            break;
+        case PORT_WAIT:
+            port_wait_timeout(encoming);
+            enqueue(encoming);
+            break;
         default:
             break;
         }
@@ -294,6 +667,9 @@ void sched_switch (enum sched_switch_mode mode)
     kevent_store_unlock();
 
     current = run_thr[core];
+    // контекст предыдущего вытесненного потока на этом ядре уже сохранен,
+    // теперь до следующего вызова защищаем от переноса на другое ядро текущий
+    out_thr[core] = current;
     // Примечание.
     // Далее обнуление run_thr[core] используем как признак смены текущего потока current
     timestamp = systime();
@@ -301,11 +677,34 @@ void sched_switch (enum sched_switch_mode mode)
         // idle тут не обрабатываем, он всегда должен работать если других нет
         // здесь принимаем решение о судьбе текущего потока
         current->time_sum += timestamp - run_thr_tstamp[core];
+        if(current->yield_to != NULL) {
+            // направленная передача остатка кванта и приоритета вызовом yield_to,
+            // для потока, который сам выполнялся по гранту, передается остаток гранта
+            yield = current->yield_to;
+            current->yield_to = NULL;
+            yield_prio = current->prio;
+            if(current->time_sum < current->time_slice) {
+                yield_left = current->time_slice - current->time_sum;
+            }
+            if(current->time_grant == NULL) {
+                // донор считается отработавшим свой квант полностью
+                current->time_sum = 0;
+            }
+        }
+        if( (current->time_grant != NULL) &&
+                ((current->state != RUNNING) || (current->time_sum >= current->time_slice)) ) {
+            // грант завершен блокировкой, передачей дальше или исчерпанием,
+            // в последнем случае поток возвращается в очередь
+            if(current->state == RUNNING) {
+                current->state = READY;
+            }
+            grant_end(current);
+        }
         if( current->state == RUNNING ) {
             // текущий поток не поменял состояние,
             // необходимо учесть его рабочее время в кванте и,
             // если он исчерпал его в активном режиме, принять решение по его дальнейшей судьбе
-            if(current->time_sum > current->time_slice) {
+            if(current->time_sum >= current->time_slice) {
                 // сбрасываем работу текущего потока
                 // и снова ставим в очередь планирования,
                 // планировщик решит что делать с захватчиком процессорного времени
@@ -356,23 +755,34 @@ void sched_switch (enum sched_switch_mode mode)
             }
         }
     }
-    pending = pick();
+    if( (yield != NULL) && (run_thr[core] == NULL) && rq_take(core, yield) ) {
+        // прямое переключение на получателя гранта без выбора по очередям,
+        // проверяется только наличие более приоритетного готового потока
+        pending = yield;
+        grant_begin(pending, current, yield_prio, yield_left);
+        if( (encoming = pick(core, pending)) != NULL ) {
+            grant_end(pending);
+            enqueue(pending);
+            pending = encoming;
+        }
+    } else {
+        pending = pick(core, run_thr[core]);
+    }
     if( pending != NULL ) {
-        if( (run_thr[core] == NULL) || (thread_preemptable(run_thr[core], pending)) ) {
-            dequeue(pending);
-            pending->state = RUNNING;
-            if(run_thr[core] != NULL) {
-                // вытеснение более приоритетным, перепостановка в очередь вытесняемого,
-                // квант текущего не сбрасываем
-                current->state = READY;
-                if(current != idle_thr[core]) {
-                    enqueue(current);
+        pending->state = RUNNING;
+        pending->core = core;
+        if(run_thr[core] != NULL) {
+            // вытеснение более приоритетным, перепостановка в очередь вытесняемого,
+            // квант текущего не сбрасываем
+            current->state = READY;
+            if(current != idle_thr[core]) {
+                if(current->time_grant != NULL) {
+                    grant_end(current);
                 }
+                enqueue(current);
             }
-            run_thr[core] = pending;
-        } else {
-            pending = run_thr[core];//current; // поток сохранился (idle или любой другой)
         }
+        run_thr[core] = pending;
     } else {
         if(run_thr[core] == NULL) {
             pending = idle_thr[core];
@@ -383,9 +793,15 @@ void sched_switch (enum sched_switch_mode mode)
         }
     }
     run_thr_tstamp[core] = timestamp;
+#ifdef BUILD_TICKLESS
+    sched_timer_program(core, pending, timestamp);
+#endif
     sched_unlock();
-    // коррекция приоритета вытеснения в контроллере прерываний
-//    interrupt_set_env_priority(pending->prio);
+#ifdef BUILD_IRQ_PRIO_MASK
+    // коррекция приоритета вытеснения в контроллере прерываний: прерывания потоков-обработчиков
+    // с приоритетом не выше выполняемого потока остаются ожидающими и не вызывают диспетчер
+    interrupt_set_env_priority(pending->prio);
+#endif
     call_thread_switch_s(current, pending, (mode == SCHED_SWITCH_SAVE_AND_RET), kernel_global_sp[core]);
 }
 
@@ -398,8 +814,32 @@ void sched_enqueue_switch (struct thread *thr, enum sched_switch_mode mode)
 
 static void sched_tick (const struct interrupt_context *info)
 {
+#ifdef BUILD_SMP
+    if (cpu_get_core_id() != CPU_0) {
+        // собственный локальный таймер вторичного ядра, время подсчитывает CPU_0
+        timer_core_event();
+        interrupt_handle_end(info->id);
+        sched_switch (SCHED_SWITCH_NO_RETURN);
+    }
+#endif
     timer_event();
+    ktimer_expire();                        // таймеры процессов, до диспетчеризации оповещенных ими
+#ifdef BUILD_SMP
+    // системный тик вторичных ядер без собственного таймера
+    for (int i = CPU_1; i < NUM_CORE; i++) {
+        if (!core_timer_local(i))
+            interrupt_soft(SCHEDULER_IRQ_SECONDARY_BASE + i, i);
+    }
+#endif
     interrupt_handle_end(info->id);         // завершаем обязательно прерывание
     sched_switch (SCHED_SWITCH_NO_RETURN);  // переключаемся обратно или на другой поток
 }
 
+#ifdef BUILD_SMP
+static void sched_ipi (const struct interrupt_context *info)
+{
+    interrupt_handle_end(info->id);
+    sched_switch (SCHED_SWITCH_NO_RETURN);
+}
+#endif
+
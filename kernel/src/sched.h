@@ -49,10 +49,19 @@ void sched_init ();
 void sched_lock ();
 void sched_unlock ();
 void sched_start();
+/** \brief Запуск диспетчеризации на вторичном ядре, включая его локальный таймер тика */
+void sched_start_secondary();
 
 void enqueue (struct thread *thr);
 void dequeue (struct thread *thr);
 
+/**
+ * Смена текущего приоритета потока с перестановкой в очереди готовых, если он в ней находится.
+ * Политика планирования при этом не применяется.
+ * Вызывается при запрещенных прерываниях.
+ */
+void sched_change_prio (struct thread *thr, int prio);
+
 void sched_enqueue_switch(struct thread *thr, enum sched_switch_mode mode);
 void sched_switch(enum sched_switch_mode mode);
 
@@ -4,6 +4,170 @@
 #include <common/utils.h>
 #include "mutex.h"
 
+// Ограничение длины обрабатываемой цепочки владельцев при наследовании приоритета,
+// защищает от зацикливания при взаимной блокировке потоков на мьютексах
+#define MUTEX_PI_CHAIN_MAX      16
+
+// Общая блокировка операций наследования приоритета. Упорядочивает изменения очередей
+// ожидания мьютексов с наследованием и приоритетов потоков по всей цепочке владельцев,
+// всегда захватывается раньше wait_lock любого мьютекса с наследованием
+static spinlock_t pi_lock;
+
+static inline int mutex_pi (mutex_t *m)
+{
+    return (m->flags & MUTEX_FLAG_PRIO_INHERIT);
+}
+
+// Постановка потока в очередь ожидающих: для мьютекса с наследованием - по приоритету
+// (в порядке поступления среди равных), иначе - в конец очереди
+static void wait_insert (mutex_t *m, struct thread *thr)
+{
+    struct thread *prev = m->wait_last;
+    if (mutex_pi(m)) {
+        while ((prev != NULL) && (prev->prio > thr->prio)) {
+            prev = prev->block_list.prev;
+        }
+    }
+    thr->block_list.prev = prev;
+    if (prev != NULL) {
+        thr->block_list.next = prev->block_list.next;
+        prev->block_list.next = thr;
+    } else {
+        thr->block_list.next = m->wait_first;
+        m->wait_first = thr;
+    }
+    if (thr->block_list.next != NULL) {
+        thr->block_list.next->block_list.prev = thr;
+    } else {
+        m->wait_last = thr;
+    }
+}
+
+static void wait_remove (mutex_t *m, struct thread *thr)
+{
+    if (thr->block_list.prev != NULL) {
+        thr->block_list.prev->block_list.next = thr->block_list.next;
+    } else {
+        // был первым, обновляем
+        m->wait_first = thr->block_list.next;
+    }
+    if (thr->block_list.next != NULL) {
+        thr->block_list.next->block_list.prev = thr->block_list.prev;
+    } else {
+        // был последним, обновляем
+        m->wait_last = thr->block_list.prev;
+    }
+    thr->block_list.prev = NULL;
+    thr->block_list.next = NULL;
+}
+
+// Владелец мьютекса по owner_tid. Для MUTEX_TYPE_PLOCAL это память процесса,
+// номер записывается после захвата и может быть 0, устаревшим или произвольным,
+// поэтому принимается только поток того же процесса, что и ожидающий, и не сам ожидающий
+// и не ожидающий этот же мьютекс. Иначе владелец не регистрируется до следующей конкуренции
+static struct thread *pi_find_owner (mutex_t *m, struct thread *waiter)
+{
+    struct thread *owner = get_thr(*m->owner_tid);
+    if ((owner == NULL) || (owner == waiter)) {
+        return NULL;
+    }
+    if ((m->owner_tid != &m->__owner_tid) && ((waiter == NULL) || (owner->proc != waiter->proc))) {
+        return NULL;
+    }
+    if ((owner->state == BLOCKED) && (owner->block.type == SYN_MUTEX) && (owner->block.object.mutex == m)) {
+        return NULL;
+    }
+    return owner;
+}
+
+// Регистрация владельца мьютекса с наследованием при появлении ожидающих.
+// Владелец, захвативший мьютекс без ожидания, ищется по owner_tid
+static void pi_attach_owner (mutex_t *m, struct thread *owner, struct thread *waiter)
+{
+    if (m->owner != NULL) {
+        return;
+    }
+    if (owner == NULL) {
+        owner = pi_find_owner(m, waiter);
+    }
+    if ((owner == NULL) || (owner->state == DEAD)) {
+        return;
+    }
+    m->owner = owner;
+    m->pi_next = owner->pi_held;
+    owner->pi_held = m;
+}
+
+static struct thread *pi_detach_owner (mutex_t *m)
+{
+    struct thread *owner = m->owner;
+    mutex_t **pm;
+    if (owner == NULL) {
+        return NULL;
+    }
+    for (pm = &owner->pi_held; *pm != NULL; pm = &(*pm)->pi_next) {
+        if (*pm == m) {
+            *pm = m->pi_next;
+            break;
+        }
+    }
+    m->owner = NULL;
+    m->pi_next = NULL;
+    return owner;
+}
+
+// Приоритет, который должен иметь поток с учетом наследования от ожидающих
+// на удерживаемых им мьютексах (очереди упорядочены, первый - наивысший)
+// и от клиента обрабатываемого сообщения
+static int pi_target_prio (struct thread *thr)
+{
+    int prio = thr->pi_boosted ? thr->base_prio : thr->prio;
+    if ((thr->msg_prio != 0) && (thr->msg_prio < prio)) {
+        prio = thr->msg_prio;
+    }
+    for (mutex_t *m = thr->pi_held; m != NULL; m = m->pi_next) {
+        if ((m->wait_first != NULL) && (m->wait_first->prio < prio)) {
+            prio = m->wait_first->prio;
+        }
+    }
+    return prio;
+}
+
+// Пересчет приоритета потока и распространение изменения по цепочке: если поток сам
+// ожидает мьютекс с наследованием, то он переставляется в его очереди и пересчитывается
+// приоритет владельца этого мьютекса и т.д.
+// Выполняется под pi_lock без удерживаемых wait_lock
+static void pi_adjust (struct thread *thr)
+{
+    mutex_t *m;
+    for (int depth = 0; (thr != NULL) && (depth < MUTEX_PI_CHAIN_MAX); depth++) {
+        int prio = pi_target_prio(thr);
+        if (prio == thr->prio) {
+            break;
+        }
+        if (!thr->pi_boosted) {
+            thr->base_prio = thr->prio;
+            thr->pi_boosted = 1;
+        } else if (prio == thr->base_prio) {
+            thr->pi_boosted = 0;
+        }
+        sched_change_prio(thr, prio);
+
+        if ((thr->state != BLOCKED) || (thr->block.type != SYN_MUTEX)) {
+            break;
+        }
+        m = thr->block.object.mutex;
+        if (!mutex_pi(m)) {
+            break;
+        }
+        spinlock_lock(&m->wait_lock);
+        wait_remove(m, thr);
+        wait_insert(m, thr);
+        spinlock_unlock(&m->wait_lock);
+        thr = m->owner;
+    }
+}
+
 int mutex_init (mutex_t *m, syn_t *s)
 {
     if (s == NULL) {
@@ -28,6 +192,9 @@ int mutex_init (mutex_t *m, syn_t *s)
     m->cnt->val = 1;
     m->wait_first = NULL;
     m->wait_last = NULL;
+    m->flags = ((s != NULL) && (s->flags & SYN_FLAG_PRIO_INHERIT)) ? MUTEX_FLAG_PRIO_INHERIT : 0;
+    m->owner = NULL;
+    m->pi_next = NULL;
     spinlock_init(&m->wait_lock);
     return OK;
 }
@@ -60,18 +227,14 @@ int mutex_lock (mutex_t *m, struct thread *thr, uint64_t ns)
     // - блокируем вытеснение, чтобы быстро поправить очередь,
     // - захватываем очередь ожидающих потоков на мьютексе и корректируем ее,
     // - меняем состояние текущего потока,
+    // - для мьютекса с наследованием повышаем приоритет владельца (по цепочке),
     // - запускаем диспетчер для переключения на готовый для исполнения поток
     uint32_t s = interrupt_disable_s();
-    spinlock_lock(&m->wait_lock);
-    thr->block_list.next = NULL;
-    if (m->wait_last != NULL) {
-        m->wait_last->block_list.next = thr;
-        thr->block_list.prev = m->wait_last;
-    } else {
-        thr->block_list.prev = NULL;
-        m->wait_first = thr;
+    if (mutex_pi(m)) {
+        spinlock_lock(&pi_lock);
     }
-    m->wait_last = thr;
+    spinlock_lock(&m->wait_lock);
+    wait_insert(m, thr);
     thread_mutex_block(thr, m);
     if (ns != TIMEOUT_INFINITY) {
         // TODO этот код лучше вынести ниже за unlock(wait_lock),
@@ -80,7 +243,14 @@ int mutex_lock (mutex_t *m, struct thread *thr, uint64_t ns)
         thr->block_evt = kevent_insert(ns, thr);
         kevent_store_unlock();
     }
-    spinlock_unlock(&m->wait_lock);
+    if (mutex_pi(m)) {
+        pi_attach_owner(m, NULL, thr);
+        spinlock_unlock(&m->wait_lock);
+        pi_adjust(m->owner);
+        spinlock_unlock(&pi_lock);
+    } else {
+        spinlock_unlock(&m->wait_lock);
+    }
     sched_switch(SCHED_SWITCH_SAVE_AND_RET);
     // сюда вернемся только после события по таймауту или при захвате мьютекса текущим потоком
     // (поток не получит управление до передачи ему мьютекса во владение)
@@ -106,12 +276,16 @@ int mutex_lock (mutex_t *m, struct thread *thr, uint64_t ns)
 }
 
 // Необходимо обеспечить прерывание блокировки заданного потока на мьютексе.
-// Это может быть сделано путем его удаления из очереди ожидающих(блокированных)
+// Это может быть сделано путем его удаления из очереди ожидающих(блокированных).
+// Для мьютекса с наследованием приоритет владельца пересчитывается по оставшимся ожидающим
 int mutex_wait_cancel (mutex_t *m, struct thread *thr)
 {
-    struct thread *next_thr;
+    struct thread *next_thr, *owner = NULL;
     int res = ERR;
     uint32_t s = interrupt_disable_s();
+    if (mutex_pi(m)) {
+        spinlock_lock(&pi_lock);
+    }
     spinlock_lock(&m->wait_lock);
 
     if (thr == NULL) {
@@ -127,38 +301,25 @@ int mutex_wait_cancel (mutex_t *m, struct thread *thr)
             thr = next_thr;
         }
         sched_unlock();
-
-        spinlock_unlock(&m->wait_lock);
-        interrupt_enable_s(s);
-        return OK;
-    }
-
-    if ((thr->block.type != SYN_MUTEX) || (thr->block.object.mutex != m)) {
-//        panic("mutex_lock_cancel error");
-        spinlock_unlock(&m->wait_lock);
-        interrupt_enable_s(s);
-        return res;
-    }
-    // поток должен быть в списке, поэтому искать его там не нужно
-
-    if (thr->block_list.prev != NULL) {
-        thr->block_list.prev->block_list.next = thr->block_list.next;
-    } else {
-        // был первым, обновляем
-        m->wait_first = thr->block_list.next;
-    }
-    if (thr->block_list.next != NULL) {
-        thr->block_list.next->block_list.prev = thr->block_list.prev;
+        m->wait_first = NULL;
+        m->wait_last = NULL;
+        owner = pi_detach_owner(m);
+        res = OK;
+    } else if ((thr->block.type == SYN_MUTEX) && (thr->block.object.mutex == m)) {
+        // поток должен быть в списке, поэтому искать его там не нужно
+        wait_remove(m, thr);
+//        atomic_inc_unless_return(m->cnt, 1);
+        atomic_add_return(1, m->cnt);
+        owner = (m->wait_first == NULL) ? pi_detach_owner(m) : m->owner;
+        res = OK;
     } else {
-        // был последним, обновляем
-        m->wait_last = thr->block_list.next;
+//        panic("mutex_lock_cancel error");
     }
-    thr->block_list.prev = NULL;
-    thr->block_list.next = NULL;
-//    atomic_inc_unless_return(m->cnt, 1);
-    atomic_add_return(1, m->cnt);
-    res = OK;
     spinlock_unlock(&m->wait_lock);
+    if (mutex_pi(m)) {
+        pi_adjust(owner);
+        spinlock_unlock(&pi_lock);
+    }
     interrupt_enable_s(s);
     return res;
 }
@@ -187,7 +348,11 @@ int mutex_unlock (mutex_t *m, struct thread *thr)
         // текущий поток не владел мьютексом, владельцем является другой поток
         return ERR;
     }
+    struct thread *owner = NULL;
     uint32_t s = interrupt_disable_s();
+    if (mutex_pi(m)) {
+        spinlock_lock(&pi_lock);
+    }
     spinlock_lock(&m->wait_lock);
     thr = m->wait_first;
     if (thr == NULL) {
@@ -199,7 +364,12 @@ int mutex_unlock (mutex_t *m, struct thread *thr)
             // и что делать если ошибка??? TODO
             m->cnt->val = 1; // пока отказоустойчивый код делаем
         }
+        owner = pi_detach_owner(m);
         spinlock_unlock(&m->wait_lock);
+        if (mutex_pi(m)) {
+            pi_adjust(owner);
+            spinlock_unlock(&pi_lock);
+        }
         interrupt_enable_s(s);
         return OK;
     }
@@ -217,7 +387,20 @@ int mutex_unlock (mutex_t *m, struct thread *thr)
     atomic_add_return(1, m->cnt);
     thread_cancel_evt_unblock(thr); // @TODO возможно здесь можно придумать чтото более правильное
     // очередь ожидающих откорректирована, поскорее освобождаем ее спинлок и включаем вытеснение
-    spinlock_unlock(&m->wait_lock);
+    if (mutex_pi(m)) {
+        // наследование снимается с прежнего владельца и переходит к новому,
+        // если на мьютексе остались ожидающие
+        owner = pi_detach_owner(m);
+        if (m->wait_first != NULL) {
+            pi_attach_owner(m, thr, NULL);
+        }
+        spinlock_unlock(&m->wait_lock);
+        pi_adjust(owner);
+        pi_adjust(thr);
+        spinlock_unlock(&pi_lock);
+    } else {
+        spinlock_unlock(&m->wait_lock);
+    }
     interrupt_enable_s(s);
 
     //thread_run(thr);
@@ -228,3 +411,64 @@ int mutex_unlock (mutex_t *m, struct thread *thr)
     return OK;
 }
 
+/**
+ * Завершение потока: удерживаемые им мьютексы с наследованием теряют известного ядру владельца
+ */
+void mutex_owner_exit (struct thread *thr)
+{
+    mutex_t *m, *next;
+    uint32_t s = interrupt_disable_s();
+    spinlock_lock(&pi_lock);
+    for (m = thr->pi_held; m != NULL; m = next) {
+        next = m->pi_next;
+        m->owner = NULL;
+        m->pi_next = NULL;
+    }
+    thr->pi_held = NULL;
+    spinlock_unlock(&pi_lock);
+    interrupt_enable_s(s);
+}
+
+/**
+ * Установка собственного приоритета потока с учетом наследования и гранта кванта:
+ * наследованный приоритет сохраняется, пока он выше нового собственного,
+ * а во время гранта новый приоритет вступает в силу по завершении гранта
+ * (либо сразу, если он выше полученного с грантом)
+ */
+void mutex_thread_prio (struct thread *thr, int prio)
+{
+    uint32_t s = interrupt_disable_s();
+    spinlock_lock(&pi_lock);
+    if (thr->time_grant != NULL) {
+        thr->grant_prio = prio;
+    }
+    if ((thr->time_grant == NULL) || (prio < thr->prio)) {
+        // новый собственный приоритет как базовый, итоговый пересчитывается
+        // с учетом ожидающих на удерживаемых мьютексах
+        thr->pi_boosted = 1;
+        thr->base_prio = prio;
+        pi_adjust(thr);
+        if (thr->pi_boosted && (thr->base_prio == thr->prio)) {
+            thr->pi_boosted = 0;
+        }
+    }
+    spinlock_unlock(&pi_lock);
+    interrupt_enable_s(s);
+}
+
+/**
+ * Наследование приоритета клиента потоком, обрабатывающим его сообщение
+ * (канал с CHANNEL_PRIO_INHERIT), 0 - снятие наследования
+ */
+void mutex_msg_prio (struct thread *thr, int prio)
+{
+    uint32_t s = interrupt_disable_s();
+    spinlock_lock(&pi_lock);
+    thr->msg_prio = prio;
+    pi_adjust(thr);
+    if (thr->pi_boosted && (thr->base_prio == thr->prio)) {
+        thr->pi_boosted = 0;
+    }
+    spinlock_unlock(&pi_lock);
+    interrupt_enable_s(s);
+}
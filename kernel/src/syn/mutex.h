@@ -32,9 +32,20 @@
  * С мьютексами работаем только в вытесняемом контексте, т.к. это объект длительной синхронизации
  * (с разрешенными прерываниями, обычно всегда в режиме SVC, т.к. работаем с вытеснением в SVC всегда
  *  когда не лочимся на объекте ядра). Следствие: нельзя применять внутри синхронизации по объекту ядра
+ *
+ * Мьютекс с флагом MUTEX_FLAG_PRIO_INHERIT реализует протокол наследования приоритета:
+ * очередь ожидающих упорядочена по приоритету, а владелец выполняется с приоритетом не ниже
+ * наивысшего из ожидающих на всех удерживаемых им таких мьютексах, в том числе по цепочке,
+ * когда владелец сам ожидает другой мьютекс с наследованием. Ядро узнает владельца
+ * MUTEX_TYPE_PLOCAL по owner_tid только в момент первой конкуренции за захват,
+ * до этого захват и освобождение выполняются без участия ядра. Такой владелец принимается,
+ * только если это поток того же процесса, не ожидающий этот мьютекс; пока owner_tid
+ * еще не записан захватчиком, наследование откладывается до следующего ожидающего.
  */
 
-typedef struct {
+#define MUTEX_FLAG_PRIO_INHERIT     0x01
+
+typedef struct mutex {
 //    enum syn_type   type;
     atomic_t        *cnt;           //! ссылка на основной рабочий счетчик
     int             *owner_tid;     //! сслыка на номер текущего потока-захватчика
@@ -44,6 +55,9 @@ typedef struct {
     atomic_t        __cnt;          //! рабочий счетчик для мьютекса, размещенного в памяти ядра MUTEX_TYPE_PSHARED
     int             __owner_tid;    //! номер текущего потока-захватчика, тоже для MUTEX_TYPE_PSHARED
     char            *name;          //! Имя,  MUTEX_TYPE_PLOCAL не имеет имени
+    int             flags;          //! MUTEX_FLAG_*
+    struct thread   *owner;         //! владелец, известный ядру при наличии ожидающих (только с наследованием)
+    struct mutex    *pi_next;       //! следующий в списке удерживаемых владельцем мьютексов с наследованием
 } mutex_t;
 
 int mutex_init(mutex_t *m, syn_t *s);
@@ -51,5 +65,8 @@ int mutex_lock(mutex_t *m, struct thread *thr, uint64_t ns);
 int mutex_wait_cancel(mutex_t *m, struct thread *thr);
 int mutex_trylock(mutex_t *m, struct thread *thr);
 int mutex_unlock(mutex_t *m, struct thread *thr);
+void mutex_owner_exit(struct thread *thr);
+void mutex_thread_prio(struct thread *thr, int prio);
+void mutex_msg_prio(struct thread *thr, int prio);
 
 #endif /* MUTEX_H_ */
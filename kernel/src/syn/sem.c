@@ -2,6 +2,7 @@
 #include <sched.h>
 #include <event.h>
 #include <common/utils.h>
+#include <port.h>
 #include "sem.h"
 
 int sem_init(semaphore_t *sem, syn_t *s) {
@@ -28,10 +29,30 @@ int sem_init(semaphore_t *sem, syn_t *s) {
     sem->cnt->val = sem->limit;
     sem->wait_first = NULL;
     sem->wait_last = NULL;
+    sem->ports = NULL;
     spinlock_init(&sem->wait_lock);
     return OK;
 }
 
+/* Постановка потока в очередь ожидания, выполняется под wait_lock с запрещенными прерываниями */
+static void sem_block(semaphore_t *sem, struct thread *thr, uint64_t ns) {
+    thr->block_list.next = NULL;
+    if (sem->wait_last != NULL) {
+        sem->wait_last->block_list.next = thr;
+        thr->block_list.prev = sem->wait_last;
+    } else {
+        thr->block_list.prev = NULL;
+        sem->wait_first = thr;
+    }
+    sem->wait_last = thr;
+    thread_sem_block(thr, sem);
+    if(ns != TIMEOUT_INFINITY) {
+        kevent_store_lock();
+        thr->block_evt = kevent_insert(ns, thr);
+        kevent_store_unlock();
+    }
+}
+
 int sem_lock(semaphore_t *sem, struct thread *thr, uint64_t ns) {
     int res = OK;
     int cnt;
@@ -48,23 +69,7 @@ int sem_lock(semaphore_t *sem, struct thread *thr, uint64_t ns) {
         interrupt_enable_s(s);
         return res;
     }
-    thr->block_list.next = NULL;
-    if (sem->wait_last != NULL) {
-        sem->wait_last->block_list.next = thr;
-        thr->block_list.prev = sem->wait_last;
-    } else {
-        thr->block_list.prev = NULL;
-        sem->wait_first = thr;
-    }
-    sem->wait_last = thr;
-    thread_sem_block(thr, sem);
-    if(ns != TIMEOUT_INFINITY) {
-        // TODO этот код лучше вынести ниже за unlock(wait_lock),
-        // но можно ли / нужно ли ?
-        kevent_store_lock();
-        thr->block_evt = kevent_insert(ns, thr);
-        kevent_store_unlock();
-    }
+    sem_block(sem, thr, ns);
     spinlock_unlock(&sem->wait_lock);
     sched_switch(SCHED_SWITCH_SAVE_AND_RET);
     if(ns != TIMEOUT_INFINITY) {
@@ -79,6 +84,50 @@ int sem_lock(semaphore_t *sem, struct thread *thr, uint64_t ns) {
     return res;
 }
 
+int sem_lock_prepare(semaphore_t *sem, struct thread *thr, uint64_t ns) {
+    uint32_t s = interrupt_disable_s();
+    spinlock_lock(&sem->wait_lock);
+    if(atomic_sub_return(1, sem->cnt) >= 0) {
+        spinlock_unlock(&sem->wait_lock);
+        interrupt_enable_s(s);
+        return OK;
+    }
+    sem_block(sem, thr, ns);
+    spinlock_unlock(&sem->wait_lock);
+    interrupt_enable_s(s);
+    return ERR_BUSY;
+}
+
+int sem_lock_wait(struct thread *thr, uint64_t ns) {
+    int res = OK;
+    uint32_t s = interrupt_disable_s();
+    sched_switch(SCHED_SWITCH_SAVE_AND_RET);
+    if((ns != TIMEOUT_INFINITY) && (thr->block_evt == NULL)) {
+        res = ERR_TIMEOUT;
+    }
+    thr->block_evt = NULL;
+    interrupt_enable_s(s);
+    return res;
+}
+
+void sem_check(semaphore_t *sem) {
+    int waiting = 0;
+    uint32_t s = interrupt_disable_s();
+    spinlock_lock(&sem->wait_lock);
+    for(struct thread *thr = sem->wait_first; thr != NULL; thr = thr->block_list.next) {
+        waiting++;
+    }
+    // допустимы значения от -(число ожидающих) до limit, остальное - порча счетчика процессом
+    int cnt = sem->cnt->val;
+    if(cnt > sem->limit) {
+        sem->cnt->val = sem->limit;
+    } else if(cnt < -waiting) {
+        sem->cnt->val = -waiting;
+    }
+    spinlock_unlock(&sem->wait_lock);
+    interrupt_enable_s(s);
+}
+
 int sem_wait_cancel(semaphore_t *sem, struct thread *thr) {
     struct thread *next_thr;
     int res = ERR;
@@ -157,6 +206,9 @@ int sem_unlock(semaphore_t *sem, struct thread *thr) {
         }
         spinlock_unlock(&sem->wait_lock);
         interrupt_enable_s(s);
+        if(sem->ports != NULL) {
+            port_notify(&sem->ports);
+        }
         return OK;
     }
     // очередь ожидающих не пустая, разблокируем следующий поток
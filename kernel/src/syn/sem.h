@@ -34,12 +34,28 @@ typedef struct {
     struct thread   *wait_last;
     atomic_t        __cnt;          // для SEMAPHORE_TYPE_PSHARED
     char            *name;          // имя
+    struct port_link *ports;        // наблюдающие порты ожидания, изменяется только модулем port
 } semaphore_t;
 
 int sem_init(semaphore_t *sem, syn_t *s);
 int sem_lock(semaphore_t *sem, struct thread *thr, uint64_t ns);
 int sem_wait_cancel(semaphore_t *sem, struct thread *thr);
 int sem_trylock(semaphore_t *sem, struct thread *thr);
+
+/**
+ * Захват семафора в два шага для вызывающих, которые удерживают блокировку объекта ядра,
+ * содержащего семафор: sem_lock_prepare ставит поток в очередь ожидания (ERR_BUSY) или
+ * захватывает семафор сразу (OK), после освобождения блокировки объекта вызывается
+ * sem_lock_wait, которая возвращает OK или ERR_TIMEOUT.
+ */
+int sem_lock_prepare(semaphore_t *sem, struct thread *thr, uint64_t ns);
+int sem_lock_wait(struct thread *thr, uint64_t ns);
+
+/**
+ * Исправление счетчика, размещенного в памяти процесса, до допустимого диапазона
+ * от -(число ожидающих потоков) до limit
+ */
+void sem_check(semaphore_t *sem);
 int sem_unlock(semaphore_t *sem, struct thread *thr);
 
 #endif /* SEMAPHORE_H_ */
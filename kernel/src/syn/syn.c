@@ -9,6 +9,7 @@
 #include <limits.h>
 #include <proc.h>
 #include <sched.h>
+#include <port.h>
 //#include <os_types.h>
 
 #include <stdlib.h>
@@ -223,6 +224,7 @@ int syn_delete (int id, int unlink, struct process *p) {
         case SEMAPHORE_TYPE_PLOCAL:
         case SEMAPHORE_TYPE_PSHARED:
             sem_wait_cancel((semaphore_t *)reshdr->ref, NULL);
+            port_source_close(&((semaphore_t *)reshdr->ref)->ports);
             break;
         case BARRIER_TYPE_PLOCAL:
         case BARRIER_TYPE_PSHARED:
@@ -413,6 +415,90 @@ int syn_done (int id, struct thread *thr) {
     return res;
 }
 
+int syn_post (int id, struct process *p) {
+    struct res_header *reshdr, *resrefhdr;
+    struct synobj_header *synhdr;
+    int type, res;
+    if(resm_search_and_lock(&p->syns_opened, id, &resrefhdr) != OK) {
+        return ERR;
+    }
+    type = resrefhdr->type;
+    resm_unlock(&p->syns_opened, resrefhdr);
+    switch(type) {
+    case SEMAPHORE_TYPE_PLOCAL:
+    case SEMAPHORE_TYPE_PSHARED:
+        break;
+    default:
+        // мьютекс освобождает только захвативший его поток, для барьера действие не предусмотрено
+        return ERR;
+    }
+    // объект удерживается счетчиком использования до завершения sem_unlock,
+    // иначе он может быть удален после снятия блокировки хранилища
+    if(resm_search_and_lock(&syn_storage, id, &reshdr) != OK) {
+        return ERR_DEAD;
+    }
+    synhdr = (void *)reshdr + sizeof(struct res_header);
+    if(synhdr->flags & SNFO_FLAG_DELETED) {
+        resm_unlock(&syn_storage, reshdr);
+        return ERR_DEAD;
+    }
+    synhdr->inuse_cnt++;
+    resm_unlock(&syn_storage, reshdr);
+    res = sem_unlock((semaphore_t *)reshdr->ref, NULL);
+    syn_sem_put(id);
+    return res;
+}
+
+int syn_get_type (int id, struct process *p) {
+    struct res_header *resrefhdr;
+    int type;
+    if(resm_search_and_lock(&p->syns_opened, id, &resrefhdr) != OK) {
+        return ERR;
+    }
+    type = resrefhdr->type;
+    resm_unlock(&p->syns_opened, resrefhdr);
+    return type;
+}
+
+semaphore_t *syn_sem_get (int id, struct process *p) {
+    struct res_header *reshdr, *resrefhdr;
+    struct synobj_header *synhdr;
+    semaphore_t *sem = NULL;
+    if(resm_search_and_lock(&p->syns_opened, id, &resrefhdr) != OK) {
+        return NULL;
+    }
+    resm_unlock(&p->syns_opened, resrefhdr);
+    if(resrefhdr->type != SEMAPHORE_TYPE_PSHARED) {
+        // быстрые семафоры освобождаются без обращения к ядру, наблюдать их нельзя
+        return NULL;
+    }
+    if(resm_search_and_lock(&syn_storage, id, &reshdr) != OK) {
+        return NULL;
+    }
+    synhdr = (void *)reshdr + sizeof(struct res_header);
+    if(!(synhdr->flags & SNFO_FLAG_DELETED)) {
+        synhdr->inuse_cnt++;
+        sem = (semaphore_t *)reshdr->ref;
+    }
+    resm_unlock(&syn_storage, reshdr);
+    return sem;
+}
+
+void syn_sem_put (int id) {
+    struct res_header *reshdr;
+    struct synobj_header *synhdr;
+    if(resm_search_and_lock(&syn_storage, id, &reshdr) != OK) {
+        syshalt(SYSHALT_OOPS_ERROR);//panic("syn_storage consistency error on put");
+    }
+    synhdr = (void *)reshdr + sizeof(struct res_header);
+    synhdr->inuse_cnt--;
+    if( (synhdr->inuse_cnt == 0) && (synhdr->flags & (SNFO_FLAG_UNLINKED | SNFO_FLAG_DELETED)) ) {
+        resm_remove_locked(&syn_storage, reshdr);
+        return;
+    }
+    resm_unlock(&syn_storage, reshdr);
+}
+
 static void syns_opened_finalize(res_container_t *container, int id, struct res_header *resrefhdr) {
     struct res_header *reshdr;
     struct synobj_header *synhdr;
@@ -473,6 +559,7 @@ static void syns_created_finalize(res_container_t *container, int id, struct res
     case SEMAPHORE_TYPE_PLOCAL:
     case SEMAPHORE_TYPE_PSHARED:
         sem_wait_cancel((semaphore_t *)reshdr->ref, NULL);
+        port_source_close(&((semaphore_t *)reshdr->ref)->ports);
         break;
     case BARRIER_TYPE_PLOCAL:
     case BARRIER_TYPE_PSHARED:
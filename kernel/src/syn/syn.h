@@ -3,6 +3,7 @@
 
 #include <os_types.h>
 #include <proc.h>
+#include "sem.h"
 
 /**
  * Менеджер объектов синхронизации в системе (мьютексы, семафоры, барьеры,...)
@@ -17,6 +18,22 @@ int syn_open (char *pathname, enum syn_type type, struct process *p);
 int syn_close (int id, struct process *p);
 int syn_wait (int id, struct thread *thr, uint64_t timeout);
 int syn_done (int id, struct thread *thr);
+/**
+ * Освобождение семафора от имени ядра (без потока-владельца), например по срабатыванию таймера.
+ * Объект должен быть доступен процессу p
+ */
+int syn_post (int id, struct process *p);
+/**
+ * Тип доступного процессу объекта синхронизации или ERR
+ */
+int syn_get_type (int id, struct process *p);
+/**
+ * Захват доступного процессу семафора SEMAPHORE_TYPE_PSHARED для наблюдения портом ожидания,
+ * память объекта не освобождается до syn_sem_put (как при открытии объекта процессом)
+ * @return семафор или NULL
+ */
+semaphore_t *syn_sem_get (int id, struct process *p);
+void syn_sem_put (int id);
 
 void syn_proc_finalize(struct process *p);
 
@@ -0,0 +1,24 @@
+#include <thread.h>
+#include <mem\vm.h>
+
+// args = (int type, union os_info *info)
+void sc_get_info (struct thread *thr)
+{
+    int type = (int) thr->uregs->basic_regs[CPU_REG_0];
+    union os_info *info = (union os_info *) thr->uregs->basic_regs[CPU_REG_1];
+    int ret = OK;
+
+    if (vm_map_lookup(thr->proc->mmap, info, sizeof(union os_info)) != COMPLETE) {
+        thr->uregs->basic_regs[CPU_REG_0] = ERR_ILLEGAL_ARGS;
+        return;
+    }
+    switch (type) {
+    case OS_INFO_MEM:
+        vm_get_info(&info->mem);
+        break;
+    default:
+        ret = ERR_ILLEGAL_ARGS;
+        break;
+    }
+    thr->uregs->basic_regs[CPU_REG_0] = ret;
+}
@@ -2,6 +2,7 @@
 #include <mem\vm.h>
 #include <interrupt.h>
 #include <syn\ksyn.h>
+#include <port.h>
 
 // args = (int irq_id, irq_ctrl_t ctrl);
 void sc_irq_ctrl(struct thread *thr) {
@@ -15,14 +16,22 @@ void sc_irq_ctrl(struct thread *thr) {
         // номер прерывания корректный, найден соответствующий контекст прерывания
         kobject_lock(&irqctx->lock);
         struct thread *handler = (struct thread *)irqctx->handler;
+        struct process *owner = NULL;
+        int prio = 0;
         res = ERR_DEAD;
         if(handler != NULL) {
-            // есть обработчик на прерывании
-            if( proc_equals(handler->proc, thr->proc) == OK ) {
+            // есть обработчик на прерывании, поток или порт ожидания
+            if(irqctx->flags.type == INTERRUPT_PORT) {
+                owner = port_irq_owner(irqctx, &prio);
+            } else {
+                owner = handler->proc;
+                prio = handler->prio;
+            }
+            if( proc_equals(owner, thr->proc) == OK ) {
                 // только процесс-владелец прерывания может им управлять
                 interrupt_disable(irq_id);
                 interrupt_set_assert_type(irq_id, ctrl.assert_type);
-                interrupt_set_priority(irq_id, handler->prio);
+                interrupt_set_priority(irq_id, prio);
                 int i = 0;
 #ifdef BUILD_SMP
                 int numcore = cpu_get_core_id();
@@ -15,7 +15,10 @@ void sc_irq_release(struct thread *thr) {
         res = ERR_DEAD;
         if(handler != NULL) {
             // есть обработчик на прерывании
-            if( proc_equals(handler->proc, thr->proc) == OK ) {
+            if(irqctx->flags.type == INTERRUPT_PORT) {
+                // прерывание порта ожидания освобождается удалением из порта (os_port_ctl)
+                res = ERR_BUSY;
+            } else if( proc_equals(handler->proc, thr->proc) == OK ) {
                 // только процесс-владелец прерывания может его освободить
                 // но... нужно гарантировать корректность этой операции
                 // Для этого нужно запретить прерывание и обязательно
@@ -0,0 +1,13 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/mcast.h>
+
+// args = (int chid, const struct msg *m, uint64_t timeout)
+void sc_mcast_publish (struct thread *thr)
+{
+    int chid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    const struct msg *m = (const struct msg *)thr->uregs->basic_regs[CPU_REG_1];
+    uint64_t timeout = thr->uregs->basic_regs[CPU_REG_2];
+    timeout |= ((uint64_t)thr->uregs->basic_regs[CPU_REG_3]) << 32;
+    thr->uregs->basic_regs[CPU_REG_0] = mcast_publish(thr, chid, m, timeout);
+}
@@ -0,0 +1,13 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/mcast.h>
+
+// args = (int conid, struct msg **m, uint64_t timeout)
+void sc_mcast_receive (struct thread *thr)
+{
+    int conid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    struct msg **m = (struct msg **)thr->uregs->basic_regs[CPU_REG_1];
+    uint64_t timeout = thr->uregs->basic_regs[CPU_REG_2];
+    timeout |= ((uint64_t)thr->uregs->basic_regs[CPU_REG_3]) << 32;
+    thr->uregs->basic_regs[CPU_REG_0] = mcast_receive(thr, conid, m, timeout);
+}
@@ -0,0 +1,16 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/msg.h>
+
+// args = (int chid, void *buf, uint64_t timeout, size_t size, size_t *len)
+void sc_msg_receive (struct thread *thr)
+{
+    int chid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    void *buf = (void *)thr->uregs->basic_regs[CPU_REG_1];
+    uint64_t timeout = thr->uregs->basic_regs[CPU_REG_2];
+    timeout |= ((uint64_t)thr->uregs->basic_regs[CPU_REG_3]) << 32;
+    size_t size = (size_t)thr->uregs->basic_regs[CPU_REG_4];
+    size_t *len = (size_t *)thr->uregs->basic_regs[CPU_REG_5];
+    // результат записывается в регистр возврата внутри msg_receive
+    msg_receive(thr, chid, buf, size, len, timeout);
+}
@@ -0,0 +1,13 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/msg.h>
+
+// args = (int rcvid, int status, const void *buf, size_t len)
+void sc_msg_reply (struct thread *thr)
+{
+    int rcvid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    int status = (int)thr->uregs->basic_regs[CPU_REG_1];
+    const void *buf = (const void *)thr->uregs->basic_regs[CPU_REG_2];
+    size_t len = (size_t)thr->uregs->basic_regs[CPU_REG_3];
+    msg_reply(thr, rcvid, status, buf, len);
+}
@@ -0,0 +1,17 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/msg.h>
+
+// args = (int conid, const void *sbuf, size_t slen, void *rbuf, uint64_t timeout, size_t rlen)
+void sc_msg_send_recv (struct thread *thr)
+{
+    int conid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    const void *sbuf = (const void *)thr->uregs->basic_regs[CPU_REG_1];
+    size_t slen = (size_t)thr->uregs->basic_regs[CPU_REG_2];
+    void *rbuf = (void *)thr->uregs->basic_regs[CPU_REG_3];
+    uint64_t timeout = thr->uregs->basic_regs[CPU_REG_4];
+    timeout |= ((uint64_t)thr->uregs->basic_regs[CPU_REG_5]) << 32;
+    size_t rlen = (size_t)thr->uregs->basic_regs[CPU_REG_6];
+    // результат записывается в регистр возврата внутри msg_send_recv
+    msg_send_recv(thr, conid, sbuf, slen, rbuf, rlen, timeout);
+}
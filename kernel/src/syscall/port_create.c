@@ -0,0 +1,8 @@
+#include <proc.h>
+#include <port.h>
+
+// args = ();
+void sc_port_create(struct thread *thr) {
+    int res = port_create(thr->proc);
+    thr->uregs->basic_regs[CPU_REG_0] = res; // return val
+}
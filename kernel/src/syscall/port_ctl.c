@@ -0,0 +1,12 @@
+#include <proc.h>
+#include <port.h>
+
+// args = (int id, int op, const port_event_t *ev);
+void sc_port_ctl(struct thread *thr) {
+    // TODO какие-то проверки безопасности если нужно
+    int id = thr->uregs->basic_regs[CPU_REG_0];
+    int op = thr->uregs->basic_regs[CPU_REG_1];
+    const port_event_t *ev = (const port_event_t *)thr->uregs->basic_regs[CPU_REG_2];
+    int res = port_ctl(thr, id, op, ev);
+    thr->uregs->basic_regs[CPU_REG_0] = res; // return val
+}
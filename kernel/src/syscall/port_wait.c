@@ -0,0 +1,15 @@
+#include <proc.h>
+#include <port.h>
+
+// args = (int id, port_event_t *ev, uint64_t timeout, int n);
+void sc_port_wait(struct thread *thr) {
+    // TODO какие-то проверки безопасности если нужно
+    int id = thr->uregs->basic_regs[CPU_REG_0];
+    port_event_t *ev = (port_event_t *)thr->uregs->basic_regs[CPU_REG_1];
+    uint64_t timeout = thr->uregs->basic_regs[CPU_REG_2];
+    timeout |= ((uint64_t)thr->uregs->basic_regs[CPU_REG_3]) << 32;
+    int n = thr->uregs->basic_regs[CPU_REG_4];
+    // поток блокируется внутри вызова и продолжает его после пробуждения
+    int res = port_wait(thr, id, ev, n, timeout);
+    thr->uregs->basic_regs[CPU_REG_0] = res; // return val
+}
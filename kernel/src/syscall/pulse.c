@@ -0,0 +1,12 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/pulse.h>
+
+// args = (int conid, int code, uint32_t value)
+void sc_pulse (struct thread *thr)
+{
+    int conid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    int code = (int)thr->uregs->basic_regs[CPU_REG_1];
+    uint32_t value = (uint32_t)thr->uregs->basic_regs[CPU_REG_2];
+    thr->uregs->basic_regs[CPU_REG_0] = pulse_send(thr, conid, code, value);
+}
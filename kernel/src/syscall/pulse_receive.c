@@ -0,0 +1,13 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/pulse.h>
+
+// args = (int chid, pulse_t *p, uint64_t timeout)
+void sc_pulse_receive (struct thread *thr)
+{
+    int chid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    pulse_t *p = (pulse_t *)thr->uregs->basic_regs[CPU_REG_1];
+    uint64_t timeout = thr->uregs->basic_regs[CPU_REG_2];
+    timeout |= ((uint64_t)thr->uregs->basic_regs[CPU_REG_3]) << 32;
+    thr->uregs->basic_regs[CPU_REG_0] = pulse_receive(thr, chid, p, timeout);
+}
@@ -0,0 +1,11 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/msg.h>
+
+void sc_receive_release (struct thread *thr)
+{
+    int chid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    struct msg **m = (struct msg **)thr->uregs->basic_regs[CPU_REG_1];
+    int n = (int)thr->uregs->basic_regs[CPU_REG_2];
+    thr->uregs->basic_regs[CPU_REG_0] = receive_release(thr, chid, m, n);
+}
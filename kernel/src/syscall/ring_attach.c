@@ -0,0 +1,12 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/ring.h>
+
+// args = (int id, int side, os_ring_t **ring)
+void sc_ring_attach (struct thread *thr)
+{
+    int id = (int)thr->uregs->basic_regs[CPU_REG_0];
+    int side = (int)thr->uregs->basic_regs[CPU_REG_1];
+    os_ring_t **ring = (os_ring_t **)thr->uregs->basic_regs[CPU_REG_2];
+    thr->uregs->basic_regs[CPU_REG_0] = ring_attach(thr, id, side, ring);
+}
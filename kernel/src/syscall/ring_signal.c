@@ -0,0 +1,11 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/ring.h>
+
+// args = (int id, int side)
+void sc_ring_signal (struct thread *thr)
+{
+    int id = (int)thr->uregs->basic_regs[CPU_REG_0];
+    int side = (int)thr->uregs->basic_regs[CPU_REG_1];
+    thr->uregs->basic_regs[CPU_REG_0] = ring_signal(thr, id, side);
+}
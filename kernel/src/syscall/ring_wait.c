@@ -0,0 +1,13 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/ring.h>
+
+// args = (int id, int side, uint64_t timeout)
+void sc_ring_wait (struct thread *thr)
+{
+    int id = (int)thr->uregs->basic_regs[CPU_REG_0];
+    int side = (int)thr->uregs->basic_regs[CPU_REG_1];
+    uint64_t timeout = thr->uregs->basic_regs[CPU_REG_2];
+    timeout |= ((uint64_t)thr->uregs->basic_regs[CPU_REG_3]) << 32;
+    thr->uregs->basic_regs[CPU_REG_0] = ring_wait(thr, id, side, timeout);
+}
@@ -0,0 +1,14 @@
+#include <os_types.h>
+#include <thread.h>
+#include <ipc/msg.h>
+
+void sc_sendv (struct thread *thr)
+{
+    int conid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    struct msg_iov *iov = (struct msg_iov *)thr->uregs->basic_regs[CPU_REG_1];
+    uint64_t timeout = thr->uregs->basic_regs[CPU_REG_2];
+    timeout |= ((uint64_t)thr->uregs->basic_regs[CPU_REG_3]) << 32;
+    int flags = (int)thr->uregs->basic_regs[CPU_REG_4];
+    int iovcnt = (int)thr->uregs->basic_regs[CPU_REG_5];
+    thr->uregs->basic_regs[CPU_REG_0] = sendv(thr, conid, iov, iovcnt, timeout, flags);
+}
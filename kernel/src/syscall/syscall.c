@@ -30,12 +30,25 @@ void (*syscall_table[SYSCALL_NUM]) (struct thread *) =
 
             sc_send,                // SYSCALL_SEND,
             sc_receive,             // SYSCALL_RECEIVE,
+            sc_sendv,               // SYSCALL_SENDV,
+            sc_receive_batch,       // SYSCALL_RECEIVE_BATCH,
+            sc_receive_release,     // SYSCALL_RECEIVE_RELEASE,
             sc_channel_open,        // SYSCALL_CHANNEL_OPEN,
             sc_channel_wait_connection, // SYSCALL_CHANNEL_WAIT_CONNECTION,
             sc_channel_complete_connection, // SYSCALL_CHANNEL_COMPLETE_CONNECTION,
             sc_channel_close,       // SYSCALL_CHANNEL_CLOSE,
             sc_connection_open,     // SYSCALL_CONNECTION_OPEN,
             sc_connection_close,    // SYSCALL_CONNECTION_CLOSE,
+            sc_msg_send_recv,       // SYSCALL_MSG_SEND_RECV,
+            sc_msg_receive,         // SYSCALL_MSG_RECEIVE,
+            sc_msg_reply,           // SYSCALL_MSG_REPLY,
+            sc_ring_attach,         // SYSCALL_RING_ATTACH,
+            sc_ring_wait,           // SYSCALL_RING_WAIT,
+            sc_ring_signal,         // SYSCALL_RING_SIGNAL,
+            sc_mcast_publish,       // SYSCALL_MCAST_PUBLISH,
+            sc_mcast_receive,       // SYSCALL_MCAST_RECEIVE,
+            sc_pulse,               // SYSCALL_PULSE,
+            sc_pulse_receive,       // SYSCALL_PULSE_RECEIVE,
 
             sc_irq_hook,            // SYSCALL_IRQ_HOOK,
             sc_irq_release,         // SYSCALL_IRQ_RELEASE,
@@ -48,8 +61,17 @@ void (*syscall_table[SYSCALL_NUM]) (struct thread *) =
             sc_syn_wait,            // SYSCALL_SYN_WAIT,
             sc_syn_done,            // SYSCALL_SYN_DONE,
 
+            sc_timer_create,        // SYSCALL_TIMER_CREATE,
+            sc_timer_delete,        // SYSCALL_TIMER_DELETE,
+            sc_timer_set,           // SYSCALL_TIMER_SET,
+
+            sc_port_create,         // SYSCALL_PORT_CREATE,
+            sc_port_delete,         // SYSCALL_PORT_DELETE,
+            sc_port_ctl,            // SYSCALL_PORT_CTL,
+            sc_port_wait,           // SYSCALL_PORT_WAIT,
+
             NULL,// SYSCALL_SHUTDOWN,
-            NULL,// SYSCALL_GET_INFO,
+            sc_get_info,            // SYSCALL_GET_INFO,
             sc_time,                // SYSCALL_TIME,
             NULL// SYSCALL_CTRL,
 };
@@ -26,12 +26,25 @@ void sc_mfree (struct thread *thr);
 
 void sc_send (struct thread *thr);
 void sc_receive (struct thread *thr);
+void sc_sendv (struct thread *thr);
+void sc_receive_batch (struct thread *thr);
+void sc_receive_release (struct thread *thr);
 void sc_channel_open (struct thread *thr);
 void sc_channel_wait_connection (struct thread *thr);
 void sc_channel_complete_connection (struct thread *thr);
 void sc_channel_close (struct thread *thr);
 void sc_connection_open (struct thread *thr);
 void sc_connection_close (struct thread *thr);
+void sc_msg_send_recv (struct thread *thr);
+void sc_msg_receive (struct thread *thr);
+void sc_msg_reply (struct thread *thr);
+void sc_ring_attach (struct thread *thr);
+void sc_ring_wait (struct thread *thr);
+void sc_ring_signal (struct thread *thr);
+void sc_mcast_publish (struct thread *thr);
+void sc_mcast_receive (struct thread *thr);
+void sc_pulse (struct thread *thr);
+void sc_pulse_receive (struct thread *thr);
 
 void sc_syn_create(struct thread *thr);
 void sc_syn_delete(struct thread *thr);
@@ -40,11 +53,21 @@ void sc_syn_close(struct thread *thr);
 void sc_syn_wait(struct thread *thr);
 void sc_syn_done(struct thread *thr);
 
+void sc_timer_create(struct thread *thr);
+void sc_timer_delete(struct thread *thr);
+void sc_timer_set(struct thread *thr);
+
+void sc_port_create(struct thread *thr);
+void sc_port_delete(struct thread *thr);
+void sc_port_ctl(struct thread *thr);
+void sc_port_wait(struct thread *thr);
+
 void sc_irq_hook(struct thread *thr);
 void sc_irq_release(struct thread *thr);
 void sc_irq_ctrl(struct thread *thr);
 
 
+void sc_get_info(struct thread *thr);
 void sc_time(struct thread *thr);
 
 #endif /* SYSCALL_H_ */
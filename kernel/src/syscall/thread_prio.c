@@ -1,10 +1,49 @@
 #include <proc.h>
 #include <mem\vm.h>
+#include <interrupt.h>
+#include <syn\ksyn.h>
 
 // args = (int tid, int val)
 void sc_thread_prio (struct thread *thr)
 {
-    // TODO какие-то проверки безопасности если нужно
+    int tid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    int val = (int)thr->uregs->basic_regs[CPU_REG_1];
+    struct thread *t;
 
-    asm volatile ("bkpt");
+    thread_allocator_lock();
+    t = (tid == 0) ? thr : get_thr(tid);
+    if ((t == NULL) || (t->state == DEAD)) {
+        thread_allocator_unlock();
+        thr->uregs->basic_regs[CPU_REG_0] = ERR_ILLEGAL_ARGS;
+        return;
+    }
+    if (proc_equals(t->proc, thr->proc) != OK) {
+        // приоритетом управляют только потоки того же процесса
+        thread_allocator_unlock();
+        thr->uregs->basic_regs[CPU_REG_0] = ERR_ACCESS_DENIED;
+        return;
+    }
+    if (val == PRIO_GET_CURRENT) {
+        val = thread_own_prio(t);
+        thread_allocator_unlock();
+        thr->uregs->basic_regs[CPU_REG_0] = val;
+        return;
+    }
+    if (!PRIORITY_IS_VALID(val)) {
+        thread_allocator_unlock();
+        thr->uregs->basic_regs[CPU_REG_0] = ERR_ILLEGAL_ARGS;
+        return;
+    }
+    // смена приоритета с перепостановкой в очередь планирования и в очереди ожидания
+    // мьютексов с наследованием; текущий поток будет вытеснен при выходе из вызова,
+    // если приоритет понижен и есть более приоритетный готовый поток
+    mutex_thread_prio(t, val);
+    if (t->irqctx != NULL) {
+        // приоритет прерывания следует за приоритетом потока-обработчика
+        kobject_lock(&t->irqctx->lock);
+        interrupt_set_priority(t->irqctx->id, val);
+        kobject_unlock(&t->irqctx->lock);
+    }
+    thread_allocator_unlock();
+    thr->uregs->basic_regs[CPU_REG_0] = val; // return val
 }
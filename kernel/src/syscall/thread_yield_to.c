@@ -1,7 +1,23 @@
 #include <thread.h>
 
 // args = (int tid)
-void sc_thread_yield_to(struct thread *thr)
+void sc_thread_yield_to (struct thread *thr)
 {
-    asm volatile ("bkpt");
+    int tid = (int)thr->uregs->basic_regs[CPU_REG_0];
+    struct thread *t = get_thr(tid);
+
+    if ((t == NULL) || (t == thr)) {
+        thr->uregs->basic_regs[CPU_REG_0] = ERR_ILLEGAL_ARGS;
+        return;
+    }
+    if (t->state != READY) {
+        // передавать квант можно только готовому к выполнению потоку
+        thr->uregs->basic_regs[CPU_REG_0] = ERR_BUSY;
+        return;
+    }
+    // переход с RUNNING на READY текущего потока приведет к перепостановке потока в очередь,
+    // а диспетчер переключится сразу на указанный поток с передачей ему остатка кванта и приоритета
+    thr->yield_to = t;
+    thr->state = READY;
+    thr->uregs->basic_regs[CPU_REG_0] = OK; // return val
 }
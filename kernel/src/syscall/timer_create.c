@@ -0,0 +1,10 @@
+#include <proc.h>
+#include <ktimer.h>
+
+// args = (const timer_notify_t *notify);
+void sc_timer_create(struct thread *thr) {
+    // TODO какие-то проверки безопасности если нужно
+    const timer_notify_t *n = (const timer_notify_t *)thr->uregs->basic_regs[CPU_REG_0];
+    int res = ktimer_create(thr->proc, n);
+    thr->uregs->basic_regs[CPU_REG_0] = res; // return val
+}
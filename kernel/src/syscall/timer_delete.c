@@ -0,0 +1,9 @@
+#include <proc.h>
+#include <ktimer.h>
+
+// args = (int id);
+void sc_timer_delete(struct thread *thr) {
+    int id = thr->uregs->basic_regs[CPU_REG_0];
+    int res = ktimer_delete(thr->proc, id);
+    thr->uregs->basic_regs[CPU_REG_0] = res; // return val
+}
@@ -0,0 +1,12 @@
+#include <proc.h>
+#include <ktimer.h>
+
+// args = (int id, const timer_spec_t *spec, int flags);
+void sc_timer_set(struct thread *thr) {
+    // TODO какие-то проверки безопасности если нужно
+    int id = thr->uregs->basic_regs[CPU_REG_0];
+    const timer_spec_t *spec = (const timer_spec_t *)thr->uregs->basic_regs[CPU_REG_1];
+    int flags = thr->uregs->basic_regs[CPU_REG_2];
+    int res = ktimer_set(thr->proc, id, spec, flags);
+    thr->uregs->basic_regs[CPU_REG_0] = res; // return val
+}
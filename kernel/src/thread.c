@@ -294,6 +294,7 @@ void thread_switch (struct thread *from, struct thread *to,
             struct thread_tls_user *tls = cpu_context_get_tls(to->uregs);
             tls->tid = to->tid;
             tls->pid = to->proc->pid;
+            tls->time_page = proc_get_time_page();
             _REENT_INIT_PTR(&tls->reent);
         }
         switch(to->substate) {
@@ -403,6 +404,7 @@ void thread_exit (struct thread *ct)
     thread_unlock(ct);
     proc_unlock(cp);
 
+    mutex_owner_exit(ct);
     ct->state = DEAD;
 
     log_info("-tid %i:%i\n\r", ct->proc->pid, ct->tid);
@@ -422,6 +424,11 @@ void thread_finalize (struct thread *thr) {
     thread_allocator_lock();
     thread_tbl[thr->tid] = NULL;
     tid_cnt--;
+    // буферы синхронного обмена потока, удаленного во время ожидания
+    if (thr->rdv.stage)
+        kfree(thr->rdv.stage);
+    if (thr->rdv.kbuf)
+        kfree(thr->rdv.kbuf);
 //    vm_free(thr->proc->mmap, thr->stack);
 //    vm_free(thr->proc->mmap, thr->sys_stack);
     kfree(thr);
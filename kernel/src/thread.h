@@ -29,14 +29,22 @@ struct thread {
     size_t sys_stack_size;
 
     int prio;                               //!< текущий (динамический) приоритет потока
+    int base_prio;                          //!< приоритет без учета наследования, если pi_boosted
+    mutex_t *pi_held;                       //!< удерживаемые мьютексы с наследованием и ожидающими потоками
+    int msg_prio;                           //!< приоритет клиента обрабатываемого сообщения, 0 - нет наследования
     int nice;
     uint64_t time_slice;
     uint64_t time_sum;
-    struct thread *time_grant;              //!< грант кванта вызовом yield_to
+    struct thread *time_grant;              //!< грант кванта вызовом yield_to (поток-донор)
+    struct thread *yield_to;                //!< поток, которому передается квант вызовом yield_to
+    int grant_prio;                         //!< собственный приоритет потока на время гранта
+    uint64_t grant_sum;                     //!< собственное рабочее время в кванте на время гранта
 
     struct {
         int core :4;                        //!< ядро на котором выполняется или выполнялся поток
         int running :1;
+        unsigned int queued :1;             //!< поток находится в очереди готовых
+        unsigned int pi_boosted :1;         //!< приоритет повышен наследованием
     };
 
     enum {
@@ -65,6 +73,11 @@ struct thread {
             WAIT_CONNECT,
             SEND,
             RECEIVE,
+            MSG_SEND,                       //!< синхронный запрос ожидает получателя
+            MSG_REPLY,                      //!< синхронный запрос ожидает ответа
+            MSG_RECEIVE,                    //!< синхронный прием ожидает запроса
+            MSG_PULSE,                      //!< прием ожидает импульса
+            PORT_WAIT,                      //!< ожидание событий порта
             WFI
         } type;
         union {
@@ -79,10 +92,26 @@ struct thread {
             } send;
             struct connection *connection;
             struct channel *channel;
+            struct port *port;
         } object;
     } block;
 
+    //! буферы синхронного обмена os_msg_send_recv/os_msg_receive на время блокировки
+    struct {
+        const void *sbuf;                   //!< данные запроса
+        size_t slen;
+        void *rbuf;                         //!< буфер ответа (отправитель) или запроса (получатель)
+        size_t rlen;
+        size_t *len;                        //!< размер принятого запроса (получатель)
+        void *stage;                        //!< копия запроса в памяти ядра для другого процесса (отправитель)
+        void *kbuf;                         //!< принятые данные в памяти ядра, копируются в rbuf после пробуждения
+        size_t klen;                        //!< размер принятых данных
+    } rdv;
+
     struct kevent *block_evt; //!< событие, == NULL - сработало или не было установлено; != NULL было установлено
+#ifdef BUILD_KEVENT_WHEEL
+    struct kevent evt;        //!< узел события потока в колесе таймеров менеджера событий
+#endif
 
     struct thread *last_joined;
 
@@ -194,6 +223,11 @@ static inline int thread_preemptable(struct thread *current, struct thread *pend
     return (pending->prio < current->prio);
 }
 
+// Собственный приоритет потока без учета наследования и гранта
+static inline int thread_own_prio(const struct thread *thr) {
+    return (thr->time_grant != NULL) ? thr->grant_prio : (thr->pi_boosted ? thr->base_prio : thr->prio);
+}
+
 
 /**
     \Brief Основная функция смены контекста процессора на целевой поток текущего или другого процесса.
@@ -336,6 +370,22 @@ static inline void thread_receive_block (struct thread *thr, struct channel *cha
     thr->block_list.next = thr->block_list.prev = NULL;
 }
 
+static inline void thread_msg_block (struct thread *thr, int type, struct channel *channel)
+{
+    thr->state = BLOCKED;
+    thr->block.type = type;
+    thr->block.object.channel = channel;
+    thr->block_list.next = thr->block_list.prev = NULL;
+}
+
+static inline void thread_port_block (struct thread *thr, struct port *port)
+{
+    thr->state = BLOCKED;
+    thr->block.type = PORT_WAIT;
+    thr->block.object.port = port;
+    thr->block_list.next = thr->block_list.prev = NULL;
+}
+
 static inline void thread_unblock (struct thread *thr)
 {
     if (thr->state != BLOCKED)
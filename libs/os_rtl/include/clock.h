@@ -0,0 +1,12 @@
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <os_types.h>
+
+/**
+ * Получение времени OS_CLOCK_MONOTONIC или OS_CLOCK_REALTIME по странице времени
+ * без системного вызова, если страница времени недоступна - через os_time
+ */
+extern int os_clock_get(int clock_id, kernel_time_t *tv);
+
+#endif /* CLOCK_H_ */
@@ -0,0 +1,55 @@
+#ifndef IPC_H_
+#define IPC_H_
+
+#include <os_types.h>
+
+/**
+ * Выделение буфера данных сообщения для передачи переносом страниц (os_send с MSG_MOVE_PAGES).
+ * Буфер занимает собственный сегмент из целого числа страниц, после успешной отправки
+ * он становится недоступен отправителю
+ * @param size  - размер данных, байт
+ * @return указатель на буфер или NULL при нехватке памяти
+ */
+extern void *os_msg_pages_alloc(size_t size);
+
+/**
+ * Освобождение принятого сообщения. Страницы, перенесенные в процесс отправителем
+ * (описание сегмента SYS_MSG_MEM_SEND), освобождаются, для остальных сообщений
+ * действий не требуется
+ * @param m  - сообщение, полученное os_receive
+ * @return OK или код ошибки освобождения памяти
+ */
+extern int os_msg_release(msg_t *m);
+
+/**
+ * Запись сообщения в кольцо канала CHANNEL_SHARED_RING (сторона RING_PRODUCER).
+ * Системный вызов выполняется только при заполненном кольце для ожидания места
+ * и при появлении данных, если потребитель ожидает их.
+ * Запись допускается только одним потоком процесса-производителя
+ * @param ring      - кольцо, полученное os_ring_attach
+ * @param conid     - соединение с каналом кольца
+ * @param buf       - данные
+ * @param len       - размер данных, не более OS_RING_MSG_MAX(ring)
+ * @param timeout   - время ожидания места в кольце, нс
+ * @return OK или код ошибки
+ */
+extern int os_ring_put(os_ring_t *ring, int conid, const void *buf, size_t len, uint64_t timeout);
+
+/**
+ * Чтение сообщения из кольца канала CHANNEL_SHARED_RING (сторона RING_CONSUMER).
+ * Системный вызов выполняется только при пустом кольце для ожидания данных
+ * и при освобождении места, если производитель ожидает его.
+ * Чтение допускается только одним потоком процесса-владельца канала
+ * @param ring      - кольцо, полученное os_ring_attach
+ * @param chid      - канал кольца
+ * @param buf       - приемный буфер
+ * @param size      - размер приемного буфера
+ * @param timeout   - время ожидания данных, нс
+ * @return размер принятого сообщения или код ошибки,
+ *         ERR_NO_MEM - сообщение не помещается в буфер и остается в кольце
+ */
+extern int os_ring_get(os_ring_t *ring, int chid, void *buf, size_t size, uint64_t timeout);
+
+#define OS_RING_MSG_MAX(r)  ((r)->size / 2 - sizeof(uint32_t))  //!< наибольший размер сообщения кольца
+
+#endif /* IPC_H_ */
@@ -8,6 +8,8 @@
 #include <thread.h>
 #include <pthread_ext.h>
 #include <semaphore.h>
+#include <clock.h>
+#include <ipc.h>
 
 
 #endif /* OS_LIBC_H_ */
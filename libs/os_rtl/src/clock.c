@@ -0,0 +1,95 @@
+#include <os-libc.h>
+#include <time.h>
+
+#ifndef CLOCK_MONOTONIC
+#define CLOCK_MONOTONIC     ((clockid_t) 4)
+#endif
+
+/**
+ * Модуль получения времени процессом без системных вызовов.
+ * Ядро отображает в каждый процесс только для чтения страницу времени и регистр счетчика
+ * аппаратного таймера (struct os_time_page), ссылка на страницу находится в TLS потока.
+ * Значения времени на момент последнего обновления ядром дополняются временем по счетчику.
+ */
+
+static int time_page_get (const struct os_time_page *tp, int clock_id, kernel_time_t *tv)
+{
+    uint32_t seq, ticks;
+    uint64_t ns, time_ns;
+    kernel_time_t rtime;
+
+    while(1) {
+        seq = tp->seq;
+        if(seq & OS_TIME_PAGE_SEQ_VALID) {
+            __sync_synchronize();
+            if(tp->flags & OS_TIME_PAGE_COUNTER_UP) {
+                ticks = *tp->counter - tp->counter_base;
+            } else {
+                ticks = tp->counter_base - *tp->counter;
+            }
+            ns = ((uint64_t)ticks * tp->mult) >> tp->shift;
+            time_ns = tp->time_ns;
+            rtime = tp->rtime;
+            __sync_synchronize();
+            if(tp->seq == seq) {
+                break;
+            }
+        }
+    }
+    if(clock_id == OS_CLOCK_MONOTONIC) {
+        tv->tv_sec = 0;
+        tv->tv_nsec = time_ns + ns;
+        return OK;
+    }
+    rtime.tv_nsec += ns;
+    while(rtime.tv_nsec >= 1000000000) {
+        rtime.tv_nsec -= 1000000000;
+        rtime.tv_sec++;
+    }
+    *tv = rtime;
+    return OK;
+}
+
+int os_clock_get (int clock_id, kernel_time_t *tv)
+{
+    const struct os_time_page *tp = __tls()->time_page;
+    if( (clock_id != OS_CLOCK_MONOTONIC) && (clock_id != OS_CLOCK_REALTIME) ) {
+        return ERR;
+    }
+    if((tp == NULL) || (tp->counter == NULL)) {
+        // счетчик таймера не отображен в процесс
+        return os_time(clock_id, tv, NULL);
+    }
+    return time_page_get(tp, clock_id, tv);
+}
+
+int clock_gettime (clockid_t clock_id, struct timespec *tp)
+{
+    kernel_time_t t;
+    int res;
+    if(tp == NULL) {
+        errno = EFAULT;
+        return -1;
+    }
+    switch(clock_id) {
+    case CLOCK_REALTIME:
+        res = os_clock_get(OS_CLOCK_REALTIME, &t);
+        break;
+    case CLOCK_MONOTONIC:
+        res = os_clock_get(OS_CLOCK_MONOTONIC, &t);
+        // время от старта системы возвращается только в нс
+        t.tv_sec = t.tv_nsec / 1000000000;
+        t.tv_nsec -= t.tv_sec * 1000000000;
+        break;
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+    if(res != OK) {
+        errno = EINVAL;
+        return -1;
+    }
+    tp->tv_sec = t.tv_sec;
+    tp->tv_nsec = t.tv_nsec;
+    return 0;
+}
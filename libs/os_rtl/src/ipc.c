@@ -0,0 +1,168 @@
+#include <os.h>
+#include <ipc.h>
+#include <string.h>
+#include <syn\atomics.h>
+#include <syn\_atomics.h>
+#include <syn\_barrier.h>
+
+/**
+ * Модуль поддержки передачи больших сообщений переносом страниц.
+ * Данные, занимающие собственный сегмент страничной памяти, ядро переносит
+ * в карту памяти получателя вместо копирования в буфер канала (os_send с MSG_MOVE_PAGES),
+ * получатель освобождает перенесенные страницы после обработки сообщения.
+ */
+
+static mem_attributes_t msg_pages_attr = {
+    .shared = MEM_SHARED_OFF, //
+    .exec = MEM_EXEC_NEVER, //
+    .type = MEM_TYPE_NORMAL, //
+    .inner_cached = MEM_CACHED_WRITE_BACK, //
+    .outer_cached = MEM_CACHED_WRITE_BACK, //
+    .process_access = MEM_ACCESS_RW, //
+    .os_access = MEM_ACCESS_RW //
+        };
+
+void *os_msg_pages_alloc (size_t size)
+{
+    size_t pages = (size + DEFAULT_PAGE_SIZE - 1) / DEFAULT_PAGE_SIZE;
+    if (pages == 0) {
+        return NULL;
+    }
+    return os_malloc(pages, msg_pages_attr, 0);
+}
+
+int os_msg_release (msg_t *m)
+{
+    if ((m == NULL) || (m->sys.ptr == NULL) || (m->sys.memcmd->_type != SYS_MSG_MEM_SEND)) {
+        return OK;
+    }
+    return os_mfree(m->sys.memcmd->seg.adr);
+}
+
+
+/**
+ * Кольца каналов CHANNEL_SHARED_RING.
+ * Запись кольца - заголовок с размером данных и данные, выровненные на 4 байта.
+ * Если запись не помещается до конца области данных, остаток заполняется
+ * признаком RING_WRAP и запись размещается с начала области.
+ * Наибольший размер записи - половина области данных, поэтому в пустом кольце
+ * запись помещается всегда.
+ * Сторона, собирающаяся ожидать, выставляет признак ожидания и перепроверяет индекс
+ * другой стороны, другая сторона после изменения своего индекса проверяет признак
+ * и звонит, так одна из сторон обязательно видит изменение другой. Звонок - счетчик
+ * быстрого семафора в заголовке кольца, системные вызовы выполняются только
+ * для блокировки ожидающей стороны и ее пробуждения.
+ */
+
+#define RING_WRAP       0xffffffffUL
+
+static inline uint32_t ring_rec_size (size_t len)
+{
+    return (sizeof(uint32_t) + len + 3) & ~3UL;
+}
+
+static int ring_bell_wait (atomic_t *bell, int id, int side, uint64_t timeout)
+{
+    if (atomic_dec_if_gz(bell) == 0) {
+        return OK;
+    }
+    return os_ring_wait(id, side, timeout);
+}
+
+static int ring_bell_signal (atomic_t *bell, int id, int side)
+{
+    if (atomic_inc_if_gez_unless(bell, 1) == 0) {
+        // звонок оставлен, ожидающих нет
+        return OK;
+    }
+    return os_ring_signal(id, side);
+}
+
+int os_ring_put (os_ring_t *ring, int conid, const void *buf, size_t len, uint64_t timeout)
+{
+    uint8_t *data = OS_RING_DATA(ring);
+    uint32_t need = ring_rec_size(len);
+    uint32_t tail = ring->tail;
+    uint32_t pos = tail & (ring->size - 1);
+    uint32_t pad = (ring->size - pos < need) ? ring->size - pos : 0;
+    int res;
+
+    if ((len == 0) || (len > OS_RING_MSG_MAX(ring))) {
+        return ERR_ILLEGAL_ARGS;
+    }
+    while (ring->size - (tail - ring->head) < pad + need) {
+        ring->space_wait = 1;
+        dmb();
+        if (ring->size - (tail - ring->head) >= pad + need) {
+            ring->space_wait = 0;
+            break;
+        }
+        res = ring_bell_wait(&ring->space_bell, conid, RING_PRODUCER, timeout);
+        if (res != OK) {
+            ring->space_wait = 0;
+            return res;
+        }
+    }
+    // чтение head выше упорядочено перед записью данных на освобожденное место
+    dmb();
+    if (pad) {
+        *(uint32_t *)(data + pos) = RING_WRAP;
+        pos = 0;
+    }
+    *(uint32_t *)(data + pos) = len;
+    memcpy(data + pos + sizeof(uint32_t), buf, len);
+    dmb();
+    ring->tail = tail + pad + need;
+    dmb();
+    if (ring->data_wait) {
+        ring->data_wait = 0;
+        return ring_bell_signal(&ring->data_bell, conid, RING_PRODUCER);
+    }
+    return OK;
+}
+
+int os_ring_get (os_ring_t *ring, int chid, void *buf, size_t size, uint64_t timeout)
+{
+    uint8_t *data = OS_RING_DATA(ring);
+    uint32_t head = ring->head;
+    uint32_t pos, len;
+    int res;
+
+    while (ring->tail == head) {
+        ring->data_wait = 1;
+        dmb();
+        if (ring->tail != head) {
+            ring->data_wait = 0;
+            break;
+        }
+        res = ring_bell_wait(&ring->data_bell, chid, RING_CONSUMER, timeout);
+        if (res != OK) {
+            ring->data_wait = 0;
+            return res;
+        }
+    }
+    // чтение tail выше упорядочено перед чтением данных записи
+    dmb();
+    pos = head & (ring->size - 1);
+    len = *(uint32_t *)(data + pos);
+    if (len == RING_WRAP) {
+        head += ring->size - pos;
+        pos = 0;
+        len = *(uint32_t *)data;
+    }
+    if (len > size) {
+        return ERR_NO_MEM;
+    }
+    memcpy(buf, data + pos + sizeof(uint32_t), len);
+    dmb();
+    ring->head = head + ring_rec_size(len);
+    dmb();
+    if (ring->space_wait) {
+        ring->space_wait = 0;
+        res = ring_bell_signal(&ring->space_bell, chid, RING_CONSUMER);
+        if (res != OK) {
+            return res;
+        }
+    }
+    return len;
+}
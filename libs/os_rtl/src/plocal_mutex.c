@@ -41,13 +41,19 @@ int plocal_mutex_done (syn_t *m) {
     // выполняем самоконтроль перед попыткой быстрого освобождения без системного вызова
     if(m->owner_tid != *tls_tid_value) {
         res = ERR_ACCESS_DENIED;
-    } else if (atomic_inc_if_zero(&m->cnt) == 0) {
-        // выполнена быстрая транзакция освобождения мьютекса в отсутствии ожидающих в очереди
-        res = OK;
     } else {
-        // очередь заблокированных на мьютексе потоков не пустая, необходимо разблокировать
-        // следующий поток в очереди
-        res = os_syn_done(m->id);
+        // номер владельца сбрасывается до освобождения, чтобы ядро не приняло
+        // за владельца (при наследовании приоритета) уже освободивший мьютекс поток
+        m->owner_tid = 0;
+        if (atomic_inc_if_zero(&m->cnt) == 0) {
+            // выполнена быстрая транзакция освобождения мьютекса в отсутствии ожидающих в очереди
+            res = OK;
+        } else {
+            // очередь заблокированных на мьютексе потоков не пустая, необходимо разблокировать
+            // следующий поток в очереди
+            m->owner_tid = *tls_tid_value;
+            res = os_syn_done(m->id);
+        }
     }
     return res;
 }
@@ -178,9 +178,11 @@ int pthread_mutexattr_setprotocol (pthread_mutexattr_t *__attr, int __protocol)
     switch(__protocol) {
     case PTHREAD_PRIO_NONE:
     case PTHREAD_PRIO_INHERIT:
-    case PTHREAD_PRIO_PROTECT:
         __attr->protocol = __protocol;
         break;
+    case PTHREAD_PRIO_PROTECT:
+        // протокол потолка приоритета ядром не поддерживается
+        return ENOTSUP;
     default:
         return EINVAL;
     }
@@ -217,6 +219,7 @@ int pthread_named_mutex_init (pthread_mutex_t *__mutex, _CONST pthread_mutexattr
     }
     synobj = malloc(sizeof(syn_t));
     synobj->pathname = pathname;
+    synobj->flags = (__attr->protocol == PTHREAD_PRIO_INHERIT) ? SYN_FLAG_PRIO_INHERIT : NO_FLAGS;
     switch(__attr->process_shared) {
     case PTHREAD_PROCESS_PRIVATE:
         synobj->type = MUTEX_TYPE_PLOCAL;
@@ -6,6 +6,7 @@ PROCNAME("logger");
 #include <stdlib.h>
 
 #define PRINT_BUF    4096
+#define FORWARD_MAX  (PRINT_BUF / 2)     // предельный размер пересылаемого пакета записей
 
 #define DEBUG_ASSERT_SC(x) {if (x < 0) {err_t err = (err_t)x; asm volatile ("bkpt");}}
 
@@ -50,9 +51,29 @@ int main (int argc, char *argv[])
     }
 
     for (;;) {
-        struct msg *msg = NULL;
-        DEBUG_ASSERT_SC(os_receive(input, &msg, TIMEOUT_INFINITY));
-        os_send(output, msg, TIMEOUT_INFINITY, NO_FLAGS);
+        // накопившиеся записи принимаются пакетом и пересылаются с объединением
+        // в одно сообщение, вместо пары вызовов на каждую запись
+        struct msg *msgs[MSG_IOV_MAX];
+        struct msg_iov iov[MSG_IOV_MAX];
+        int n = os_receive_batch(input, msgs, MSG_IOV_MAX, TIMEOUT_INFINITY);
+        DEBUG_ASSERT_SC(n);
+        if (n <= 0)
+            continue;
+        int cnt = 0;
+        size_t size = 0;
+        for (int i = 0; i < n; i++) {
+            if (cnt && (size + msgs[i]->size > FORWARD_MAX)) {
+                os_sendv(output, iov, cnt, TIMEOUT_INFINITY, NO_FLAGS);
+                cnt = 0;
+                size = 0;
+            }
+            iov[cnt].base = msgs[i]->data;
+            iov[cnt].len = msgs[i]->size;
+            size += msgs[i]->size;
+            cnt++;
+        }
+        os_sendv(output, iov, cnt, TIMEOUT_INFINITY, NO_FLAGS);
+        DEBUG_ASSERT_SC(os_receive_release(input, msgs, n));
     }
 
     return ERR;
@@ -0,0 +1,465 @@
+#include <os.h>
+#include <string.h>
+/**
+ * Набор измерений производительности обмена сообщениями
+ *
+ *  Клиент (основной поток) и сервер (создаваемый для каждого измерения поток) обмениваются
+ *  через каналы процесса, каждый замер выполняется по счетчику тактов PMU (PMCCNTR),
+ *  ядро должно быть собрано с BUILD_PMU_USER (в bsp/config.h по умолчанию выключен,
+ *  без него чтение PMCCNTR в режиме пользователя вызывает исключение). Измеряются:
+ *   - oneway   - задержка доставки os_send до выхода получателя из os_receive,
+ *                получатель - отдельный процесс tests/test_ipc_bench_server (образ должен быть
+ *                загружен по адресу PROC_SERVER) с более высоким приоритетом, момент приема
+ *                он возвращает подтверждением в канал IPCB_ACK;
+ *                var=copy - копирование в буфер канала, var=move - MSG_MOVE_PAGES
+ *                (точка перехода между ними по размеру сообщения)
+ *   - rtt      - запрос-ответ: var=sync - os_msg_send_recv/os_msg_reply,
+ *                var=async - os_send/os_receive в обе стороны через два канала
+ *   - tput     - поток сообщений фиксированного размера в канал с разным размером буфера,
+ *                гистограмма стоимости os_send, cycles - общее время до приема всех сообщений
+ *   - complete - стоимость os_send без флагов и с MSG_WAIT_COMPLETE
+ *  При BENCH_SMP дополнительно выполняются oneway и rtt с получателем, опрашивающим канал
+ *  без блокировки (var=poll): оба потока остаются готовыми и в сборке ядра с BUILD_SMP
+ *  выполняются на разных ядрах.
+ *
+ *  Результаты выводятся в UART2 (консоль sabrelite) строками вида
+ *      IPCB test=<тест> var=<вариант> size=<байт> buf=<байт> n=<замеров> min=<такты> avg=<такты>
+ *           max=<такты> [cycles=<такты>] hist=<b0>,<b1>,...,<b31>
+ *  где bi - число замеров длительностью [2^i, 2^(i+1)) тактов (b0 - также 0 тактов).
+ *  Вывод начинается строкой "IPCB begin" и завершается строкой "IPCB end".
+ */
+
+//#define BENCH_SMP
+
+#define PROC_SERVER             0x10600000
+#define IPCB_ACK                "ipcb_ack"
+#define IPCB_ONEWAY             "ipcb_oneway"   // канал процесса-получателя oneway
+
+#define BENCH_ITERS             1000
+#define BENCH_TPUT_ITERS        2000
+#define BENCH_TPUT_SIZE         256
+#define BENCH_SIZE_MAX          65536
+#define BENCH_CHANNEL_SIZE      (BENCH_SIZE_MAX * 2)
+#define BENCH_HIST_BUCKETS      32
+#define BENCH_MOVE_MIN          0x4000      // MSG_MOVE_PAGES_MIN ядра
+
+#define BENCH_UART_BASE         0x021E8000  // UART2
+#define BENCH_UART_UTXD         (*(volatile uint32_t *)(BENCH_UART_BASE + 0x40))
+#define BENCH_UART_UTS          (*(volatile uint32_t *)(BENCH_UART_BASE + 0xB4))
+#define BENCH_UART_UTS_TXFULL   0x10
+
+struct hist {
+    uint32_t n;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t b[BENCH_HIST_BUCKETS];
+};
+
+// параметры измерения для потока-сервера
+struct bench {
+    char *reply_pathname;
+    int chid;
+    int iters;
+    int poll;
+};
+
+static const size_t bench_sizes[] = { 0, 16, 64, 256, 1024, 4096, 16384, 65536 };
+static const int bench_bufs[] = { 4096, 16384, 65536, 262144 };
+
+static const mem_attributes_t devattr = {
+    .shared = MEM_SHARED_OFF, //
+    .exec = MEM_EXEC_NEVER, //
+    .type = MEM_TYPE_DEVICE, //
+    .inner_cached = MEM_CACHED_OFF, //
+    .outer_cached = MEM_CACHED_OFF, //
+    .process_access = MEM_ACCESS_RW, //
+    .os_access = MEM_ACCESS_RW, //
+    .security = MEM_SECURITY_OFF
+};
+
+static const mem_attributes_t memattr = {
+    .shared = MEM_SHARED_OFF, //
+    .exec = MEM_EXEC_NEVER, //
+    .type = MEM_TYPE_NORMAL, //
+    .inner_cached = MEM_CACHED_WRITE_BACK, //
+    .outer_cached = MEM_CACHED_WRITE_BACK, //
+    .process_access = MEM_ACCESS_RW, //
+    .os_access = MEM_ACCESS_RW, //
+    .security = MEM_SECURITY_OFF
+};
+
+static uint8_t txbuf[BENCH_SIZE_MAX];
+static uint8_t rxbuf[BENCH_SIZE_MAX];
+static uint8_t srvbuf[BENCH_SIZE_MAX];
+static struct hist hist;
+static struct bench bench;
+static volatile int served;             // число сообщений, принятых сервером
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+static inline uint32_t ccnt() {
+    uint32_t c;
+    asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r" (c));
+    return c;
+}
+
+static void uart_putc(char c) {
+    while(BENCH_UART_UTS & BENCH_UART_UTS_TXFULL);
+    BENCH_UART_UTXD = c;
+}
+
+static void out_str(const char *s) {
+    while(*s) {
+        if(*s == '\n') {
+            uart_putc('\r');
+        }
+        uart_putc(*s++);
+    }
+}
+
+static void out_u64(uint64_t v) {
+    char buf[21];
+    int i = sizeof(buf) - 1;
+    buf[i] = 0;
+    do {
+        buf[--i] = '0' + (v % 10);
+        v /= 10;
+    } while(v);
+    out_str(&buf[i]);
+}
+
+static void out_kv(const char *key, uint64_t v) {
+    out_str(" ");
+    out_str(key);
+    out_str("=");
+    out_u64(v);
+}
+
+static void hist_reset() {
+    memset(&hist, 0, sizeof(hist));
+    hist.min = 0xFFFFFFFF;
+}
+
+static void hist_add(uint32_t cycles) {
+    int i = (cycles != 0) ? (31 - __builtin_clz(cycles)) : 0;
+    hist.b[i]++;
+    hist.n++;
+    hist.sum += cycles;
+    if(cycles < hist.min) {
+        hist.min = cycles;
+    }
+    if(cycles > hist.max) {
+        hist.max = cycles;
+    }
+}
+
+// cycles - общее время измерения, 0 - не выводится
+static void out_result(const char *test, const char *var, size_t size, int buf, uint32_t cycles) {
+    out_str("IPCB test=");
+    out_str(test);
+    out_str(" var=");
+    out_str(var);
+    out_kv("size", size);
+    out_kv("buf", buf);
+    out_kv("n", hist.n);
+    out_kv("min", hist.n ? hist.min : 0);
+    out_kv("avg", hist.n ? hist.sum / hist.n : 0);
+    out_kv("max", hist.max);
+    if(cycles) {
+        out_kv("cycles", cycles);
+    }
+    out_str(" hist=");
+    for(int i = 0; i < BENCH_HIST_BUCKETS; i++) {
+        if(i) {
+            out_str(",");
+        }
+        out_u64(hist.b[i]);
+    }
+    out_str("\n");
+}
+
+static int test_thread_create(void *entry, void *arg, int prio) {
+    thread_attr_t attr = {
+        .entry = entry, //
+        .arg = arg, //
+        .stack_size = DEFAULT_STACK, //
+        .ts = 1, //
+        .flags = 0, //
+        .type = THREAD_TYPE_JOINABLE
+    };
+    int tid = os_thread_create(&attr);
+    if(tid < 0) {
+        test_error();
+    }
+    if(os_thread_prio(tid, prio) < 0) {
+        test_error();
+    }
+    os_thread_run(tid);
+    return tid;
+}
+
+static int test_channel_open(char *pathname, int size) {
+    int chid = os_channel_open(CHANNEL_PUBLIC, pathname, size, CHANNEL_AUTO_CONNECT);
+    if(chid < 0) {
+        test_error();
+    }
+    return chid;
+}
+
+static int test_connection_open(char *pathname) {
+    int conid = os_connection_open(pathname, NO_REPLY, TIMEOUT_INFINITY);
+    if(conid < 0) {
+        test_error();
+    }
+    return conid;
+}
+
+// Ожидание приема сервером count сообщений
+static void wait_served(int count) {
+    while(served < count) {
+        os_thread_yield();
+    }
+}
+
+// Прием сообщения, при опросе - без блокировки, пустой канал (ERR_TIMEOUT) - не ошибка
+static struct msg *server_receive(int chid, int poll) {
+    struct msg *m = NULL;
+    int res;
+    while((res = os_receive(chid, &m, poll ? NO_WAIT : TIMEOUT_INFINITY)) < 0) {
+        if(!poll || (res != ERR_TIMEOUT)) {
+            test_error();
+        }
+    }
+    return m;
+}
+
+// Подтверждение процесса-получателя oneway, возвращает момент приема
+static uint32_t ack_wait(int chid) {
+    struct msg *m = server_receive(chid, 0);
+    return *(uint32_t *)m->data;
+}
+
+void thread_rtt_sync(struct bench *b) {
+    size_t len;
+    for(int i = 0; i < b->iters; i++) {
+        int rcvid;
+        while((rcvid = os_msg_receive(b->chid, srvbuf, sizeof(srvbuf), &len, b->poll ? NO_WAIT : TIMEOUT_INFINITY)) < 0) {
+            if(!b->poll || (rcvid != ERR_TIMEOUT)) {
+                test_error();
+            }
+        }
+        os_msg_reply(rcvid, OK, srvbuf, len);
+    }
+}
+
+void thread_rtt_async(struct bench *b) {
+    int conid = test_connection_open(b->reply_pathname);
+    for(int i = 0; i < b->iters; i++) {
+        struct msg *m = server_receive(b->chid, b->poll);
+        struct msg r = {
+            .sys.ptr = NULL,
+            .size = m->size,
+            .data = m->data
+        };
+        if(os_send(conid, &r, TIMEOUT_INFINITY, 0) != OK) {
+            test_error();
+        }
+    }
+    os_connection_close(conid);
+}
+
+void thread_drain(struct bench *b) {
+    for(int i = 0; i < b->iters; i++) {
+        server_receive(b->chid, b->poll);
+        served++;
+    }
+}
+
+static int server_start(void *entry, char *pathname, int bufsize, int iters, int prio, int poll) {
+    bench.reply_pathname = "ipcb_reply";
+    bench.chid = test_channel_open(pathname, bufsize);
+    bench.iters = iters;
+    bench.poll = poll;
+    served = 0;
+    hist_reset();
+    return test_thread_create(entry, &bench, prio);
+}
+
+static void server_stop(int tid, int conid) {
+    os_thread_join(tid);
+    os_connection_close(conid);
+    os_channel_close(bench.chid);
+}
+
+static void bench_oneway(size_t size, int move, int poll) {
+    // получатель вытесняет клиента при посылке, при опросе - выполняется параллельно
+    int ack_chid = test_channel_open(IPCB_ACK, DEFAULT_PAGE_SIZE);
+    struct proc_attr pattr = {
+        .prio = poll ? PRIO_DEFAULT : PRIO_DEFAULT - 1,
+        .argv = NULL,
+        .arglen = 0,
+    };
+    if(os_proc_create((struct proc_header *)PROC_SERVER, &pattr) < 0) {
+        test_error();
+    }
+    // готовность получателя, затем режим приема
+    ack_wait(ack_chid);
+    int conid = test_connection_open(IPCB_ONEWAY);
+    uint32_t mode = poll;
+    struct msg cfg = {
+        .sys.ptr = NULL,
+        .size = sizeof(mode),
+        .data = &mode
+    };
+    if(os_send(conid, &cfg, TIMEOUT_INFINITY, 0) != OK) {
+        test_error();
+    }
+    ack_wait(ack_chid);
+
+    hist_reset();
+    int pages = (size + DEFAULT_PAGE_SIZE - 1) / DEFAULT_PAGE_SIZE;
+    for(int i = 0; i < BENCH_ITERS; i++) {
+        struct msg m = {
+            .sys.ptr = NULL,
+            .size = size,
+            .data = txbuf
+        };
+        if(move) {
+            // выделение и заполнение страниц не входит в замер
+            m.data = os_malloc(pages, memattr, 0);
+            if(m.data == NULL) {
+                test_error();
+            }
+            memset(m.data, i, size);
+        }
+        uint32_t t0 = ccnt();
+        if(os_send(conid, &m, TIMEOUT_INFINITY, move ? MSG_MOVE_PAGES : 0) != OK) {
+            test_error();
+        }
+        hist_add(ack_wait(ack_chid) - t0);
+    }
+    os_connection_close(conid);
+    os_proc_kill(pattr.pid);
+    os_channel_close(ack_chid);
+    out_result("oneway", poll ? "poll" : (move ? "move" : "copy"), size, BENCH_CHANNEL_SIZE, 0);
+}
+
+static void bench_rtt_sync(size_t size, int poll) {
+    int tid = server_start(thread_rtt_sync, "ipcb", DEFAULT_PAGE_SIZE, BENCH_ITERS, PRIO_DEFAULT, poll);
+    int conid = test_connection_open("ipcb");
+    for(int i = 0; i < BENCH_ITERS; i++) {
+        uint32_t t0 = ccnt();
+        if(os_msg_send_recv(conid, txbuf, size, rxbuf, size, TIMEOUT_INFINITY) != OK) {
+            test_error();
+        }
+        hist_add(ccnt() - t0);
+    }
+    server_stop(tid, conid);
+    out_result("rtt", poll ? "poll" : "sync", size, DEFAULT_PAGE_SIZE, 0);
+}
+
+static void bench_rtt_async(size_t size) {
+    int reply_chid = test_channel_open("ipcb_reply", BENCH_CHANNEL_SIZE);
+    int tid = server_start(thread_rtt_async, "ipcb", BENCH_CHANNEL_SIZE, BENCH_ITERS, PRIO_DEFAULT, 0);
+    int conid = test_connection_open("ipcb");
+    struct msg m = {
+        .sys.ptr = NULL,
+        .size = size,
+        .data = txbuf
+    };
+    for(int i = 0; i < BENCH_ITERS; i++) {
+        struct msg *r;
+        uint32_t t0 = ccnt();
+        if(os_send(conid, &m, TIMEOUT_INFINITY, 0) != OK) {
+            test_error();
+        }
+        if(os_receive(reply_chid, &r, TIMEOUT_INFINITY) < 0) {
+            test_error();
+        }
+        hist_add(ccnt() - t0);
+    }
+    server_stop(tid, conid);
+    os_channel_close(reply_chid);
+    out_result("rtt", "async", size, BENCH_CHANNEL_SIZE, 0);
+}
+
+static void bench_tput(int bufsize) {
+    int tid = server_start(thread_drain, "ipcb", bufsize, BENCH_TPUT_ITERS, PRIO_DEFAULT, 0);
+    int conid = test_connection_open("ipcb");
+    struct msg m = {
+        .sys.ptr = NULL,
+        .size = BENCH_TPUT_SIZE,
+        .data = txbuf
+    };
+    uint32_t start = ccnt();
+    for(int i = 0; i < BENCH_TPUT_ITERS; i++) {
+        uint32_t t0 = ccnt();
+        if(os_send(conid, &m, TIMEOUT_INFINITY, 0) != OK) {
+            test_error();
+        }
+        hist_add(ccnt() - t0);
+    }
+    wait_served(BENCH_TPUT_ITERS);
+    uint32_t cycles = ccnt() - start;
+    server_stop(tid, conid);
+    out_result("tput", "copy", BENCH_TPUT_SIZE, bufsize, cycles);
+}
+
+static void bench_complete(int flags) {
+    int tid = server_start(thread_drain, "ipcb", BENCH_CHANNEL_SIZE, BENCH_ITERS, PRIO_DEFAULT, 0);
+    int conid = test_connection_open("ipcb");
+    struct msg m = {
+        .sys.ptr = NULL,
+        .size = 64,
+        .data = txbuf
+    };
+    for(int i = 0; i < BENCH_ITERS; i++) {
+        uint32_t t0 = ccnt();
+        if(os_send(conid, &m, TIMEOUT_INFINITY, flags) != OK) {
+            test_error();
+        }
+        hist_add(ccnt() - t0);
+        wait_served(i + 1);
+    }
+    server_stop(tid, conid);
+    out_result("complete", (flags & MSG_WAIT_COMPLETE) ? "wait" : "nowait", 64, BENCH_CHANNEL_SIZE, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int i;
+
+    if(os_mmap(BENCH_UART_BASE, 1, devattr) != OK) {
+        test_error();
+    }
+    out_str("IPCB begin\n");
+
+    for(i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i++) {
+        bench_oneway(bench_sizes[i], 0, 0);
+        if(bench_sizes[i] >= BENCH_MOVE_MIN) {
+            bench_oneway(bench_sizes[i], 1, 0);
+        }
+        bench_rtt_sync(bench_sizes[i], 0);
+        bench_rtt_async(bench_sizes[i]);
+#ifdef BENCH_SMP
+        bench_oneway(bench_sizes[i], 0, 1);
+        bench_rtt_sync(bench_sizes[i], 1);
+#endif
+    }
+    for(i = 0; i < sizeof(bench_bufs) / sizeof(bench_bufs[0]); i++) {
+        bench_tput(bench_bufs[i]);
+    }
+    bench_complete(0);
+    bench_complete(MSG_WAIT_COMPLETE);
+
+    out_str("IPCB end\n");
+    test_success();
+    return 0;
+}
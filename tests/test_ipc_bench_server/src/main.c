@@ -0,0 +1,78 @@
+#include <os.h>
+/**
+ * Процесс-получатель для измерения oneway в tests/test_ipc_bench
+ *
+ *  Запускается измеряющим процессом (образ должен быть загружен по адресу PROC_SERVER),
+ *  открывает канал измерения IPCB_CHANNEL и подключается к каналу подтверждений IPCB_ACK
+ *  измеряющего процесса. Первое подтверждение (0) - готовность, первое сообщение
+ *  измерения - режим приема (uint32_t, не 0 - опрос канала без блокировки).
+ *  На каждое следующее сообщение отвечает подтверждением со значением счетчика тактов
+ *  PMU (PMCCNTR) сразу после приема, перенесенные страницы освобождает.
+ *  Процесс работает до завершения измеряющим процессом (os_proc_kill).
+ *  Отдельный процесс нужен, чтобы MSG_MOVE_PAGES выполнял перенос страниц между
+ *  адресными пространствами, а не отказывался от него внутри одного процесса.
+ */
+
+#define IPCB_CHANNEL            "ipcb_oneway"
+#define IPCB_ACK                "ipcb_ack"
+#define IPCB_CHANNEL_SIZE       (65536 * 2)     // BENCH_CHANNEL_SIZE измеряющего процесса
+
+void test_error() {
+    while(1);
+}
+
+static inline uint32_t ccnt() {
+    uint32_t c;
+    asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r" (c));
+    return c;
+}
+
+static void ack(int conid, uint32_t t) {
+    struct msg r = {
+        .sys.ptr = NULL,
+        .size = sizeof(t),
+        .data = &t
+    };
+    if(os_send(conid, &r, TIMEOUT_INFINITY, 0) != OK) {
+        test_error();
+    }
+}
+
+// Прием сообщения, при опросе пустой канал (ERR_TIMEOUT) - не ошибка, повторяем
+static struct msg *server_receive(int chid, int poll) {
+    struct msg *m = NULL;
+    int res;
+    while((res = os_receive(chid, &m, poll ? NO_WAIT : TIMEOUT_INFINITY)) < 0) {
+        if(!poll || (res != ERR_TIMEOUT)) {
+            test_error();
+        }
+    }
+    return m;
+}
+
+int main(int argc, char *argv[])
+{
+    int chid = os_channel_open(CHANNEL_PUBLIC, IPCB_CHANNEL, IPCB_CHANNEL_SIZE, CHANNEL_AUTO_CONNECT);
+    if(chid < 0) {
+        test_error();
+    }
+    int conid = os_connection_open(IPCB_ACK, NO_REPLY, TIMEOUT_INFINITY);
+    if(conid < 0) {
+        test_error();
+    }
+    ack(conid, 0);
+
+    struct msg *m = server_receive(chid, 0);
+    int poll = (m->size >= sizeof(uint32_t)) && (*(uint32_t *)m->data != 0);
+    ack(conid, 0);
+
+    for(;;) {
+        m = server_receive(chid, poll);
+        uint32_t t = ccnt();
+        if(m->sys.ptr != NULL) {
+            os_mfree(m->data);
+        }
+        ack(conid, t);
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <os.h>
+#include <string.h>
+/**
+ * Тест производительности менеджера событий (хранилища таймаутов ядра)
+ *
+ *  Два потока обмениваются ходами через пару семафоров, каждое ожидание выполняется
+ *  с таймаутом и всегда блокирует поток, поэтому на каждый ход приходится одна вставка
+ *  события в хранилище и одна его отмена. Фоновые потоки периодически засыпают с разными
+ *  таймаутами и поддерживают в хранилище TEST_BG_THREAD_COUNT событий на разных
+ *  временах, что соответствует нагрузке на дерево событий в рабочей системе.
+ *
+ *  Результат - среднее время хода в нс в test_result.step_ns, сравнивается
+ *  между сборками ядра с BUILD_KEVENT_WHEEL и без него (дерево событий).
+ */
+
+
+#define TEST_BG_THREAD_COUNT     32
+#define TEST_STEP_COUNT          100000UL
+#define TEST_STEP_TIMEOUT_NS     1000000000ull   // таймаут ожидания хода, не наступает
+#define TEST_BG_SLEEP_NS         1000000ull      // шаг таймаутов фоновых потоков
+
+struct {
+    uint64_t total_ns;
+    uint64_t step_ns;
+    uint32_t steps;
+    uint32_t bg_wakeups;
+} test_result;
+
+int bg_tid_tbl[TEST_BG_THREAD_COUNT];
+int step_tid;
+int sem_ping, sem_pong;
+volatile int test_done;
+
+syn_t synobj = {
+    .type = SEMAPHORE_TYPE_PSHARED, //
+    .pathname = NULL, //
+    .limit = 1
+};
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+static uint64_t test_time() {
+    kernel_time_t t;
+    os_time(OS_CLOCK_MONOTONIC, &t, NULL);
+    return t.tv_nsec;
+}
+
+static int test_thread_create(void *entry, void *arg) {
+    thread_attr_t attr = {
+        .entry = entry, //
+        .arg = arg, //
+        .stack_size = DEFAULT_STACK, //
+        .ts = 1, //
+        .flags = 0, //
+        .type = THREAD_TYPE_JOINABLE
+    };
+    int tid = os_thread_create(&attr);
+    if(tid < 0) {
+        test_error();
+    }
+    return tid;
+}
+
+void thread_test_bg(uint32_t test_num) {
+    // разные таймауты фоновых потоков распределяют события по времени
+    while(!test_done) {
+        os_thread_sleep((test_num + 1) * TEST_BG_SLEEP_NS);
+        test_result.bg_wakeups++;
+    }
+}
+
+void thread_test_pong() {
+    for(uint32_t i = 0; i < TEST_STEP_COUNT; i++) {
+        if(os_syn_wait(sem_pong, TEST_STEP_TIMEOUT_NS) != OK) {
+            test_error();
+        }
+        os_syn_done(sem_ping);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t start;
+    int i;
+
+    memset(&test_result, 0, sizeof(test_result));
+    test_done = 0;
+    // семафоры создаются с полным счетчиком, обнуляем его для блокирующего ожидания
+    sem_ping = os_syn_create(&synobj);
+    sem_pong = os_syn_create(&synobj);
+    if((sem_ping <= 0) || (sem_pong <= 0)) {
+        test_error();
+    }
+    os_syn_wait(sem_ping, NO_WAIT);
+    os_syn_wait(sem_pong, NO_WAIT);
+
+    for(i = 0; i < TEST_BG_THREAD_COUNT; i++) {
+        bg_tid_tbl[i] = test_thread_create(thread_test_bg, (void *)i);
+        os_thread_run(bg_tid_tbl[i]);
+    }
+    step_tid = test_thread_create(thread_test_pong, NULL);
+    os_thread_run(step_tid);
+    // фоновые потоки успевают уснуть, хранилище заполнено
+    os_thread_sleep(TEST_BG_THREAD_COUNT * TEST_BG_SLEEP_NS);
+
+    start = test_time();
+    for(test_result.steps = 0; test_result.steps < TEST_STEP_COUNT; test_result.steps++) {
+        os_syn_done(sem_pong);
+        if(os_syn_wait(sem_ping, TEST_STEP_TIMEOUT_NS) != OK) {
+            test_error();
+        }
+    }
+    test_result.total_ns = test_time() - start;
+    // на каждый шаг цикла приходится два хода
+    test_result.step_ns = test_result.total_ns / (TEST_STEP_COUNT * 2);
+
+    test_done = 1;
+    os_thread_join(step_tid);
+    for(i = 0; i < TEST_BG_THREAD_COUNT; i++) {
+        os_thread_join(bg_tid_tbl[i]);
+    }
+    os_syn_delete(sem_ping, 0);
+    os_syn_delete(sem_pong, 0);
+    test_success();
+    return 0;
+}
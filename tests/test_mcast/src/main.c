@@ -0,0 +1,194 @@
+#include <os.h>
+/**
+ * Тест каналов рассылки CHANNEL_MULTICAST (os_mcast_publish, os_mcast_receive)
+ *
+ *  Подписчики - соединения процесса с собственными каналами. Сообщения одного размера
+ *  TEST_MSG_WORDS слов, первое слово - номер сообщения. Проверяется:
+ *   - канал без вытеснения: при отстающем подписчике публикация завершается по таймауту
+ *     (ERR_TIMEOUT), сообщения хранятся до приема всеми подписчиками и выдаются без потерь,
+ *     прием отстающим подписчиком освобождает место;
+ *   - канал с CHANNEL_MCAST_DROP_OLDEST: публикация не ожидает места и вытесняет старые
+ *     сообщения, прием возвращает число вытесненных, дальше сообщения выдаются по порядку;
+ *     сообщение, которое подписчик обрабатывает, не вытесняется.
+ */
+
+#define TEST_BLOCK              "mcasttest_block"
+#define TEST_DROP               "mcasttest_drop"
+#define TEST_CHANNEL_SIZE       1024
+#define TEST_MSG_WORDS          8
+#define TEST_MSG_MAX            TEST_CHANNEL_SIZE   // больше сообщений буфер вместить не может
+#define TEST_DROP_EXTRA         5                   // сообщения сверх вместимости канала
+#define TEST_WAIT_NS            10000000ull
+
+static uint32_t test_seq;
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+static int test_channel_open(char *pathname, int flags) {
+    int chid = os_channel_open(CHANNEL_PUBLIC, pathname, TEST_CHANNEL_SIZE,
+            CHANNEL_MULTICAST | CHANNEL_AUTO_CONNECT | flags);
+    if(chid < 0) {
+        test_error();
+    }
+    return chid;
+}
+
+static int test_connection_open(char *pathname) {
+    int conid = os_connection_open(pathname, NO_REPLY, TIMEOUT_INFINITY);
+    if(conid < 0) {
+        test_error();
+    }
+    return conid;
+}
+
+// Публикация следующего сообщения, результат os_mcast_publish
+static int publish(int chid, uint64_t timeout) {
+    uint32_t data[TEST_MSG_WORDS] = { test_seq };
+    struct msg m = {
+        .sys.ptr = NULL,
+        .size = sizeof(data),
+        .data = data
+    };
+    int res = os_mcast_publish(chid, &m, timeout);
+    if(res == OK) {
+        test_seq++;
+    }
+    return res;
+}
+
+// Прием сообщения seq, возвращает число вытесненных перед ним
+static int receive(int conid, uint32_t seq) {
+    struct msg *m = NULL;
+    int lost = os_mcast_receive(conid, &m, NO_WAIT);
+    if((lost < 0) || (m == NULL) || (m->size != TEST_MSG_WORDS * sizeof(uint32_t))
+            || (*(uint32_t *)m->data != seq)) {
+        test_error();
+    }
+    return lost;
+}
+
+static void receive_none(int conid) {
+    struct msg *m = NULL;
+    if(os_mcast_receive(conid, &m, NO_WAIT) != ERR_TIMEOUT) {
+        test_error();
+    }
+}
+
+static void test_block() {
+    int chid = test_channel_open(TEST_BLOCK, 0);
+    int fast = test_connection_open(TEST_BLOCK);
+    int slow = test_connection_open(TEST_BLOCK);
+    uint32_t n;
+
+    // быстрый подписчик принимает сразу, отстающий не принимает: буфер заполняется
+    test_seq = 0;
+    while(publish(chid, NO_WAIT) == OK) {
+        receive(fast, test_seq - 1);
+        if(test_seq > TEST_MSG_MAX) {
+            test_error();
+        }
+    }
+    n = test_seq;
+    if(n < 2) {
+        test_error();
+    }
+    if(publish(chid, TEST_WAIT_NS) != ERR_TIMEOUT) {
+        test_error();
+    }
+
+    // сообщения хранятся для отстающего подписчика без потерь
+    if((receive(slow, 0) != 0) || (receive(slow, 1) != 0)) {
+        test_error();
+    }
+    // сообщение 0 освобождено обоими подписчиками, место для одного сообщения
+    if(publish(chid, NO_WAIT) != OK) {
+        test_error();
+    }
+    if(publish(chid, NO_WAIT) != ERR_TIMEOUT) {
+        test_error();
+    }
+    receive(fast, n);
+    for(uint32_t seq = 2; seq <= n; seq++) {
+        if(receive(slow, seq) != 0) {
+            test_error();
+        }
+    }
+    receive_none(fast);
+    receive_none(slow);
+
+    os_connection_close(fast);
+    os_connection_close(slow);
+    if(os_channel_close(chid) != OK) {
+        test_error();
+    }
+}
+
+// Публикация до заполнения буфера, когда вытеснять нечего
+static void publish_full(int chid) {
+    for(int i = 0; publish(chid, NO_WAIT) == OK; i++) {
+        if(i == TEST_MSG_MAX) {
+            test_error();
+        }
+    }
+}
+
+// Прием после вытеснения, seq - курсор подписчика: первое хранимое сообщение
+// следует за вытесненными, возвращается его номер
+static uint32_t receive_dropped(int conid, uint32_t seq) {
+    struct msg *m = NULL;
+    int lost = os_mcast_receive(conid, &m, NO_WAIT);
+    if((lost < TEST_DROP_EXTRA) || (m == NULL) || (*(uint32_t *)m->data != seq + lost)) {
+        test_error();
+    }
+    return seq + lost;
+}
+
+static void drop_round(int chid, int sub) {
+    uint32_t seq = test_seq;
+
+    // публикация не ожидает места: старые сообщения вытесняются
+    for(int i = 0; i < TEST_MSG_MAX + TEST_DROP_EXTRA; i++) {
+        if(publish(chid, NO_WAIT) != OK) {
+            test_error();
+        }
+    }
+    seq = receive_dropped(sub, seq);
+    // принятое сообщение обрабатывается подписчиком и не вытесняется,
+    // публикация занимает только свободное место
+    publish_full(chid);
+    while(++seq < test_seq) {
+        if(receive(sub, seq) != 0) {
+            test_error();
+        }
+    }
+    receive_none(sub);
+}
+
+static void test_drop() {
+    int chid = test_channel_open(TEST_DROP, CHANNEL_MCAST_DROP_OLDEST);
+    int sub = test_connection_open(TEST_DROP);
+
+    test_seq = 0;
+    // второй проход: число вытесненных считается от курсора подписчика
+    drop_round(chid, sub);
+    drop_round(chid, sub);
+
+    os_connection_close(sub);
+    if(os_channel_close(chid) != OK) {
+        test_error();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    test_block();
+    test_drop();
+    test_success();
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <os.h>
+/**
+ * Тест порядка выдачи сообщений канала
+ *
+ *  Основной поток отправляет с низким приоритетом TEST_PRIO_LOW, поток-отправитель
+ *  создается для каждой посылки с высоким приоритетом TEST_PRIO_HIGH (другой уровень
+ *  MSG_PRIO_LANES ядра). Проверяется:
+ *   - канал без CHANNEL_PRIO_LANES выдает сообщения в порядке поступления
+ *     независимо от приоритета отправителей;
+ *   - канал с CHANNEL_PRIO_LANES выдает сообщение высокоприоритетного отправителя раньше;
+ *   - основной поток, принявший сообщение из канала с CHANNEL_PRIO_INHERIT, выполняется
+ *     с унаследованным высоким приоритетом, но его сообщения в канал с CHANNEL_PRIO_LANES
+ *     остаются на уровне собственного приоритета и не обгоняют посланные им ранее.
+ */
+
+#define TEST_FIFO               "msgprio_fifo"
+#define TEST_LANES              "msgprio_lanes"
+#define TEST_INHERIT            "msgprio_inherit"
+#define TEST_CHANNEL_SIZE       4096
+
+#define TEST_PRIO_LOW           (PRIO_MAX + 40)     // уровень 2
+#define TEST_PRIO_HIGH          (PRIO_MAX + 2)      // уровень 0
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+static int test_channel_open(char *pathname, int flags) {
+    int chid = os_channel_open(CHANNEL_PUBLIC, pathname, TEST_CHANNEL_SIZE, CHANNEL_AUTO_CONNECT | flags);
+    if(chid < 0) {
+        test_error();
+    }
+    return chid;
+}
+
+static int test_connection_open(char *pathname) {
+    int conid = os_connection_open(pathname, NO_REPLY, TIMEOUT_INFINITY);
+    if(conid < 0) {
+        test_error();
+    }
+    return conid;
+}
+
+static void test_send(int conid, uint32_t value) {
+    struct msg m = {
+        .sys.ptr = NULL,
+        .size = sizeof(value),
+        .data = &value
+    };
+    if(os_send(conid, &m, NO_WAIT, 0) != OK) {
+        test_error();
+    }
+}
+
+static void test_receive(int chid, uint32_t value) {
+    struct msg *m = NULL;
+    if(os_receive(chid, &m, NO_WAIT) != OK) {
+        test_error();
+    }
+    if((m->size != sizeof(value)) || (*(uint32_t *)m->data != value)) {
+        test_error();
+    }
+}
+
+// параметры посылки потоком с высоким приоритетом
+struct high_send {
+    int conid;
+    uint32_t value;
+};
+
+void thread_high_send(struct high_send *hs) {
+    test_send(hs->conid, hs->value);
+}
+
+// Посылка от потока с высоким приоритетом, возврат после ее завершения
+static void high_send(int conid, uint32_t value) {
+    struct high_send hs = { .conid = conid, .value = value };
+    thread_attr_t attr = {
+        .entry = thread_high_send, //
+        .arg = &hs, //
+        .stack_size = DEFAULT_STACK, //
+        .ts = 1, //
+        .flags = 0, //
+        .type = THREAD_TYPE_JOINABLE
+    };
+    int tid = os_thread_create(&attr);
+    if(tid < 0) {
+        test_error();
+    }
+    if(os_thread_prio(tid, TEST_PRIO_HIGH) < 0) {
+        test_error();
+    }
+    os_thread_run(tid);
+    os_thread_join(tid);
+}
+
+int main(int argc, char *argv[])
+{
+    if(os_thread_prio(0, TEST_PRIO_LOW) < 0) {
+        test_error();
+    }
+    int fifo = test_channel_open(TEST_FIFO, 0);
+    int lanes = test_channel_open(TEST_LANES, CHANNEL_PRIO_LANES);
+    int inherit = test_channel_open(TEST_INHERIT, CHANNEL_PRIO_INHERIT);
+    int fifo_con = test_connection_open(TEST_FIFO);
+    int lanes_con = test_connection_open(TEST_LANES);
+    int inherit_con = test_connection_open(TEST_INHERIT);
+
+    // без CHANNEL_PRIO_LANES - в порядке поступления
+    test_send(fifo_con, 1);
+    high_send(fifo_con, 2);
+    test_receive(fifo, 1);
+    test_receive(fifo, 2);
+
+    // с CHANNEL_PRIO_LANES высокоприоритетный отправитель обгоняет
+    test_send(lanes_con, 1);
+    high_send(lanes_con, 2);
+    test_receive(lanes, 2);
+    test_receive(lanes, 1);
+
+    // посылки до и во время наследования приоритета остаются на одном уровне
+    test_send(lanes_con, 1);
+    high_send(inherit_con, 0);
+    test_receive(inherit, 0);       // наследование TEST_PRIO_HIGH до следующего приема
+    test_send(lanes_con, 2);
+    high_send(lanes_con, 3);
+    test_receive(lanes, 3);
+    test_receive(lanes, 1);
+    test_receive(lanes, 2);
+
+    os_connection_close(fifo_con);
+    os_connection_close(lanes_con);
+    os_connection_close(inherit_con);
+    os_channel_close(fifo);
+    os_channel_close(lanes);
+    os_channel_close(inherit);
+    test_success();
+    return 0;
+}
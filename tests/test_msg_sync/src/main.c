@@ -0,0 +1,105 @@
+#include <os.h>
+#include <string.h>
+/**
+ * Тест синхронного обмена между процессами (os_msg_send_recv, os_msg_receive, os_msg_reply)
+ *
+ *  Получатель - отдельный процесс tests/test_msg_sync_server (образ должен быть загружен
+ *  по адресу PROC_SERVER) с более высоким приоритетом, поэтому буферы запроса и ответа
+ *  находятся в разных адресных пространствах. Проверяется передача данных в обе стороны:
+ *   - запрос ожидающему получателю (отправитель выжидает, пока получатель заблокируется);
+ *   - запрос, ожидающий в очереди канала (получатель засыпает после предыдущего ответа);
+ *   - усечение запроса по буферу получателя и ответа по буферу отправителя;
+ *   - пустой запрос.
+ *  Ответ содержит данные запроса с увеличенными на 1 байтами, статус - принятый размер.
+ */
+
+#define PROC_SERVER             0x10630000
+#define SYNC_CHANNEL            "msgsync"
+#define SYNC_REQ_SIZE           256             // буфер получателя
+#define SYNC_DELAY_NS           10000000ull     // задержка получателя перед следующим приемом
+
+static uint8_t sbuf[SYNC_REQ_SIZE + 64];
+static uint8_t rbuf[SYNC_REQ_SIZE + 64];
+static int conid;
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+/* Запрос размером slen с ответом в буфер rlen байт, delay - получатель засыпает после ответа,
+ wait - получатель успевает заблокироваться в ожидании запроса */
+static void exchange(size_t slen, size_t rlen, uint32_t delay, int wait, uint8_t seed) {
+    for(size_t i = 0; i < sizeof(sbuf); i++) {
+        sbuf[i] = (uint8_t)(seed + i);
+    }
+    if(slen >= sizeof(delay)) {
+        memcpy(sbuf, &delay, sizeof(delay));
+    }
+    memset(rbuf, 0xEE, sizeof(rbuf));
+    if(wait) {
+        os_thread_sleep(SYNC_DELAY_NS);
+    }
+
+    int status = os_msg_send_recv(conid, sbuf, slen, rbuf, rlen, TIMEOUT_INFINITY);
+    size_t len = (slen < SYNC_REQ_SIZE) ? slen : SYNC_REQ_SIZE;
+    if(status != (int)len) {
+        test_error();
+    }
+    size_t n = (len < rlen) ? len : rlen;
+    for(size_t i = 0; i < n; i++) {
+        if(rbuf[i] != (uint8_t)(sbuf[i] + 1)) {
+            test_error();
+        }
+    }
+    // ответ не выходит за буфер ответа
+    for(size_t i = n; i < sizeof(rbuf); i++) {
+        if(rbuf[i] != 0xEE) {
+            test_error();
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    struct proc_attr pattr = {
+        .prio = PRIO_DEFAULT - 1,
+        .argv = NULL,
+        .arglen = 0,
+    };
+    if(os_proc_create((struct proc_header *)PROC_SERVER, &pattr) < 0) {
+        test_error();
+    }
+    conid = os_connection_open(SYNC_CHANNEL, NO_REPLY, TIMEOUT_INFINITY);
+    if(conid < 0) {
+        test_error();
+    }
+
+    // получатель ожидает запрос
+    exchange(16, SYNC_REQ_SIZE, 0, 1, 1);
+    exchange(SYNC_REQ_SIZE, SYNC_REQ_SIZE, 0, 1, 2);
+
+    // запрос ожидает получателя в очереди канала
+    exchange(64, SYNC_REQ_SIZE, 1, 1, 3);
+    exchange(128, SYNC_REQ_SIZE, 1, 0, 4);
+    exchange(32, SYNC_REQ_SIZE, 0, 0, 5);
+
+    // усечение запроса и ответа
+    exchange(SYNC_REQ_SIZE + 64, SYNC_REQ_SIZE + 64, 0, 1, 6);
+    exchange(SYNC_REQ_SIZE, 8, 0, 1, 7);
+    exchange(SYNC_REQ_SIZE, 0, 0, 1, 8);
+
+    // пустой запрос
+    exchange(0, SYNC_REQ_SIZE, 0, 1, 9);
+    exchange(0, SYNC_REQ_SIZE, 0, 0, 10);
+
+    os_connection_close(conid);
+    if(os_proc_kill(pattr.pid) < 0) {
+        test_error();
+    }
+    test_success();
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <os.h>
+/**
+ * Процесс-получатель синхронных запросов для tests/test_msg_sync
+ *
+ *  Запускается тестирующим процессом (образ должен быть загружен по адресу PROC_SERVER),
+ *  открывает канал SYNC_CHANNEL и принимает запросы os_msg_receive в буфер SYNC_REQ_SIZE байт.
+ *  На каждый запрос отвечает данными запроса, каждый байт которых увеличен на 1,
+ *  со статусом, равным размеру принятых данных. Если первое слово запроса не 0,
+ *  после ответа засыпает на SYNC_DELAY_NS, и следующий запрос ожидает в очереди канала.
+ *  Процесс работает до завершения тестирующим процессом (os_proc_kill).
+ */
+
+#define SYNC_CHANNEL            "msgsync"
+#define SYNC_REQ_SIZE           256
+#define SYNC_DELAY_NS           10000000ull
+
+void test_error() {
+    while(1);
+}
+
+static uint8_t req[SYNC_REQ_SIZE];
+static uint8_t reply[SYNC_REQ_SIZE];
+
+int main(int argc, char *argv[])
+{
+    int chid = os_channel_open(CHANNEL_PUBLIC, SYNC_CHANNEL, 4096, CHANNEL_AUTO_CONNECT);
+    if(chid < 0) {
+        test_error();
+    }
+    for(;;) {
+        size_t len = SYNC_REQ_SIZE + 1;
+        int rcvid = os_msg_receive(chid, req, sizeof(req), &len, TIMEOUT_INFINITY);
+        if((rcvid <= 0) || (len > sizeof(req))) {
+            test_error();
+        }
+        for(size_t i = 0; i < len; i++) {
+            reply[i] = req[i] + 1;
+        }
+        if(os_msg_reply(rcvid, (int)len, reply, len) != OK) {
+            test_error();
+        }
+        if((len >= sizeof(uint32_t)) && (*(uint32_t *)req != 0)) {
+            os_thread_sleep(SYNC_DELAY_NS);
+        }
+    }
+    return 0;
+}
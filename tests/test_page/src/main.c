@@ -0,0 +1,254 @@
+#include <os.h>
+/**
+ * Тест аллокатора страниц (парного аллокатора ядра) через системные вызовы памяти
+ *
+ *  Число свободных страниц динамической памяти читается по os_get_info(OS_INFO_MEM)
+ *  (allocated.free). Проверяется:
+ *   - выравнивание участков os_malloc по наибольшей записи MMU (большая страница 64K
+ *     для 16 страниц и больше, секция 1M для целых секций) и точный расход страниц
+ *     для размеров, не равных степени двойки;
+ *   - объединение освобожденных блоков: после освобождения в любом порядке число
+ *     свободных страниц возвращается к исходному, участок в секцию выделяется снова;
+ *   - захват по фиксированному адресу (os_mmap) в динамической памяти;
+ *   - совместный захват участка двумя процессами (MEM_MULTU_ALLOC_ON): второй владелец -
+ *     процесс tests/test_page_share (образ должен быть загружен по адресу PROC_SHARE),
+ *     участок освобождается только последним владельцем.
+ *  Первый проход наполняет кучу ядра (записи сегментов, таблицы страниц), счетчик
+ *  свободных страниц проверяется на втором проходе.
+ */
+
+#define PROC_SHARE              0x10650000
+
+#define TEST_MARK               0x5A5A0001
+#define TEST_MARK_SHARE         0x5A5A0002
+#define TEST_SINGLES            64
+#define TEST_SETTLE_TRIES       100
+#define TEST_SETTLE_NS          1000000ull
+#define TEST_LPAGE_PAGES        16              // большая страница 64K
+#define TEST_DIR_PAGES          256             // секция 1M
+
+struct share_arg {
+    size_t adr;
+    size_t pages;
+};
+
+static const mem_attributes_t test_attr = {
+    .shared = MEM_SHARED_OFF,
+    .exec = MEM_EXEC_NEVER,
+    .type = MEM_TYPE_NORMAL,
+    .inner_cached = MEM_CACHED_WRITE_BACK,
+    .outer_cached = MEM_CACHED_WRITE_BACK,
+    .process_access = MEM_ACCESS_RW,
+    .os_access = MEM_ACCESS_RW,
+    .security = MEM_SECURITY_OFF
+};
+
+static const mem_attributes_t share_attr = {
+    .shared = MEM_SHARED_OFF,
+    .exec = MEM_EXEC_NEVER,
+    .type = MEM_TYPE_NORMAL,
+    .inner_cached = MEM_CACHED_WRITE_BACK,
+    .outer_cached = MEM_CACHED_WRITE_BACK,
+    .process_access = MEM_ACCESS_RW,
+    .os_access = MEM_ACCESS_RW,
+    .security = MEM_SECURITY_OFF,
+    .multu_alloc = MEM_MULTU_ALLOC_ON
+};
+
+static size_t page_size;
+static int check;                       // проверка счетчика свободных страниц
+static uint32_t *singles[TEST_SINGLES];
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+static size_t dynamic_free() {
+    union os_info info;
+    if(os_get_info(OS_INFO_MEM, &info) != OK) {
+        test_error();
+    }
+    page_size = info.mem.page_size;
+    return info.mem.allocated.free / info.mem.page_size;
+}
+
+static void expect_free(size_t pages) {
+    if(check && (dynamic_free() != pages)) {
+        test_error();
+    }
+}
+
+// Ожидание освобождения памяти завершенного процесса
+static void settle_free(size_t pages) {
+    for(int i = 0; i < TEST_SETTLE_TRIES; i++) {
+        if(dynamic_free() == pages) {
+            return;
+        }
+        os_thread_sleep(TEST_SETTLE_NS);
+    }
+    if(check) {
+        test_error();
+    }
+}
+
+// Запись и проверка первого слова каждой страницы участка
+static void fill(uint32_t *p, size_t pages) {
+    for(size_t i = 0; i < pages; i++) {
+        volatile uint32_t *w = (volatile uint32_t *)((size_t)p + i * page_size);
+        *w = (uint32_t)w;
+        if(*w != (uint32_t)w) {
+            test_error();
+        }
+    }
+}
+
+static uint32_t *test_alloc(size_t pages) {
+    uint32_t *p = os_malloc(pages, test_attr, 0);
+    if(p == NULL) {
+        test_error();
+    }
+    fill(p, pages);
+    return p;
+}
+
+static void test_free(void *p) {
+    if(os_mfree(p) != OK) {
+        test_error();
+    }
+}
+
+// Выравнивание участка ядром: по наибольшей записи MMU, которой он может быть отображен
+static size_t seg_align(size_t pages) {
+    if((pages >= TEST_DIR_PAGES) && !(pages % TEST_DIR_PAGES)) {
+        return TEST_DIR_PAGES * page_size;
+    }
+    if(pages >= TEST_LPAGE_PAGES) {
+        return TEST_LPAGE_PAGES * page_size;
+    }
+    return page_size;
+}
+
+static void test_align() {
+    static const size_t sizes[] = { 1, 3, 16, 17, 100, 256 };
+    uint32_t *p[sizeof(sizes) / sizeof(sizes[0])];
+    size_t free0 = dynamic_free();
+    size_t used = 0;
+
+    for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        p[i] = test_alloc(sizes[i]);
+        if((size_t)p[i] % seg_align(sizes[i])) {
+            test_error();
+        }
+        // остаток блока степени двойки сразу возвращается в свободные
+        used += sizes[i];
+        expect_free(free0 - used);
+    }
+    for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        test_free(p[i]);
+    }
+    expect_free(free0);
+}
+
+static void test_coalesce() {
+    size_t free0 = dynamic_free();
+
+    for(int i = 0; i < TEST_SINGLES; i++) {
+        singles[i] = test_alloc(1);
+    }
+    expect_free(free0 - TEST_SINGLES);
+    // сначала через одну, чтобы соседние блоки объединялись при освобождении второй половины
+    for(int i = 0; i < TEST_SINGLES; i += 2) {
+        test_free(singles[i]);
+    }
+    for(int i = TEST_SINGLES - 1; i > 0; i -= 2) {
+        test_free(singles[i]);
+    }
+    expect_free(free0);
+
+    uint32_t *dir = test_alloc(TEST_DIR_PAGES);
+    if((size_t)dir % (TEST_DIR_PAGES * page_size)) {
+        test_error();
+    }
+    test_free(dir);
+    expect_free(free0);
+}
+
+static void test_fixed() {
+    size_t free0 = dynamic_free();
+
+    uint32_t *a = test_alloc(TEST_LPAGE_PAGES);
+    test_free(a);
+    expect_free(free0);
+    if(os_mmap((size_t)a, TEST_LPAGE_PAGES, test_attr) != OK) {
+        test_error();
+    }
+    fill(a, TEST_LPAGE_PAGES);
+    expect_free(free0 - TEST_LPAGE_PAGES);
+
+    // захваченный участок не выдается повторно
+    uint32_t *b = test_alloc(TEST_LPAGE_PAGES);
+    size_t size = TEST_LPAGE_PAGES * page_size;
+    if(((size_t)b < (size_t)a + size) && ((size_t)a < (size_t)b + size)) {
+        test_error();
+    }
+    expect_free(free0 - 2 * TEST_LPAGE_PAGES);
+    test_free(b);
+    test_free(a);
+    expect_free(free0);
+}
+
+static void test_share() {
+    size_t free0 = dynamic_free();
+
+    uint32_t *a = test_alloc(4);
+    test_free(a);
+    if(os_mmap((size_t)a, 4, share_attr) != OK) {
+        test_error();
+    }
+    volatile uint32_t *p = (volatile uint32_t *)a;
+    p[0] = TEST_MARK;
+    p[1] = 0;
+
+    struct share_arg arg = { .adr = (size_t)a, .pages = 4 };
+    struct proc_attr pattr = {
+        .prio = PRIO_DEFAULT - 1,
+        .argtype = PROC_ARGTYPE_BYTE_ARRAY,
+        .argv = &arg,
+        .arglen = sizeof(arg),
+    };
+    if(os_proc_create((struct proc_header *)PROC_SHARE, &pattr) < 0) {
+        test_error();
+    }
+    for(int i = 0; p[1] != TEST_MARK_SHARE; i++) {
+        if(i == TEST_SETTLE_TRIES) {
+            test_error();
+        }
+        os_thread_sleep(TEST_SETTLE_NS);
+    }
+    if(os_proc_kill(pattr.pid) < 0) {
+        test_error();
+    }
+    // после завершения второго владельца участок остается выделенным
+    settle_free(free0 - 4);
+    if(p[0] != TEST_MARK) {
+        test_error();
+    }
+    test_free(a);
+    expect_free(free0);
+}
+
+int main(int argc, char *argv[])
+{
+    for(check = 0; check < 2; check++) {
+        test_align();
+        test_coalesce();
+        test_fixed();
+        test_share();
+    }
+    test_success();
+    return 0;
+}
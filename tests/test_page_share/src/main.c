@@ -0,0 +1,55 @@
+#include <os.h>
+/**
+ * Второй владелец участка страничной памяти для tests/test_page
+ *
+ *  Запускается тестирующим процессом (образ должен быть загружен по адресу PROC_SHARE),
+ *  аргумент - адрес и число страниц участка (struct share_arg, PROC_ARGTYPE_BYTE_ARRAY).
+ *  Захватывает участок по тому же адресу с MEM_MULTU_ALLOC_ON, проверяет метку
+ *  тестирующего процесса в первом слове и записывает ответную метку во второе.
+ *  Процесс работает до завершения тестирующим процессом (os_proc_kill).
+ */
+
+#define TEST_MARK               0x5A5A0001
+#define TEST_MARK_SHARE         0x5A5A0002
+#define TEST_SLEEP_NS           1000000000ull
+
+struct share_arg {
+    size_t adr;
+    size_t pages;
+};
+
+static const mem_attributes_t share_attr = {
+    .shared = MEM_SHARED_OFF,
+    .exec = MEM_EXEC_NEVER,
+    .type = MEM_TYPE_NORMAL,
+    .inner_cached = MEM_CACHED_WRITE_BACK,
+    .outer_cached = MEM_CACHED_WRITE_BACK,
+    .process_access = MEM_ACCESS_RW,
+    .os_access = MEM_ACCESS_RW,
+    .security = MEM_SECURITY_OFF,
+    .multu_alloc = MEM_MULTU_ALLOC_ON
+};
+
+void test_error() {
+    while(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const struct share_arg *arg = (const struct share_arg *)argv;
+    if((arg == NULL) || (argc != sizeof(*arg))) {
+        test_error();
+    }
+    if(os_mmap(arg->adr, arg->pages, share_attr) != OK) {
+        test_error();
+    }
+    volatile uint32_t *p = (volatile uint32_t *)arg->adr;
+    if(p[0] != TEST_MARK) {
+        test_error();
+    }
+    p[1] = TEST_MARK_SHARE;
+    for(;;) {
+        os_thread_sleep(TEST_SLEEP_NS);
+    }
+    return 0;
+}
@@ -0,0 +1,281 @@
+#include <os.h>
+/**
+ * Тест портов ожидания (os_port_create, os_port_ctl, os_port_wait)
+ *
+ *  Источники - собственные каналы процесса, разделяемый семафор и прерывание таймера EPIT2,
+ *  который не используется ядром. Импульсы в каналы отправляются через соединения процесса
+ *  с собственными каналами. Проверяется:
+ *   - источник по уровню выдается при каждом ожидании, пока он готов, по фронту (PORT_EDGE) -
+ *     только после новых событий, число событий источника в count;
+ *   - повторное добавление источника (ERR_BUSY);
+ *   - закрытие канала и удаление семафора выдаются однократно с PORT_HUP и данными пользователя;
+ *   - прерывание будит поток порта и запрещается ядром: следующее срабатывание таймера не выдается
+ *     до разрешения линии os_irq_ctrl, после разрешения выдается ожидавшее событие.
+ */
+
+#define TEST_LEVEL              "porttest_level"
+#define TEST_EDGE               "porttest_edge"
+#define TEST_CHANNEL_SIZE       1024
+#define TEST_EVENTS             4
+#define TEST_WAIT_NS            100000000ull
+#define TEST_IRQ_QUIET_NS       10000000ull
+
+// таймер EPIT2, счетчик обратного счета с частотой 32768 Гц
+#define EPIT2_BASE              0x20D4000u
+#define EPIT2_IRQ_ID            89
+#define EPIT_CR_EN              0x01
+#define EPIT_CR_OCIEN           0x04
+#define EPIT_CR_SWR             0x10000
+#define EPIT_CR_INIT            0x3280002       // ENMOD, WAITEN, STOPEN, низкочастотный источник
+#define EPIT_SR_OCIF            0x01
+#define TEST_IRQ_TICKS          33              // около 1 мс
+
+typedef struct {
+    volatile uint32_t CR;
+    volatile uint32_t SR;
+    volatile uint32_t LR;
+    volatile uint32_t CMPR;
+    volatile uint32_t CNR;
+} epit_t;
+
+#define EPIT2                   ((epit_t *)EPIT2_BASE)
+
+static const mem_attributes_t devattr = {
+    .shared = MEM_SHARED_OFF,
+    .exec = MEM_EXEC_NEVER,
+    .type = MEM_TYPE_DEVICE,
+    .inner_cached = MEM_CACHED_OFF,
+    .outer_cached = MEM_CACHED_OFF,
+    .process_access = MEM_ACCESS_RW,
+    .os_access = MEM_ACCESS_RW,
+    .security = MEM_SECURITY_OFF
+};
+
+static syn_t synobj = {
+    .type = SEMAPHORE_TYPE_PSHARED,
+    .pathname = NULL,
+    .limit = 1
+};
+
+static int port;
+static port_event_t ev[TEST_EVENTS];
+// данные пользователя источников
+static int data_level, data_edge, data_sem, data_irq;
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+static void src_add(port_src_type_t type, int id, uint32_t flags, void *data) {
+    port_event_t src = {
+        .type = type,
+        .id = id,
+        .flags = flags,
+        .data = data,
+    };
+    if(os_port_ctl(port, PORT_ADD, &src) != OK) {
+        test_error();
+    }
+}
+
+static void src_del(port_src_type_t type, int id) {
+    port_event_t src = {
+        .type = type,
+        .id = id,
+    };
+    if(os_port_ctl(port, PORT_DEL, &src) != OK) {
+        test_error();
+    }
+}
+
+// Ожидание ровно cnt событий порта
+static void expect_events(int cnt, uint64_t timeout) {
+    int res = os_port_wait(port, ev, TEST_EVENTS, timeout);
+    if(cnt == 0) {
+        if(res != ERR_TIMEOUT) {
+            test_error();
+        }
+    } else if(res != cnt) {
+        test_error();
+    }
+}
+
+// Проверка выданного события источника, порядок событий в массиве не задан
+static void expect_event(int cnt, void *data, uint32_t flags, uint32_t count) {
+    for(int i = 0; i < cnt; i++) {
+        if(ev[i].data == data) {
+            if((ev[i].flags != flags) || (ev[i].count != count)) {
+                test_error();
+            }
+            return;
+        }
+    }
+    test_error();
+}
+
+static void pulse_take(int chid, int code) {
+    pulse_t p;
+    if((os_pulse_receive(chid, &p, NO_WAIT) != OK) || (p.code != code)) {
+        test_error();
+    }
+}
+
+static void test_level_edge() {
+    int level = os_channel_open(CHANNEL_PUBLIC, TEST_LEVEL, TEST_CHANNEL_SIZE, CHANNEL_AUTO_CONNECT);
+    int edge = os_channel_open(CHANNEL_PUBLIC, TEST_EDGE, TEST_CHANNEL_SIZE, CHANNEL_AUTO_CONNECT);
+    if((level < 0) || (edge < 0)) {
+        test_error();
+    }
+    int con_level = os_connection_open(TEST_LEVEL, NO_REPLY, TIMEOUT_INFINITY);
+    int con_edge = os_connection_open(TEST_EDGE, NO_REPLY, TIMEOUT_INFINITY);
+    if((con_level < 0) || (con_edge < 0)) {
+        test_error();
+    }
+    int sem = os_syn_create(&synobj);
+    if(sem <= 0) {
+        test_error();
+    }
+    os_syn_wait(sem, NO_WAIT);
+
+    src_add(PORT_SRC_CHANNEL, level, 0, &data_level);
+    src_add(PORT_SRC_CHANNEL, edge, PORT_EDGE, &data_edge);
+    src_add(PORT_SRC_SYN, sem, 0, &data_sem);
+    port_event_t dup = { .type = PORT_SRC_CHANNEL, .id = level };
+    if(os_port_ctl(port, PORT_ADD, &dup) != ERR_BUSY) {
+        test_error();
+    }
+    expect_events(0, NO_WAIT);
+
+    // каналы: импульс в каждый канал
+    if((os_pulse(con_level, 1, 0) != OK) || (os_pulse(con_edge, 1, 0) != OK)) {
+        test_error();
+    }
+    expect_events(2, TEST_WAIT_NS);
+    expect_event(2, &data_level, PORT_IN, 1);
+    expect_event(2, &data_edge, PORT_IN, 1);
+    // импульсы не приняты: канал по уровню готов, по фронту новых событий нет
+    expect_events(1, NO_WAIT);
+    expect_event(1, &data_level, PORT_IN, 0);
+    if(os_pulse(con_edge, 2, 0) != OK) {
+        test_error();
+    }
+    expect_events(2, NO_WAIT);
+    expect_event(2, &data_level, PORT_IN, 0);
+    expect_event(2, &data_edge, PORT_IN, 1);
+    pulse_take(level, 1);
+    pulse_take(edge, 1);
+    pulse_take(edge, 2);
+    expect_events(0, NO_WAIT);
+
+    // семафор по уровню: готов, пока счетчик больше 0
+    if(os_syn_done(sem) != OK) {
+        test_error();
+    }
+    expect_events(1, TEST_WAIT_NS);
+    expect_event(1, &data_sem, PORT_IN, 1);
+    expect_events(1, NO_WAIT);
+    expect_event(1, &data_sem, PORT_IN, 0);
+    if(os_syn_wait(sem, NO_WAIT) != OK) {
+        test_error();
+    }
+    expect_events(0, NO_WAIT);
+
+    // закрытие источников: однократно PORT_HUP, связи остаются в порту до удаления
+    if(os_syn_delete(sem, 0) != OK) {
+        test_error();
+    }
+    expect_events(1, TEST_WAIT_NS);
+    expect_event(1, &data_sem, PORT_HUP, 0);
+    expect_events(0, NO_WAIT);
+    src_del(PORT_SRC_SYN, sem);
+
+    os_connection_close(con_level);
+    os_connection_close(con_edge);
+    if((os_channel_close(level) != OK) || (os_channel_close(edge) != OK)) {
+        test_error();
+    }
+    expect_events(2, TEST_WAIT_NS);
+    expect_event(2, &data_level, PORT_HUP, 0);
+    expect_event(2, &data_edge, PORT_HUP, 0);
+    expect_events(0, NO_WAIT);
+    src_del(PORT_SRC_CHANNEL, level);
+    src_del(PORT_SRC_CHANNEL, edge);
+}
+
+static void irq_enable() {
+    irq_ctrl_t ctrl = {
+        .assert_type = IRQ_ASSERT_DEFAULT,
+        .enable = 1
+    };
+    if(os_irq_ctrl(EPIT2_IRQ_ID, ctrl) != OK) {
+        test_error();
+    }
+}
+
+// Следующее срабатывание таймера через TEST_IRQ_TICKS
+static void irq_next() {
+    EPIT2->SR = EPIT_SR_OCIF;
+    EPIT2->CMPR = EPIT2->CNR - TEST_IRQ_TICKS;
+}
+
+static void test_irq() {
+    if(os_mmap(EPIT2_BASE, 4, devattr) != OK) {
+        test_error();
+    }
+    EPIT2->CR = 0;
+    EPIT2->CR = EPIT_CR_SWR;
+    while(EPIT2->CR & EPIT_CR_SWR);
+    EPIT2->CR = EPIT_CR_INIT;
+    EPIT2->SR = EPIT_SR_OCIF;
+    EPIT2->CMPR = 0xffffffff - TEST_IRQ_TICKS;
+
+    src_add(PORT_SRC_IRQ, EPIT2_IRQ_ID, 0, &data_irq);
+    irq_enable();
+    EPIT2->CR |= EPIT_CR_EN | EPIT_CR_OCIEN;
+
+    // поток блокируется в порту и будится прерыванием
+    expect_events(1, TEST_WAIT_NS);
+    expect_event(1, &data_irq, PORT_IN, 1);
+    if((ev[0].type != PORT_SRC_IRQ) || (ev[0].id != EPIT2_IRQ_ID)) {
+        test_error();
+    }
+
+    // линия запрещена ядром: срабатывание таймера не выдается до разрешения
+    irq_next();
+    expect_events(0, TEST_IRQ_QUIET_NS);
+    if(!(EPIT2->SR & EPIT_SR_OCIF)) {
+        test_error();
+    }
+    irq_enable();
+    expect_events(1, TEST_WAIT_NS);
+    expect_event(1, &data_irq, PORT_IN, 1);
+
+    // после обслуживания устройства и разрешения линии прерывание выдается снова
+    irq_next();
+    irq_enable();
+    expect_events(1, TEST_WAIT_NS);
+    expect_event(1, &data_irq, PORT_IN, 1);
+
+    EPIT2->CR &= ~(EPIT_CR_EN | EPIT_CR_OCIEN);
+    EPIT2->SR = EPIT_SR_OCIF;
+    src_del(PORT_SRC_IRQ, EPIT2_IRQ_ID);
+}
+
+int main(int argc, char *argv[])
+{
+    port = os_port_create();
+    if(port <= 0) {
+        test_error();
+    }
+    test_level_edge();
+    test_irq();
+    if(os_port_delete(port) != OK) {
+        test_error();
+    }
+    test_success();
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <os.h>
+/**
+ * Тест импульсов каналов (os_pulse, os_pulse_receive)
+ *
+ *  Импульсы отправляются через соединение процесса с собственным каналом. Проверяется:
+ *   - импульсы с одним кодом объединяются: значение последнего, счетчик - число импульсов;
+ *   - импульсы выдаются в порядке поступления первого импульса каждого кода;
+ *   - при очереди, заполненной TEST_PULSES импульсами с разными кодами, импульс с новым
+ *     кодом не принимается (ERR_BUSY), с кодом из очереди - объединяется;
+ *   - импульс будит поток, ожидающий в os_pulse_receive;
+ *   - после закрытия канала импульс не принимается (ERR_DEAD).
+ */
+
+#define TEST_CHANNEL            "pulsetest"
+#define TEST_CHANNEL_SIZE       1024
+#define TEST_PULSES             8               // MSG_PULSES конфигурации ядра
+#define TEST_REPEAT             5
+#define TEST_WAIT_NS            10000000ull
+
+static int chid, conid;
+static pulse_t waiter_pulse;
+static volatile int waiter_res;
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+static int test_thread_create(void *entry, void *arg) {
+    thread_attr_t attr = {
+        .entry = entry, //
+        .arg = arg, //
+        .stack_size = DEFAULT_STACK, //
+        .ts = 1, //
+        .flags = 0, //
+        .type = THREAD_TYPE_JOINABLE
+    };
+    int tid = os_thread_create(&attr);
+    if(tid < 0) {
+        test_error();
+    }
+    return tid;
+}
+
+static void pulse(int code, uint32_t value, int res) {
+    if(os_pulse(conid, code, value) != res) {
+        test_error();
+    }
+}
+
+static void expect_pulse(int code, uint32_t value, uint32_t count) {
+    pulse_t p;
+    if(os_pulse_receive(chid, &p, NO_WAIT) != OK) {
+        test_error();
+    }
+    if((p.code != code) || (p.value != value) || (p.count != count)) {
+        test_error();
+    }
+}
+
+static void expect_none() {
+    pulse_t p;
+    if(os_pulse_receive(chid, &p, NO_WAIT) != ERR_TIMEOUT) {
+        test_error();
+    }
+}
+
+static void test_coalesce() {
+    pulse(1, 10, OK);
+    pulse(2, 20, OK);
+    for(uint32_t i = 1; i <= TEST_REPEAT; i++) {
+        pulse(1, 10 + i, OK);
+    }
+    expect_pulse(1, 10 + TEST_REPEAT, TEST_REPEAT + 1);
+    expect_pulse(2, 20, 1);
+    expect_none();
+}
+
+static void test_busy() {
+    for(int code = 1; code <= TEST_PULSES; code++) {
+        pulse(code, code, OK);
+    }
+    pulse(TEST_PULSES + 1, 0, ERR_BUSY);
+    // импульс с кодом из очереди объединяется и при заполненной очереди
+    pulse(3, 33, OK);
+    expect_pulse(1, 1, 1);
+    // место освобождено приемом
+    pulse(TEST_PULSES + 1, 0, OK);
+    for(int code = 2; code <= TEST_PULSES; code++) {
+        if(code == 3) {
+            expect_pulse(3, 33, 2);
+        } else {
+            expect_pulse(code, code, 1);
+        }
+    }
+    expect_pulse(TEST_PULSES + 1, 0, 1);
+    expect_none();
+}
+
+void thread_test_waiter() {
+    waiter_res = os_pulse_receive(chid, &waiter_pulse, TIMEOUT_INFINITY);
+}
+
+static void test_wake() {
+    waiter_res = ERR;
+    int tid = test_thread_create(thread_test_waiter, NULL);
+    os_thread_run(tid);
+    // поток успевает заблокироваться в ожидании импульса
+    os_thread_sleep(TEST_WAIT_NS);
+    pulse(7, 70, OK);
+    os_thread_join(tid);
+    if((waiter_res != OK) || (waiter_pulse.code != 7) || (waiter_pulse.value != 70)
+            || (waiter_pulse.count != 1)) {
+        test_error();
+    }
+    expect_none();
+}
+
+int main(int argc, char *argv[])
+{
+    chid = os_channel_open(CHANNEL_PUBLIC, TEST_CHANNEL, TEST_CHANNEL_SIZE, CHANNEL_AUTO_CONNECT);
+    if(chid < 0) {
+        test_error();
+    }
+    conid = os_connection_open(TEST_CHANNEL, NO_REPLY, TIMEOUT_INFINITY);
+    if(conid < 0) {
+        test_error();
+    }
+    test_coalesce();
+    test_busy();
+    test_wake();
+
+    if(os_channel_close(chid) != OK) {
+        test_error();
+    }
+    pulse(1, 0, ERR_DEAD);
+    os_connection_close(conid);
+    test_success();
+    return 0;
+}
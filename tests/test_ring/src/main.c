@@ -0,0 +1,102 @@
+#include <os.h>
+#include <ipc.h>
+/**
+ * Тест колец каналов CHANNEL_SHARED_RING (os_ring_put/os_ring_get библиотеки os_rtl)
+ *
+ *  Процесс открывает кольцо с областью данных RING_TEST_SIZE байт и запускает
+ *  производителя - процесс tests/test_ring_producer (образ должен быть загружен
+ *  по адресу PROC_PRODUCER) с более низким приоритетом, поэтому первое чтение
+ *  блокируется на пустом кольце до звонка производителя. Каждые RING_TEST_PAUSE записей
+ *  потребитель засыпает, производитель заполняет кольцо и ожидает звонка о месте.
+ *  Проверяется:
+ *   - порядок, размер и содержимое записей при заворачивании кольца;
+ *   - звонки в обе стороны (потребитель ожидает данные, производитель - место);
+ *   - запись, не помещающаяся в приемный буфер, остается в кольце (ERR_NO_MEM);
+ *   - ожидание пустого кольца завершается по таймауту (ERR_TIMEOUT).
+ */
+
+#define PROC_PRODUCER           0x10670000
+#define RING_CHANNEL            "ringtest"
+#define RING_TEST_SIZE          1024
+#define RING_TEST_COUNT         2000            // число записей производителя
+#define RING_TEST_PAUSE         64
+#define RING_TEST_PAUSE_NS      5000000ull
+#define RING_TEST_TIMEOUT_NS    10000000ull
+
+// размер записи номер seq, согласован с tests/test_ring_producer
+#define RING_TEST_LEN(seq)      (sizeof(uint32_t) + ((seq) * 13) % 200)
+#define RING_TEST_LEN_MAX       (sizeof(uint32_t) + 199)
+#define RING_TEST_SHORT         8               // приемный буфер проверки ERR_NO_MEM
+
+static uint8_t rec[RING_TEST_LEN_MAX];
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+static void check_rec(uint32_t seq, int len) {
+    if((len != (int)RING_TEST_LEN(seq)) || (*(uint32_t *)rec != seq)) {
+        test_error();
+    }
+    for(int i = sizeof(uint32_t); i < len; i++) {
+        if(rec[i] != (uint8_t)(seq + i)) {
+            test_error();
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    os_ring_t *ring = NULL;
+    int chid = os_channel_open(CHANNEL_PUBLIC, RING_CHANNEL, RING_TEST_SIZE + sizeof(os_ring_t),
+            CHANNEL_SHARED_RING | CHANNEL_AUTO_CONNECT);
+    if(chid < 0) {
+        test_error();
+    }
+    if(os_ring_attach(chid, RING_CONSUMER, &ring) != OK) {
+        test_error();
+    }
+    if((ring->size != RING_TEST_SIZE) || (OS_RING_MSG_MAX(ring) < RING_TEST_LEN_MAX)) {
+        test_error();
+    }
+
+    struct proc_attr pattr = {
+        .prio = PRIO_DEFAULT + 1,
+        .argv = NULL,
+        .arglen = 0,
+    };
+    if(os_proc_create((struct proc_header *)PROC_PRODUCER, &pattr) < 0) {
+        test_error();
+    }
+
+    for(uint32_t seq = 0; seq < RING_TEST_COUNT; seq++) {
+        if(!(seq % RING_TEST_PAUSE)) {
+            // производитель заполняет кольцо и ожидает места
+            os_thread_sleep(RING_TEST_PAUSE_NS);
+        }
+        if((RING_TEST_LEN(seq) > RING_TEST_SHORT) && !(seq % RING_TEST_PAUSE)) {
+            if(os_ring_get(ring, chid, rec, RING_TEST_SHORT, TIMEOUT_INFINITY) != ERR_NO_MEM) {
+                test_error();
+            }
+        }
+        int len = os_ring_get(ring, chid, rec, sizeof(rec), TIMEOUT_INFINITY);
+        check_rec(seq, len);
+    }
+    if(os_ring_get(ring, chid, rec, sizeof(rec), RING_TEST_TIMEOUT_NS) != ERR_TIMEOUT) {
+        test_error();
+    }
+    if(ring->head != ring->tail) {
+        test_error();
+    }
+
+    if(os_proc_kill(pattr.pid) < 0) {
+        test_error();
+    }
+    os_channel_close(chid);
+    test_success();
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <os.h>
+#include <ipc.h>
+/**
+ * Производитель кольца для tests/test_ring
+ *
+ *  Запускается тестирующим процессом (образ должен быть загружен по адресу PROC_PRODUCER),
+ *  подключается к кольцу канала RING_CHANNEL и записывает RING_TEST_COUNT записей
+ *  переменного размера: номер записи и байты (номер + индекс). Размеры записей не кратны
+ *  области данных, поэтому записи заворачиваются с признаком RING_WRAP.
+ *  Процесс работает до завершения тестирующим процессом (os_proc_kill).
+ */
+
+#define RING_CHANNEL            "ringtest"
+#define RING_TEST_COUNT         2000
+#define RING_TEST_SLEEP_NS      1000000000ull
+
+// размер записи номер seq, согласован с tests/test_ring
+#define RING_TEST_LEN(seq)      (sizeof(uint32_t) + ((seq) * 13) % 200)
+#define RING_TEST_LEN_MAX       (sizeof(uint32_t) + 199)
+
+static uint8_t rec[RING_TEST_LEN_MAX];
+
+void test_error() {
+    while(1);
+}
+
+int main(int argc, char *argv[])
+{
+    os_ring_t *ring = NULL;
+    int conid = os_connection_open(RING_CHANNEL, NO_REPLY, TIMEOUT_INFINITY);
+    if(conid < 0) {
+        test_error();
+    }
+    if(os_ring_attach(conid, RING_PRODUCER, &ring) != OK) {
+        test_error();
+    }
+    for(uint32_t seq = 0; seq < RING_TEST_COUNT; seq++) {
+        size_t len = RING_TEST_LEN(seq);
+        *(uint32_t *)rec = seq;
+        for(size_t i = sizeof(uint32_t); i < len; i++) {
+            rec[i] = (uint8_t)(seq + i);
+        }
+        if(os_ring_put(ring, conid, rec, len, TIMEOUT_INFINITY) != OK) {
+            test_error();
+        }
+    }
+    for(;;) {
+        os_thread_sleep(RING_TEST_SLEEP_NS);
+    }
+    return 0;
+}
@@ -0,0 +1,225 @@
+#include <os.h>
+#include <string.h>
+/**
+ * Измерение стоимости переключения адресных пространств от числа активных процессов
+ *
+ *  Процесс открывает канал и запускает N экземпляров tests/test_vm_switch_worker
+ *  (образ должен быть загружен по адресу PROC_WORKER), каждый из которых выполняет
+ *  пустой запрос-ответ с более высоким приоритетом. Ответ на запрос вытесняет измеряющий процесс
+ *  процессом нагрузки, который ставит новый запрос в конец очереди канала, поэтому процессы
+ *  обслуживаются по кругу, и на каждый запрос приходится два переключения карт памяти:
+ *  на процесс нагрузки и обратно. Замер - время от ответа до приема следующего запроса
+ *  по счетчику тактов PMU (PMCCNTR), ядро должно быть собрано с BUILD_PMU_USER.
+ *  Пока N + 1 карт помещаются в пул таблиц L1 (MMU_TBL_POOL_SIZE), переключения попадают в пул,
+ *  дальше каждое переключение на процесс нагрузки загружает его карту с вытеснением,
+ *  рост времени по сравнению с N = 1 - стоимость промаха пула.
+ *
+ *  Результаты выводятся в UART2 (консоль sabrelite) строками вида
+ *      VMSW procs=<N> pool=<таблиц L1> n=<замеров> min=<такты> avg=<такты> max=<такты>
+ *           hits=<попаданий> misses=<промахов> evictions=<вытеснений> hist=<b0>,<b1>,...,<b31>
+ *  где счетчики пула - приращения за время замеров по os_get_info(OS_INFO_MEM),
+ *  bi - число замеров длительностью [2^i, 2^(i+1)) тактов (b0 - также 0 тактов).
+ *  Вывод начинается строкой "VMSW begin" и завершается строкой "VMSW end".
+ */
+
+#define PROC_WORKER             0x105F0000
+
+#define BENCH_ITERS             2000
+#define BENCH_PROCS_MAX         48
+#define BENCH_HIST_BUCKETS      32
+#define BENCH_CHANNEL           "vmsw"
+
+#define BENCH_UART_BASE         0x021E8000  // UART2
+#define BENCH_UART_UTXD         (*(volatile uint32_t *)(BENCH_UART_BASE + 0x40))
+#define BENCH_UART_UTS          (*(volatile uint32_t *)(BENCH_UART_BASE + 0xB4))
+#define BENCH_UART_UTS_TXFULL   0x10
+
+struct hist {
+    uint32_t n;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t b[BENCH_HIST_BUCKETS];
+};
+
+// число процессов нагрузки по этапам, по обе стороны от размера пула
+static const int bench_procs[] = { 1, 2, 4, 8, 12, 14, 15, 16, 20, 24, 32, BENCH_PROCS_MAX };
+
+static const mem_attributes_t devattr = {
+    .shared = MEM_SHARED_OFF, //
+    .exec = MEM_EXEC_NEVER, //
+    .type = MEM_TYPE_DEVICE, //
+    .inner_cached = MEM_CACHED_OFF, //
+    .outer_cached = MEM_CACHED_OFF, //
+    .process_access = MEM_ACCESS_RW, //
+    .os_access = MEM_ACCESS_RW, //
+    .security = MEM_SECURITY_OFF
+};
+
+static struct hist hist;
+static int workers[BENCH_PROCS_MAX];
+static int nworkers;
+static int chid;
+static int rcvid = -1;                  // запрос, ожидающий ответа
+static uint32_t req;
+
+void test_error() {
+    while(1);
+}
+
+void test_success() {
+    while(1);
+}
+
+static inline uint32_t ccnt() {
+    uint32_t c;
+    asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r" (c));
+    return c;
+}
+
+static void uart_putc(char c) {
+    while(BENCH_UART_UTS & BENCH_UART_UTS_TXFULL);
+    BENCH_UART_UTXD = c;
+}
+
+static void out_str(const char *s) {
+    while(*s) {
+        if(*s == '\n') {
+            uart_putc('\r');
+        }
+        uart_putc(*s++);
+    }
+}
+
+static void out_u64(uint64_t v) {
+    char buf[21];
+    int i = sizeof(buf) - 1;
+    buf[i] = 0;
+    do {
+        buf[--i] = '0' + (v % 10);
+        v /= 10;
+    } while(v);
+    out_str(&buf[i]);
+}
+
+static void out_kv(const char *key, uint64_t v) {
+    out_str(" ");
+    out_str(key);
+    out_str("=");
+    out_u64(v);
+}
+
+static void hist_reset() {
+    memset(&hist, 0, sizeof(hist));
+    hist.min = 0xFFFFFFFF;
+}
+
+static void hist_add(uint32_t cycles) {
+    int i = (cycles != 0) ? (31 - __builtin_clz(cycles)) : 0;
+    hist.b[i]++;
+    hist.n++;
+    hist.sum += cycles;
+    if(cycles < hist.min) {
+        hist.min = cycles;
+    }
+    if(cycles > hist.max) {
+        hist.max = cycles;
+    }
+}
+
+static void out_result(int procs, const struct mem_info *before, const struct mem_info *after) {
+    out_str("VMSW");
+    out_kv("procs", procs);
+    out_kv("pool", after->mmutbl.size);
+    out_kv("n", hist.n);
+    out_kv("min", hist.n ? hist.min : 0);
+    out_kv("avg", hist.n ? hist.sum / hist.n : 0);
+    out_kv("max", hist.max);
+    out_kv("hits", after->mmutbl.hits - before->mmutbl.hits);
+    out_kv("misses", after->mmutbl.misses - before->mmutbl.misses);
+    out_kv("evictions", after->mmutbl.evictions - before->mmutbl.evictions);
+    out_str(" hist=");
+    for(int i = 0; i < BENCH_HIST_BUCKETS; i++) {
+        if(i) {
+            out_str(",");
+        }
+        out_u64(hist.b[i]);
+    }
+    out_str("\n");
+}
+
+// Процесс нагрузки сразу вытесняет измеряющий, подключается и ставит первый запрос
+static void worker_start() {
+    struct proc_attr pattr = {
+        .prio = PRIO_DEFAULT - 1,
+        .argv = NULL,
+        .arglen = 0,
+    };
+    if(os_proc_create((struct proc_header *)PROC_WORKER, &pattr) < 0) {
+        test_error();
+    }
+    workers[nworkers++] = pattr.pid;
+}
+
+// Ответ на предыдущий запрос и прием следующего, measure - с замером
+static void serve(int count, int measure) {
+    size_t len = 0;
+    for(int i = 0; i < count; i++) {
+        uint32_t t0 = ccnt();
+        if(rcvid >= 0) {
+            os_msg_reply(rcvid, OK, &req, sizeof(req));
+        }
+        rcvid = os_msg_receive(chid, &req, sizeof(req), &len, TIMEOUT_INFINITY);
+        if(rcvid < 0) {
+            test_error();
+        }
+        if(measure) {
+            hist_add(ccnt() - t0);
+        }
+    }
+}
+
+static void bench_switch(int procs) {
+    union os_info before, after;
+
+    while(nworkers < procs) {
+        worker_start();
+    }
+    // прогрев: каждый процесс нагрузки проходит через пул хотя бы дважды
+    serve(procs * 2, 0);
+    hist_reset();
+    if(os_get_info(OS_INFO_MEM, &before) != OK) {
+        test_error();
+    }
+    serve(BENCH_ITERS, 1);
+    if(os_get_info(OS_INFO_MEM, &after) != OK) {
+        test_error();
+    }
+    out_result(procs, &before.mem, &after.mem);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int i;
+
+    if(os_mmap(BENCH_UART_BASE, 1, devattr) != OK) {
+        test_error();
+    }
+    chid = os_channel_open(CHANNEL_PUBLIC, BENCH_CHANNEL, DEFAULT_PAGE_SIZE, CHANNEL_AUTO_CONNECT);
+    if(chid < 0) {
+        test_error();
+    }
+    out_str("VMSW begin\n");
+
+    for(i = 0; i < sizeof(bench_procs) / sizeof(bench_procs[0]); i++) {
+        bench_switch(bench_procs[i]);
+    }
+
+    for(i = 0; i < nworkers; i++) {
+        os_proc_kill(workers[i]);
+    }
+    os_channel_close(chid);
+    out_str("VMSW end\n");
+    test_success();
+    return 0;
+}
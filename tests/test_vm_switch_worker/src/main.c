@@ -0,0 +1,25 @@
+#include <os.h>
+/**
+ * Процесс нагрузки для tests/test_vm_switch
+ *
+ *  Подключается к каналу измерения и бесконечно выполняет пустой запрос-ответ,
+ *  каждый запрос вызывает переключение адресного пространства на этот процесс и обратно.
+ *  Образ запускается многократно, поэтому процесс использует только стек.
+ */
+
+#define VMSW_CHANNEL            "vmsw"
+
+int main(int argc, char *argv[])
+{
+    uint32_t req = 0;
+    int conid = os_connection_open(VMSW_CHANNEL, NO_REPLY, TIMEOUT_INFINITY);
+    if(conid < 0) {
+        while(1);
+    }
+    for(;;) {
+        if(os_msg_send_recv(conid, &req, sizeof(req), &req, sizeof(req), TIMEOUT_INFINITY) != OK) {
+            while(1);
+        }
+    }
+    return 0;
+}